@@ -9,15 +9,24 @@ in vec3 v2fFragPos; // from vertex shader
 // Output Color
 layout(location = 0) out vec3 oColor;
 
-// Uniforms
-layout(location = 2) uniform vec3 uLightDir; // should be normalized! ||uLightDir|| = 1
-layout(location = 3) uniform vec3 uLightDiffuse;
-layout(location = 4) uniform vec3 uSceneAmbient;
+flat in uint v2fView;
 
-layout(location = 5) uniform vec3 uPointLightPos[3];
-layout(location = 8) uniform vec3 uPointLightColor[3];
-layout(location = 11) uniform vec3 uViewpos;
-layout(location = 12) uniform float uShininess;
+// Per-frame uniforms (see frame_uniforms.hpp)
+layout(std140, row_major, binding = 0) uniform FrameUniforms
+{
+    mat4 uViewProj[4];
+    vec3 uViewPositions[4];
+    vec3 uViewRight[4];
+    vec3 uViewUp[4];
+
+    vec3 uPointLightPos[3];
+    vec3 uPointLightColor[3];
+
+    vec3 uLightDir; // should be normalized! ||uLightDir|| = 1
+    float uShininess;
+    vec3 uLightDiffuse;
+    vec3 uSceneAmbient;
+};
 
 layout(binding = 0) uniform sampler2D uTexture;
 
@@ -37,7 +46,7 @@ void main()
 
     //https://en.wikipedia.org/wiki/Blinn%E2%80%93Phong_reflection_model
     // Calculate the view direction
-    vec3 viewDir = normalize(uViewpos - v2fFragPos);
+    vec3 viewDir = normalize(uViewPositions[v2fView] - v2fFragPos);
     vec3 pointLightColor = vec3(0.0);
 
     // Iterate over each light
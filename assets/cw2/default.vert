@@ -1,24 +1,58 @@
 #version 430
 
+#ifdef VIEWPORT_INDEX_ARB
+#extension GL_ARB_shader_viewport_layer_array : require
+#endif
+#ifdef VIEWPORT_INDEX_AMD
+#extension GL_AMD_vertex_shader_viewport_index : require
+#endif
+
 layout(location = 0) in vec3 iPosition;
 layout(location = 1) in vec3 iColor;
 layout(location = 2) in vec3 iNormal;
 layout(location = 3) in vec2 iTexCoord;
 
+// One instance per view (see multiview.hpp)
+layout(location = 4) in uint iView;
+
+// Per-frame uniforms (see frame_uniforms.hpp)
+layout(std140, row_major, binding = 0) uniform FrameUniforms
+{
+    mat4 uViewProj[4];
+    vec3 uViewPositions[4];
+    vec3 uViewRight[4];
+    vec3 uViewUp[4];
+
+    vec3 uPointLightPos[3];
+    vec3 uPointLightColor[3];
 
-layout(location = 0) uniform mat4 uProjCameraWorld;
-layout(location = 1) uniform mat3 uNormalMatrix;
+    vec3 uLightDir; // should be normalized! ||uLightDir|| = 1
+    float uShininess;
+    vec3 uLightDiffuse;
+    vec3 uSceneAmbient;
+};
+
+// Per-object uniforms
+layout(std140, row_major, binding = 1) uniform ObjectUniforms
+{
+    mat4 uModel;
+    mat3 uNormalMatrix;
+};
 
 out vec3 v2fNormal;
 out vec2 v2fTexCoord;
 out vec3 v2fFragPos;
+flat out uint v2fView;
 
 void main()
 {
     v2fTexCoord = iTexCoord;
     v2fFragPos = iPosition;
+    v2fView = iView;
 
     v2fNormal = normalize(uNormalMatrix * iNormal);
-    gl_Position = uProjCameraWorld * vec4(iPosition, 1.0);
-
-}
\ No newline at end of file
+    gl_Position = uViewProj[iView] * (uModel * vec4(iPosition, 1.0));
+#if defined(VIEWPORT_INDEX_ARB) || defined(VIEWPORT_INDEX_AMD)
+    gl_ViewportIndex = int(iView);
+#endif
+}
@@ -0,0 +1,14 @@
+#version 430
+
+in vec2 vTexCoord;
+in vec4 vColor;
+
+// Glyph coverage; the solid parts sample fontstash's white rectangle
+layout(binding = 0) uniform sampler2D uAtlas;
+
+out vec4 fragColor;
+
+void main()
+{
+    fragColor = vec4(vColor.rgb, vColor.a * texture(uAtlas, vTexCoord).r);
+}
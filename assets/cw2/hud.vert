@@ -0,0 +1,20 @@
+#version 430
+// Performance HUD (see hud.hpp). Positions are in pixels from the top left
+// corner of the framebuffer.
+layout(location = 0) in vec2 iPosition;
+layout(location = 1) in vec2 iTexCoord;
+layout(location = 2) in vec4 iColor;
+
+layout(location = 0) uniform vec2 uScreenSize;
+
+out vec2 vTexCoord;
+out vec4 vColor;
+
+void main()
+{
+    vTexCoord = iTexCoord;
+    vColor = iColor;
+
+    vec2 ndc = iPosition / uScreenSize * 2.0 - 1.0;
+    gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);
+}
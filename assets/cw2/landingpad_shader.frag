@@ -7,20 +7,24 @@ in vec3 v2fFragPos;
 
 layout(location = 0) out vec3 oColor;
 
-// Uniforms for Directional Light
-layout(location = 2) uniform vec3 uLightDir; 
-layout(location = 3) uniform vec3 uLightDiffuse;
-layout(location = 4) uniform vec3 uSceneAmbient;
+flat in uint v2fView;
 
-// Uniforms for Point Lights
-// light position occupies 5,6,7 (because it is for free 3 cameras)
-// light color occupies 8,9,10
-layout(location = 5) uniform vec3 uPointLightPos[3];
-layout(location = 8) uniform vec3 uPointLightColor[3];
+// Per-frame uniforms (see frame_uniforms.hpp)
+layout(std140, row_major, binding = 0) uniform FrameUniforms
+{
+    mat4 uViewProj[4];
+    vec3 uViewPositions[4];
+    vec3 uViewRight[4];
+    vec3 uViewUp[4];
+
+    vec3 uPointLightPos[3];
+    vec3 uPointLightColor[3];
 
-// Uniforms for View Position and Material
-layout(location = 11) uniform vec3 uViewPos;
-layout(location = 12) uniform float uShininess;
+    vec3 uLightDir; // should be normalized! ||uLightDir|| = 1
+    float uShininess;
+    vec3 uLightDiffuse;
+    vec3 uSceneAmbient;
+};
 
 void main()
 {
@@ -31,7 +35,7 @@ void main()
     vec3 diffuse = uLightDiffuse * nDotL;
     vec3 baseColor = (ambient + diffuse);
 
-    vec3 viewDir = normalize(uViewPos - v2fFragPos);
+    vec3 viewDir = normalize(uViewPositions[v2fView] - v2fFragPos);
 
     vec3 pointLightColor = vec3(0.0);
 
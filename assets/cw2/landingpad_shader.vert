@@ -1,19 +1,50 @@
 #version 430
 
+#ifdef VIEWPORT_INDEX_ARB
+#extension GL_ARB_shader_viewport_layer_array : require
+#endif
+#ifdef VIEWPORT_INDEX_AMD
+#extension GL_AMD_vertex_shader_viewport_index : require
+#endif
+
 // Input attributes
 layout(location = 0) in vec3 iPosition;
 layout(location = 1) in vec3 iColor;
 layout(location = 2) in vec3 iNormal;
 
+// One instance per view (see multiview.hpp)
+layout(location = 4) in uint iView;
+
 // Uniforms
-layout(location = 0) uniform mat4 uProjCameraWorld;
-layout(location = 1) uniform mat3 uNormalMatrix;
-layout(location = 13) uniform mat4 uModel;
+// Per-frame uniforms (see frame_uniforms.hpp)
+layout(std140, row_major, binding = 0) uniform FrameUniforms
+{
+    mat4 uViewProj[4];
+    vec3 uViewPositions[4];
+    vec3 uViewRight[4];
+    vec3 uViewUp[4];
+
+    vec3 uPointLightPos[3];
+    vec3 uPointLightColor[3];
+
+    vec3 uLightDir; // should be normalized! ||uLightDir|| = 1
+    float uShininess;
+    vec3 uLightDiffuse;
+    vec3 uSceneAmbient;
+};
+
+// Per-object uniforms
+layout(std140, row_major, binding = 1) uniform ObjectUniforms
+{
+    mat4 uModel;
+    mat3 uNormalMatrix;
+};
 
 // Output attributes
 out vec3 v2fColor;
 out vec3 v2fNormal;
 out vec3 v2fFragPos;
+flat out uint v2fView;
 
 void main()
 {
@@ -21,7 +52,11 @@ void main()
     // Copy input color to the output color attribute.
     v2fColor = iColor;
     v2fNormal = normalize(uNormalMatrix * iNormal);
+    v2fView = iView;
 
-    // Transform the input position with the uniform matrix
-    gl_Position = uProjCameraWorld * vec4(iPosition, 1.0);
-}
\ No newline at end of file
+    // Transform the world-space position with the view's matrix
+    gl_Position = uViewProj[iView] * vec4(v2fFragPos, 1.0);
+#if defined(VIEWPORT_INDEX_ARB) || defined(VIEWPORT_INDEX_AMD)
+    gl_ViewportIndex = int(iView);
+#endif
+}
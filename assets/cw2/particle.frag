@@ -1,6 +1,7 @@
 #version 430
 
 in vec2 vTexcoord;
+in float vLife;
 
 uniform sampler2D uParticleTexture;
 
@@ -9,5 +10,8 @@ out vec4 fragColor;
 void main()
 {
     vec4 texColor = texture(uParticleTexture, vTexcoord);
+
+    // Fade out over the last quarter of the lifetime
+    texColor.a *= min(4.0 * vLife, 1.0);
     fragColor = texColor;
 }
@@ -1,13 +1,79 @@
 #version 430
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec2 inTexcoord;
+#ifdef VIEWPORT_INDEX_ARB
+#extension GL_ARB_shader_viewport_layer_array : require
+#endif
+#ifdef VIEWPORT_INDEX_AMD
+#extension GL_AMD_vertex_shader_viewport_index : require
+#endif
+// Unit quad (see make_particle_quad()), drawn once per view with one instance
+// per particle. The corner is placed along the camera axes of the view, so
+// the billboard faces the view's camera.
+layout(location = 0) in vec3 iCorner;
+layout(location = 3) in vec2 iTexCoord;
 
-layout(location = 0) uniform mat4 uProjection;
+#ifdef GPU_PARTICLES
+// Simulated on the GPU (see particle_sim.comp): instance i draws the
+// particle in slot drawList[i]. When drawing, the draw list is the
+// view's back-to-front order (see particle_sort.comp).
+struct Particle
+{
+    vec4 positionLife;
+    vec4 velocitySize;
+};
+
+layout(std430, binding = 0) readonly buffer Particles
+{
+    Particle particles[];
+};
+layout(std430, binding = 2) readonly buffer DrawList
+{
+    uint drawList[];
+};
+#else
+// Per particle
+layout(location = 5) in vec4 iCenterSize; // center, half size
+layout(location = 6) in float iLife;      // fraction of the lifetime left
+#endif
+
+// View drawn
+layout(location = 0) uniform uint uView;
+
+// Per-frame uniforms (see frame_uniforms.hpp)
+layout(std140, row_major, binding = 0) uniform FrameUniforms
+{
+    mat4 uViewProj[4];
+    vec3 uViewPositions[4];
+    vec3 uViewRight[4];
+    vec3 uViewUp[4];
+
+    vec3 uPointLightPos[3];
+    vec3 uPointLightColor[3];
+
+    vec3 uLightDir; // should be normalized! ||uLightDir|| = 1
+    float uShininess;
+    vec3 uLightDiffuse;
+    vec3 uSceneAmbient;
+};
 
 out vec2 vTexcoord;
+out float vLife;
 
 void main()
 {
-    vTexcoord = inTexcoord;
-    gl_Position = uProjection * vec4(inPosition, 1.0);
-}
\ No newline at end of file
+    uint view = uView;
+
+#ifdef GPU_PARTICLES
+    Particle particle = particles[drawList[gl_InstanceID]];
+    vec4 iCenterSize = vec4(particle.positionLife.xyz, particle.velocitySize.w);
+    float iLife = particle.positionLife.w;
+#endif
+
+    vTexcoord = iTexCoord;
+    vLife = iLife;
+
+    vec3 position = iCenterSize.xyz + iCenterSize.w * (iCorner.x * uViewRight[view] + iCorner.y * uViewUp[view]);
+    gl_Position = uViewProj[view] * vec4(position, 1.0);
+#if defined(VIEWPORT_INDEX_ARB) || defined(VIEWPORT_INDEX_AMD)
+    gl_ViewportIndex = int(view);
+#endif
+}
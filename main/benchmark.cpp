@@ -0,0 +1,242 @@
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <string_view>
+
+#include <cstdio>
+#include <cstring>
+
+#include "../support/error.hpp"
+
+namespace
+{
+	// Escapes quotes and backslashes; zone names and GL strings have nothing
+	// else that needs escaping
+	std::string json_string_( std::string const& aString )
+	{
+		std::string ret = "\"";
+		for( char const c : aString )
+		{
+			if( '"' == c || '\\' == c )
+				ret += '\\';
+			ret += c;
+		}
+		return ret + '"';
+	}
+
+	char const* clock_name_( EProfileClock aClock ) noexcept
+	{
+		return EProfileClock::gpu == aClock ? "gpu" : "cpu";
+	}
+
+	// Per-frame GL counters, summarized like the times. ProfileSummary's
+	// fields are named for milliseconds; here they hold counts (or bytes).
+	struct GlCounter_
+	{
+		char const* name;
+		char const* unit;
+		ProfileSummary perFrame;
+	};
+
+	std::vector<GlCounter_> summarize_gl_( std::vector<GlFrameStats> const& aFrames )
+	{
+		auto const summarize = [&] (char const* aName, auto aGet, char const* aUnit = "count") {
+			std::vector<float> samples;
+			samples.reserve( aFrames.size() );
+			for( auto const& frame : aFrames )
+				samples.emplace_back( float(aGet( frame )) );
+			return GlCounter_{ aName, aUnit, summarize_samples( samples ) };
+		};
+
+		return {
+			summarize( "draw_calls", [] (GlFrameStats const& aS) { return aS.drawCalls; } ),
+			summarize( "dispatches", [] (GlFrameStats const& aS) { return aS.dispatches; } ),
+			summarize( "state_changes", [] (GlFrameStats const& aS) { return state_changes( aS ); } ),
+			summarize( "program_binds", [] (GlFrameStats const& aS) { return aS.programBinds; } ),
+			summarize( "texture_binds", [] (GlFrameStats const& aS) { return aS.textureBinds; } ),
+			summarize( "vao_binds", [] (GlFrameStats const& aS) { return aS.vaoBinds; } ),
+			summarize( "buffer_binds", [] (GlFrameStats const& aS) { return aS.bufferBinds; } ),
+			summarize( "uniform_calls", [] (GlFrameStats const& aS) { return aS.uniformCalls; } ),
+			summarize( "upload_bytes", [] (GlFrameStats const& aS) { return aS.uploadBytes; }, "bytes" )
+		};
+	}
+
+	void write_csv_( std::FILE* aOut, BenchResults const& aResults )
+	{
+		std::fprintf( aOut, "zone,clock,depth,samples,min_ms,avg_ms,p50_ms,p95_ms,p99_ms\n" );
+
+		auto const row = [&] (char const* aName, char const* aClock, unsigned aDepth, ProfileSummary const& aMs) {
+			std::fprintf( aOut, "%s,%s,%u,%zu,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+				aName, aClock, aDepth, aMs.samples, aMs.minMs, aMs.avgMs, aMs.p50Ms, aMs.p95Ms, aMs.p99Ms
+			);
+		};
+
+		row( "frame time", "wall", 0, summarize_samples( aResults.frameMs ) );
+		for( auto const& zone : aResults.zones )
+			row( zone.name.c_str(), clock_name_( zone.clock ), zone.depth, zone.ms );
+
+		// The GL counters aren't times; they get a section with its own
+		// header, after an empty line
+		std::fprintf( aOut, "\ncounter,unit,samples,min,avg,p50,p95,p99\n" );
+		for( auto const& counter : summarize_gl_( aResults.gl ) )
+		{
+			auto const& s = counter.perFrame;
+			std::fprintf( aOut, "%s,%s,%zu,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+				counter.name, counter.unit, s.samples, s.minMs, s.avgMs, s.p50Ms, s.p95Ms, s.p99Ms
+			);
+		}
+	}
+
+	void write_json_( std::FILE* aOut, BenchScript const& aScript, BenchResults const& aResults )
+	{
+		auto const summary = [&] (ProfileSummary const& aMs) {
+			std::fprintf( aOut, "\"samples\": %zu, \"min_ms\": %.4f, \"avg_ms\": %.4f, \"p50_ms\": %.4f, \"p95_ms\": %.4f, \"p99_ms\": %.4f",
+				aMs.samples, aMs.minMs, aMs.avgMs, aMs.p50Ms, aMs.p95Ms, aMs.p99Ms
+			);
+		};
+
+		std::fprintf( aOut, "{\n" );
+		std::fprintf( aOut, "  \"script\": %s,\n", json_string_( aScript.path ).c_str() );
+		std::fprintf( aOut, "  \"renderer\": %s,\n", json_string_( aResults.renderer ).c_str() );
+		std::fprintf( aOut, "  \"version\": %s,\n", json_string_( aResults.version ).c_str() );
+		std::fprintf( aOut, "  \"resolution\": [%d, %d],\n", aScript.width, aScript.height );
+		std::fprintf( aOut, "  \"views\": %zu,\n", aScript.views );
+		std::fprintf( aOut, "  \"particles\": \"%s\",\n", aScript.gpuParticles ? "gpu" : "cpu" );
+
+		std::fprintf( aOut, "  \"frame_time\": { " );
+		summary( summarize_samples( aResults.frameMs ) );
+		std::fprintf( aOut, " },\n" );
+
+		std::fprintf( aOut, "  \"zones\": [" );
+		for( std::size_t i = 0; i < aResults.zones.size(); ++i )
+		{
+			auto const& zone = aResults.zones[i];
+			std::fprintf( aOut, "%s\n    { \"name\": %s, \"clock\": \"%s\", \"depth\": %u, ",
+				i ? "," : "", json_string_( zone.name ).c_str(), clock_name_( zone.clock ), zone.depth
+			);
+			summary( zone.ms );
+			std::fprintf( aOut, " }" );
+		}
+		std::fprintf( aOut, "\n  ],\n" );
+
+		// Counts (or bytes) per frame; their keys have no unit suffix
+		auto const gl = summarize_gl_( aResults.gl );
+		std::fprintf( aOut, "  \"gl_per_frame\": [" );
+		for( std::size_t i = 0; i < gl.size(); ++i )
+		{
+			auto const& s = gl[i].perFrame;
+			std::fprintf( aOut, "%s\n    { \"name\": \"%s\", \"unit\": \"%s\", \"samples\": %zu, \"min\": %.1f, \"avg\": %.1f, \"p50\": %.1f, \"p95\": %.1f, \"p99\": %.1f }",
+				i ? "," : "", gl[i].name, gl[i].unit, s.samples, s.minMs, s.avgMs, s.p50Ms, s.p95Ms, s.p99Ms
+			);
+		}
+		std::fprintf( aOut, "\n  ]\n}\n" );
+	}
+}
+
+BenchScript load_bench_script( char const* aPath )
+{
+	std::FILE* fin = std::fopen( aPath, "r" );
+	if( !fin )
+		throw Error( "Unable to open benchmark script '%s'", aPath );
+
+	BenchScript ret;
+	ret.path = aPath;
+
+	char line[512];
+	for( int lineNumber = 1; std::fgets( line, sizeof(line), fin ); ++lineNumber )
+	{
+		if( char* comment = std::strchr( line, '#' ) )
+			*comment = '\0';
+
+		char command[32];
+		int consumed = 0;
+		if( 1 != std::sscanf( line, "%31s%n", command, &consumed ) )
+			continue; // blank
+
+		char const* args = line + consumed;
+		bool ok = false;
+
+		if( 0 == std::strcmp( command, "frames" ) )
+			ok = 1 == std::sscanf( args, "%zu", &ret.frames ) && ret.frames > 0;
+		else if( 0 == std::strcmp( command, "warmup" ) )
+			ok = 1 == std::sscanf( args, "%zu", &ret.warmup );
+		else if( 0 == std::strcmp( command, "timestep" ) )
+			ok = 1 == std::sscanf( args, "%f", &ret.timestep ) && ret.timestep > 0.f;
+		else if( 0 == std::strcmp( command, "resolution" ) )
+			ok = 2 == std::sscanf( args, "%d %d", &ret.width, &ret.height ) && ret.width > 0 && ret.height > 0;
+		else if( 0 == std::strcmp( command, "views" ) )
+			ok = 1 == std::sscanf( args, "%zu", &ret.views ) && (1 == ret.views || 2 == ret.views || 4 == ret.views);
+		else if( 0 == std::strcmp( command, "particles" ) )
+		{
+			char which[8];
+			ok = 1 == std::sscanf( args, "%7s", which ) && (0 == std::strcmp( which, "cpu" ) || 0 == std::strcmp( which, "gpu" ));
+			ret.gpuParticles = ok && 0 == std::strcmp( which, "gpu" );
+		}
+		else if( 0 == std::strcmp( command, "launch" ) )
+			ok = 1 == std::sscanf( args, "%f", &ret.launchTime ) && ret.launchTime >= 0.f;
+		else if( 0 == std::strcmp( command, "camera" ) )
+		{
+			BenchCameraKey key{};
+			ok = 6 == std::sscanf( args, "%f %f %f %f %f %f", &key.time, &key.position.x, &key.position.y, &key.position.z, &key.phi, &key.theta );
+			if( ok )
+				ret.camera.emplace_back( key );
+		}
+
+		if( !ok )
+		{
+			std::fclose( fin );
+			throw Error( "%s:%d: malformed '%s' command", aPath, lineNumber, command );
+		}
+	}
+
+	std::fclose( fin );
+
+	if( ret.camera.empty() )
+		throw Error( "%s: no camera keys", aPath );
+
+	std::stable_sort( ret.camera.begin(), ret.camera.end(), [] (BenchCameraKey const& aX, BenchCameraKey const& aY) {
+		return aX.time < aY.time;
+	} );
+
+	return ret;
+}
+
+BenchCameraKey sample_bench_camera( BenchScript const& aScript, float aTime ) noexcept
+{
+	auto const& keys = aScript.camera;
+
+	auto const next = std::upper_bound( keys.begin(), keys.end(), aTime, [] (float aT, BenchCameraKey const& aKey) {
+		return aT < aKey.time;
+	} );
+
+	if( next == keys.begin() )
+		return keys.front();
+	if( next == keys.end() )
+		return keys.back();
+
+	auto const& a = *(next-1);
+	auto const& b = *next;
+	float const t = (aTime - a.time) / (b.time - a.time);
+
+	return BenchCameraKey{
+		aTime,
+		a.position + (b.position - a.position) * t,
+		a.phi + (b.phi - a.phi) * t,
+		a.theta + (b.theta - a.theta) * t
+	};
+}
+
+void write_bench_report( char const* aPath, BenchScript const& aScript, BenchResults const& aResults )
+{
+	std::FILE* fout = std::fopen( aPath, "w" );
+	if( !fout )
+		throw Error( "Unable to open '%s' for writing", aPath );
+
+	if( std::string_view( aPath ).ends_with( ".csv" ) )
+		write_csv_( fout, aResults );
+	else
+		write_json_( fout, aScript, aResults );
+
+	if( 0 != std::fclose( fout ) )
+		throw Error( "Unable to write '%s'", aPath );
+}
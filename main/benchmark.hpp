@@ -0,0 +1,86 @@
+#ifndef BENCHMARK_HPP_C4E17B0A_86D2_4F3B_A95E_2D7B61F0E8A3
+#define BENCHMARK_HPP_C4E17B0A_86D2_4F3B_A95E_2D7B61F0E8A3
+
+#include <span>
+#include <string>
+#include <vector>
+
+#include <cstddef>
+
+#include "../vmlib/vec3.hpp"
+
+#include "../support/profiler.hpp"
+#include "../support/gl_stats.hpp"
+
+/* Scripted benchmarks (main --bench <script> [--out <report>])
+ *
+ * The window is hidden and V-Sync is off. The scene is simulated with a fixed
+ * time step and the camera and rocket follow the script, so that every run
+ * renders the same frames. After the warm-up frames, the frame times (wall
+ * clock, from one frame to the next), all profiler zones and the GL
+ * counters of each frame (see gl_stats.hpp) are recorded. The report is
+ * written as JSON, or as CSV if the output name ends in ".csv". Times are in
+ * milliseconds (keys and columns ending in "_ms"). The GL counters are counts
+ * or bytes per frame; they have their own keys ("gl_per_frame") or, in the
+ * CSV report, their own section after an empty line.
+ *
+ * Scripts are plain text, one command per line; '#' starts a comment:
+ *
+ *   frames <count>            frames to record (default 600)
+ *   warmup <count>            frames to render first (default 60)
+ *   timestep <seconds>        simulated time per frame (default 1/60)
+ *   resolution <w> <h>        framebuffer size (default 1280 720)
+ *   views <count>             1, or 2 or 4 for split-screen (default 1)
+ *   particles cpu|gpu         particle simulation (default cpu)
+ *   launch <time>             starts the rocket at that time
+ *   camera <time> <x> <y> <z> <phi> <theta>
+ *                             camera key; the camera moves linearly
+ *                             between keys and holds the first and last
+ *
+ * Times are in simulated seconds from the first warm-up frame. All views
+ * follow the same camera.
+ */
+struct BenchCameraKey
+{
+	float time;
+	Vec3f position;
+	float phi, theta;
+};
+
+struct BenchScript
+{
+	std::string path;
+
+	std::size_t frames = 600;
+	std::size_t warmup = 60;
+	float timestep = 1.f / 60.f;
+
+	int width = 1280, height = 720;
+	std::size_t views = 1;
+	bool gpuParticles = false;
+
+	float launchTime = -1.f; // negative: never
+	std::vector<BenchCameraKey> camera; // sorted by time
+};
+
+// Throws Error if the file can't be read or a line is malformed.
+BenchScript load_bench_script( char const* aPath );
+
+// Camera at aTime, interpolated between the script's keys. The script must
+// have at least one camera key.
+BenchCameraKey sample_bench_camera( BenchScript const&, float aTime ) noexcept;
+
+struct BenchResults
+{
+	std::string renderer; // GL_RENDERER
+	std::string version;  // GL_VERSION
+
+	std::vector<float> frameMs;
+	std::vector<GlFrameStats> gl; // one per frame, like frameMs
+	std::vector<ProfileZoneStats> zones; // recorded, see Profiler
+};
+
+// Throws Error if the file can't be written.
+void write_bench_report( char const* aPath, BenchScript const&, BenchResults const& );
+
+#endif // BENCHMARK_HPP_C4E17B0A_86D2_4F3B_A95E_2D7B61F0E8A3
@@ -0,0 +1,97 @@
+#ifndef FRAME_UNIFORMS_HPP_0A0C49C6_EA84_4947_8F85_D08DC1D37B85
+#define FRAME_UNIFORMS_HPP_0A0C49C6_EA84_4947_8F85_D08DC1D37B85
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+#include "../vmlib/vec3.hpp"
+#include "../vmlib/vec4.hpp"
+#include "../vmlib/mat33.hpp"
+#include "../vmlib/mat44.hpp"
+
+#include "multiview.hpp"
+
+/* Uniform blocks
+ *
+ * All scene shaders declare the same two std140 uniform blocks, which are
+ * filled from a StreamBuffer (see stream_buffer.hpp):
+ *
+ *   binding 0  FrameUniforms   cameras and lights; written once per frame
+ *   binding 1  ObjectUniforms  model and normal matrices; one per object,
+ *                              bound with glBindBufferRange() before drawing
+ *
+ * The blocks are declared row_major, so matrices are copied as-is from
+ * Mat44f/Mat33f. In std140, vec3 array elements and mat3 rows take up a full
+ * vec4, hence the Vec4f members below. The GLSL declarations must be kept in
+ * sync with the structs; the static_asserts check the std140 offsets.
+ */
+inline constexpr GLuint kFrameUniformsBinding = 0;
+inline constexpr GLuint kObjectUniformsBinding = 1;
+
+inline constexpr std::size_t kPointLightCount = 3;
+
+struct FrameUniforms
+{
+	// Per view, indexed by the view index (see multiview.hpp). Without
+	// split-screen, only view 0 is used.
+	Mat44f viewProj[kMaxViews];
+	Vec4f viewPositions[kMaxViews];
+	Vec4f viewRight[kMaxViews];
+	Vec4f viewUp[kMaxViews];
+
+	Vec4f pointLightPos[kPointLightCount];
+	Vec4f pointLightColor[kPointLightCount];
+
+	Vec3f lightDir; // normalized
+	float shininess;
+	Vec3f lightDiffuse;
+	float pad0_;
+	Vec3f sceneAmbient;
+	float pad1_;
+};
+
+struct ObjectUniforms
+{
+	Mat44f model;
+	Vec4f normalMatrix[3]; // rows
+};
+
+static_assert( 4 == kMaxViews, "Shaders declare arrays of four views" );
+static_assert( 3 == kPointLightCount, "Shaders declare three point lights" );
+
+static_assert( 0 == offsetof( FrameUniforms, viewProj ) );
+static_assert( 256 == offsetof( FrameUniforms, viewPositions ) );
+static_assert( 320 == offsetof( FrameUniforms, viewRight ) );
+static_assert( 384 == offsetof( FrameUniforms, viewUp ) );
+static_assert( 448 == offsetof( FrameUniforms, pointLightPos ) );
+static_assert( 496 == offsetof( FrameUniforms, pointLightColor ) );
+static_assert( 544 == offsetof( FrameUniforms, lightDir ) );
+static_assert( 556 == offsetof( FrameUniforms, shininess ) );
+static_assert( 560 == offsetof( FrameUniforms, lightDiffuse ) );
+static_assert( 576 == offsetof( FrameUniforms, sceneAmbient ) );
+static_assert( 592 == sizeof(FrameUniforms) );
+
+static_assert( 0 == offsetof( ObjectUniforms, model ) );
+static_assert( 64 == offsetof( ObjectUniforms, normalMatrix ) );
+static_assert( 112 == sizeof(ObjectUniforms) );
+
+inline
+Vec4f to_std140( Vec3f aV ) noexcept
+{
+	return Vec4f{ aV.x, aV.y, aV.z, 0.f };
+}
+
+inline
+ObjectUniforms make_object_uniforms( Mat44f const& aModel2World ) noexcept
+{
+	auto const n = normal_matrix( aModel2World );
+
+	ObjectUniforms ret;
+	ret.model = aModel2World;
+	for( std::size_t i = 0; i < 3; ++i )
+		ret.normalMatrix[i] = Vec4f{ n(i,0), n(i,1), n(i,2), 0.f };
+	return ret;
+}
+
+#endif // FRAME_UNIFORMS_HPP_0A0C49C6_EA84_4947_8F85_D08DC1D37B85
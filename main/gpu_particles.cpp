@@ -0,0 +1,364 @@
+#include "gpu_particles.hpp"
+
+#include <cmath>
+#include <numbers>
+#include <numeric>
+#include <utility>
+#include <algorithm>
+
+#include <cassert>
+
+#include "../vmlib/aabb.hpp"
+
+#include "../support/profiler.hpp"
+
+namespace
+{
+	// Must match particle_sim.comp
+	constexpr GLuint kWorkGroupSize_ = 64;
+
+	// Must match particle_sort.comp: keys per tile, and digit values
+	constexpr GLuint kSortTileSize_ = 256;
+	constexpr GLuint kSortRadix_ = 256;
+
+	struct GpuParticle_
+	{
+		float positionLife[4];
+		float velocitySize[4];
+	};
+
+	static_assert( 32 == sizeof(GpuParticle_) );
+
+	// glDispatchComputeIndirect() arguments, followed by the number of keys
+	struct SortSize_
+	{
+		GLuint groups[3];
+		GLuint count;
+	};
+
+	GLuint work_groups_( std::size_t aCount, GLuint aGroupSize = kWorkGroupSize_ )
+	{
+		return GLuint((aCount + aGroupSize-1) / aGroupSize);
+	}
+
+	GLuint create_storage_( GLsizeiptr aBytes, void const* aData )
+	{
+		GLuint buffer = 0;
+		glGenBuffers( 1, &buffer );
+		glBindBuffer( GL_SHADER_STORAGE_BUFFER, buffer );
+		glBufferData( GL_SHADER_STORAGE_BUFFER, aBytes, aData, GL_DYNAMIC_COPY );
+		glBindBuffer( GL_SHADER_STORAGE_BUFFER, 0 );
+		return buffer;
+	}
+
+	ShaderProgram load_pass_( char const* aSource, char const* aPass )
+	{
+		return ShaderProgram( {
+			{ GL_COMPUTE_SHADER, aSource, { aPass } }
+		} );
+	}
+}
+
+GpuParticles::GpuParticles( Programs_ aPrograms ) noexcept
+	: mPrograms( std::move(aPrograms) )
+	, mParticles( 0 )
+	, mDeadList( 0 )
+	, mDrawList( 0 )
+	, mCommand( 0 )
+	, mCounters( 0 )
+	, mKeys{ 0, 0 }
+	, mValues{ 0, 0 }
+	, mHistogram( 0 )
+	, mSortSize( 0 )
+	, mSorted( 0 )
+	, mMaxParticles( 0 )
+	, mSortedStride( 0 )
+	, mIndexCount( 0 )
+	, mEmitter{}
+	, mFrame( 0 )
+{}
+
+GpuParticles::~GpuParticles()
+{
+	GLuint const buffers[] = { mParticles, mDeadList, mDrawList, mCommand, mCounters, mKeys[0], mKeys[1], mValues[0], mValues[1], mHistogram, mSortSize, mSorted };
+	for( auto buffer : buffers )
+	{
+		if( 0 != buffer )
+			glDeleteBuffers( 1, &buffer );
+	}
+}
+
+GpuParticles::GpuParticles( GpuParticles&& aOther ) noexcept
+	: mPrograms( std::move(aOther.mPrograms) )
+	, mParticles( std::exchange( aOther.mParticles, 0 ) )
+	, mDeadList( std::exchange( aOther.mDeadList, 0 ) )
+	, mDrawList( std::exchange( aOther.mDrawList, 0 ) )
+	, mCommand( std::exchange( aOther.mCommand, 0 ) )
+	, mCounters( std::exchange( aOther.mCounters, 0 ) )
+	, mKeys{ std::exchange( aOther.mKeys[0], 0 ), std::exchange( aOther.mKeys[1], 0 ) }
+	, mValues{ std::exchange( aOther.mValues[0], 0 ), std::exchange( aOther.mValues[1], 0 ) }
+	, mHistogram( std::exchange( aOther.mHistogram, 0 ) )
+	, mSortSize( std::exchange( aOther.mSortSize, 0 ) )
+	, mSorted( std::exchange( aOther.mSorted, 0 ) )
+	, mMaxParticles( std::exchange( aOther.mMaxParticles, 0 ) )
+	, mSortedStride( std::exchange( aOther.mSortedStride, 0 ) )
+	, mIndexCount( std::exchange( aOther.mIndexCount, 0 ) )
+	, mEmitter( aOther.mEmitter )
+	, mFrame( aOther.mFrame )
+	, mEmissions( std::move(aOther.mEmissions) )
+{}
+GpuParticles& GpuParticles::operator= (GpuParticles&& aOther) noexcept
+{
+	std::swap( mPrograms, aOther.mPrograms );
+	std::swap( mParticles, aOther.mParticles );
+	std::swap( mDeadList, aOther.mDeadList );
+	std::swap( mDrawList, aOther.mDrawList );
+	std::swap( mCommand, aOther.mCommand );
+	std::swap( mCounters, aOther.mCounters );
+	std::swap( mKeys, aOther.mKeys );
+	std::swap( mValues, aOther.mValues );
+	std::swap( mHistogram, aOther.mHistogram );
+	std::swap( mSortSize, aOther.mSortSize );
+	std::swap( mSorted, aOther.mSorted );
+	std::swap( mMaxParticles, aOther.mMaxParticles );
+	std::swap( mSortedStride, aOther.mSortedStride );
+	std::swap( mIndexCount, aOther.mIndexCount );
+	std::swap( mEmitter, aOther.mEmitter );
+	std::swap( mFrame, aOther.mFrame );
+	std::swap( mEmissions, aOther.mEmissions );
+	return *this;
+}
+
+void GpuParticles::reset()
+{
+	// All particles dead (zero life); every slot on the dead list
+	glBindBuffer( GL_SHADER_STORAGE_BUFFER, mParticles );
+	glClearBufferData( GL_SHADER_STORAGE_BUFFER, GL_R32F, GL_RED, GL_FLOAT, nullptr );
+
+	std::vector<GLuint> slots( mMaxParticles );
+	std::iota( slots.begin(), slots.end(), GLuint(0) );
+	glBindBuffer( GL_SHADER_STORAGE_BUFFER, mDeadList );
+	glBufferSubData( GL_SHADER_STORAGE_BUFFER, 0, GLsizeiptr(slots.size() * sizeof(GLuint)), slots.data() );
+
+	// Nothing to draw or sort until the next simulate()
+	for( GLuint buffer : { mCommand, mSortSize } )
+	{
+		glBindBuffer( GL_SHADER_STORAGE_BUFFER, buffer );
+		glClearBufferData( GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr );
+	}
+	glBindBuffer( GL_SHADER_STORAGE_BUFFER, 0 );
+
+	GLuint const counters[2] = { GLuint(mMaxParticles), 0 };
+	glBindBuffer( GL_ATOMIC_COUNTER_BUFFER, mCounters );
+	glBufferSubData( GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(counters), counters );
+	glBindBuffer( GL_ATOMIC_COUNTER_BUFFER, 0 );
+
+	mEmissions.clear();
+}
+
+void GpuParticles::simulate( float aDeltaTime, Vec3f aEmitPosition, unsigned aEmitCount )
+{
+	PROFILE_GPU( "particle simulation" );
+
+	++mFrame;
+
+	// Emissions older than the lifetime have no live particles left
+	for( auto& emission : mEmissions )
+		emission.age += aDeltaTime;
+	std::erase_if( mEmissions, [this] (Emission_ const& aEmission) {
+		return aEmission.age > mEmitter.lifetime;
+	} );
+
+	aEmitCount = unsigned(std::min<std::size_t>( aEmitCount, mMaxParticles ));
+	if( aEmitCount > 0 )
+		mEmissions.emplace_back( Emission_{ 0.f, aEmitPosition } );
+
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 0, mParticles );
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 1, mDeadList );
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 2, mDrawList );
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 3, mCommand );
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 9, mSortSize );
+	glBindBufferBase( GL_ATOMIC_COUNTER_BUFFER, 0, mCounters );
+
+	// The draw list is rebuilt from scratch
+	GLuint const zero = 0;
+	glClearBufferSubData( GL_ATOMIC_COUNTER_BUFFER, GL_R32UI, sizeof(GLuint), sizeof(GLuint), GL_RED_INTEGER, GL_UNSIGNED_INT, &zero );
+
+	if( aEmitCount > 0 )
+	{
+		glUseProgram( mPrograms.emit.programId() );
+		glUniform1ui( 0, GLuint(mMaxParticles) );
+		glUniform1ui( 1, aEmitCount );
+		glUniform1ui( 2, mFrame );
+		glUniform3f( 3, aEmitPosition.x, aEmitPosition.y, aEmitPosition.z );
+		glUniform3f( 4, mEmitter.baseVelocity.x, mEmitter.baseVelocity.y, mEmitter.baseVelocity.z );
+		glUniform1f( 5, mEmitter.spread );
+		glUniform1f( 6, mEmitter.halfSize );
+		glDispatchCompute( work_groups_( aEmitCount ), 1, 1 );
+
+		glMemoryBarrier( GL_SHADER_STORAGE_BARRIER_BIT | GL_ATOMIC_COUNTER_BARRIER_BIT );
+	}
+
+	glUseProgram( mPrograms.update.programId() );
+	glUniform1ui( 0, GLuint(mMaxParticles) );
+	glUniform1f( 1, aDeltaTime );
+	glUniform1f( 2, aDeltaTime / mEmitter.lifetime );
+	glDispatchCompute( work_groups_( mMaxParticles ), 1, 1 );
+
+	glMemoryBarrier( GL_SHADER_STORAGE_BARRIER_BIT | GL_ATOMIC_COUNTER_BARRIER_BIT );
+
+	glUseProgram( mPrograms.finalize.programId() );
+	glUniform1ui( 1, GLuint(mIndexCount) );
+	glDispatchCompute( 1, 1, 1 );
+
+	// The draw command is consumed by glDrawElementsIndirect(), the sort size
+	// by glDispatchComputeIndirect(), and the particles and draw list by
+	// sort() and the particle vertex shader
+	glMemoryBarrier( GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT );
+
+	glUseProgram( 0 );
+}
+
+void GpuParticles::sort( std::span<ViewSetup const> aViews )
+{
+	PROFILE_GPU( "particle sort" );
+
+	assert( aViews.size() <= kMaxViews );
+
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 0, mParticles );
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 2, mDrawList );
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 8, mHistogram );
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 9, mSortSize );
+	glBindBuffer( GL_DISPATCH_INDIRECT_BUFFER, mSortSize );
+
+	for( std::size_t view = 0; view < aViews.size(); ++view )
+	{
+		auto const& setup = aViews[view];
+		auto const forward = view_forward( setup );
+
+		// Keys and slots of the live particles
+		glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 6, mKeys[0] );
+		glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 7, mValues[0] );
+
+		glUseProgram( mPrograms.sortKeys.programId() );
+		glUniform3f( 1, setup.position.x, setup.position.y, setup.position.z );
+		glUniform3f( 2, forward.x, forward.y, forward.z );
+		glDispatchComputeIndirect( 0 );
+
+		// Four passes of 8 bits, ping-ponging between the buffers. The last
+		// pass writes the values straight to this view's sorted list.
+		for( GLuint pass = 0; pass < 4; ++pass )
+		{
+			glMemoryBarrier( GL_SHADER_STORAGE_BARRIER_BIT );
+
+			glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 4, mKeys[pass % 2] );
+			glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 5, mValues[pass % 2] );
+			glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 6, mKeys[(pass+1) % 2] );
+			if( 3 == pass )
+				glBindBufferRange( GL_SHADER_STORAGE_BUFFER, 7, mSorted, GLintptr(view) * mSortedStride, mSortedStride );
+			else
+				glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 7, mValues[(pass+1) % 2] );
+
+			glUseProgram( mPrograms.sortHistogram.programId() );
+			glUniform1ui( 0, 8 * pass );
+			glDispatchComputeIndirect( 0 );
+
+			glMemoryBarrier( GL_SHADER_STORAGE_BARRIER_BIT );
+
+			glUseProgram( mPrograms.sortScan.programId() );
+			glDispatchCompute( 1, 1, 1 );
+
+			glMemoryBarrier( GL_SHADER_STORAGE_BARRIER_BIT );
+
+			glUseProgram( mPrograms.sortScatter.programId() );
+			glUniform1ui( 0, 8 * pass );
+			glDispatchComputeIndirect( 0 );
+		}
+
+		// The next view starts over from the draw list
+		glMemoryBarrier( GL_SHADER_STORAGE_BARRIER_BIT );
+	}
+
+	glBindBuffer( GL_DISPATCH_INDIRECT_BUFFER, 0 );
+	glUseProgram( 0 );
+}
+
+void GpuParticles::bind_for_draw() const
+{
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 0, mParticles );
+}
+
+void GpuParticles::draw( std::size_t aView ) const
+{
+	assert( aView < kMaxViews );
+
+	glBindBufferRange( GL_SHADER_STORAGE_BUFFER, 2, mSorted, GLintptr(aView) * mSortedStride, mSortedStride );
+
+	glBindBuffer( GL_DRAW_INDIRECT_BUFFER, mCommand );
+	glDrawElementsIndirect( GL_TRIANGLES, GL_UNSIGNED_INT, nullptr );
+	glBindBuffer( GL_DRAW_INDIRECT_BUFFER, 0 );
+}
+
+BoundingSphere GpuParticles::bounds() const noexcept
+{
+	AABB emitted = kEmptyAABB;
+	for( auto const& emission : mEmissions )
+		emitted = expand( emitted, emission.position );
+
+	auto sphere = make_bounding_sphere( emitted );
+	if( is_empty( sphere ) )
+		return sphere;
+
+	// Furthest that a particle can travel, plus its billboard in any
+	// orientation
+	auto const maxSpeed = length( mEmitter.baseVelocity ) + mEmitter.spread * std::numbers::sqrt3_v<float>;
+	sphere.radius += maxSpeed * mEmitter.lifetime + mEmitter.halfSize * std::numbers::sqrt2_v<float>;
+	return sphere;
+}
+
+GpuParticles create_gpu_particles( std::size_t aMaxParticles, GLsizei aIndexCount, ParticleEmitter const& aEmitter )
+{
+	assert( aMaxParticles > 0 );
+	assert( aEmitter.lifetime > 0.f );
+
+	char const* const sim = "assets/cw2/particle_sim.comp";
+	char const* const sort = "assets/cw2/particle_sort.comp";
+
+	GpuParticles ret( GpuParticles::Programs_{
+		load_pass_( sim, "EMIT" ), load_pass_( sim, "UPDATE" ), load_pass_( sim, "FINALIZE" ),
+		load_pass_( sort, "KEYS" ), load_pass_( sort, "HISTOGRAM" ), load_pass_( sort, "SCAN" ), load_pass_( sort, "SCATTER" )
+	} );
+	ret.mMaxParticles = aMaxParticles;
+	ret.mIndexCount = aIndexCount;
+	ret.mEmitter = aEmitter;
+
+	auto const listBytes = GLsizeiptr(aMaxParticles * sizeof(GLuint));
+
+	ret.mParticles = create_storage_( GLsizeiptr(aMaxParticles * sizeof(GpuParticle_)), nullptr );
+	ret.mDeadList = create_storage_( listBytes, nullptr );
+	ret.mDrawList = create_storage_( listBytes, nullptr );
+	ret.mCommand = create_storage_( sizeof(DrawElementsIndirectCommand), nullptr );
+
+	glGenBuffers( 1, &ret.mCounters );
+	glBindBuffer( GL_ATOMIC_COUNTER_BUFFER, ret.mCounters );
+	glBufferData( GL_ATOMIC_COUNTER_BUFFER, 2 * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY );
+	glBindBuffer( GL_ATOMIC_COUNTER_BUFFER, 0 );
+
+	ret.mKeys[0] = create_storage_( listBytes, nullptr );
+	ret.mKeys[1] = create_storage_( listBytes, nullptr );
+	ret.mValues[0] = create_storage_( listBytes, nullptr );
+	ret.mValues[1] = create_storage_( listBytes, nullptr );
+	ret.mHistogram = create_storage_( GLsizeiptr(kSortRadix_ * work_groups_( aMaxParticles, kSortTileSize_ ) * sizeof(GLuint)), nullptr );
+	ret.mSortSize = create_storage_( sizeof(SortSize_), nullptr );
+
+	// Each view's sorted list is bound as a range, whose offset must be
+	// suitably aligned
+	GLint alignment = 0;
+	glGetIntegerv( GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment );
+	alignment = std::max( alignment, 1 );
+	ret.mSortedStride = (listBytes + alignment-1) / alignment * alignment;
+	ret.mSorted = create_storage_( GLsizeiptr(kMaxViews) * ret.mSortedStride, nullptr );
+
+	ret.reset();
+	return ret;
+}
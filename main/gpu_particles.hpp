@@ -0,0 +1,138 @@
+#ifndef GPU_PARTICLES_HPP_6C010E1A_0654_463C_AF96_2CE159A3ACD1
+#define GPU_PARTICLES_HPP_6C010E1A_0654_463C_AF96_2CE159A3ACD1
+
+#include <glad/glad.h>
+
+#include <span>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../vmlib/vec3.hpp"
+#include "../vmlib/sphere.hpp"
+#include "../vmlib/particles.hpp"
+
+#include "../support/program.hpp"
+
+#include "multiview.hpp"
+
+/* GPU particle simulation
+ *
+ * Particle state lives in shader storage buffers and is simulated by the
+ * compute shaders in assets/cw2/particle_sim.comp (OpenGL 4.3). Nothing is
+ * read back to the CPU. simulate() runs three passes:
+ *
+ *   emit      pops up to aEmitCount free slots off the dead list, a stack
+ *             whose size is kept in an atomic counter, and spawns particles
+ *             in them
+ *   update    ages and moves the live particles. Expired particles are
+ *             pushed back onto the dead list; live ones are appended to the
+ *             draw list.
+ *   finalize  writes the indirect draw command and the indirect dispatch
+ *             size of the sort passes
+ *
+ * sort() then orders the draw list back to front, separately for each view,
+ * with the radix sort in assets/cw2/particle_sort.comp. It uses the same
+ * 32-bit depth keys as DepthSorter (depth_sort.hpp), 8 bits per pass:
+ *
+ *   keys       computes the key of each live particle
+ *   histogram  counts the digits in each tile of 256 keys
+ *   scan       turns the counts into output offsets (a single work group)
+ *   scatter    moves each key to its offset; keys with the same digit keep
+ *              their order, so each pass is stable
+ *
+ * The last pass writes the view's region of the sorted list. The key buffers
+ * are allocated once, for the whole pool, and reused every frame.
+ *
+ * draw() renders the sorted list of one view with glDrawElementsIndirect().
+ * The particle shader, compiled with GPU_PARTICLES, reads the instances
+ * straight from the storage buffers.
+ *
+ * Buffer bindings (shader storage): 0 particles, 1 dead list, 2 draw list
+ * (sorted list when drawing), 3 draw command, 4-7 sort keys and values (in
+ * and out), 8 sort histogram, 9 sort size. Atomic counter binding 0 holds the
+ * sizes of the dead list and the draw list.
+ *
+ * Particles are spawned as described by a ParticleEmitter (particles.hpp).
+ */
+class GpuParticles final
+{
+	public:
+		~GpuParticles();
+
+		GpuParticles( GpuParticles const& ) = delete;
+		GpuParticles& operator= (GpuParticles const&) = delete;
+
+		GpuParticles( GpuParticles&& ) noexcept;
+		GpuParticles& operator= (GpuParticles&&) noexcept;
+
+	public:
+		// Kills all particles
+		void reset();
+
+		// Advances the simulation by aDeltaTime and emits up to aEmitCount new
+		// particles at aEmitPosition (fewer if the pool is exhausted).
+		void simulate( float aDeltaTime, Vec3f aEmitPosition, unsigned aEmitCount );
+
+		// Orders the live particles back to front for each of the views (at
+		// most kMaxViews).
+		void sort( std::span<ViewSetup const> aViews );
+
+		// Binds the particle storage read by the particle shader.
+		void bind_for_draw() const;
+
+		// Draws every live particle, back to front as seen from view aView.
+		// The particle program and the billboard's VAO must be bound.
+		void draw( std::size_t aView ) const;
+
+		// Conservative world-space bounds of the live particles' billboards,
+		// tracked on the CPU from the emission history.
+		BoundingSphere bounds() const noexcept;
+
+	private:
+		friend GpuParticles create_gpu_particles( std::size_t, GLsizei, ParticleEmitter const& );
+
+		struct Programs_
+		{
+			ShaderProgram emit, update, finalize;
+			ShaderProgram sortKeys, sortHistogram, sortScan, sortScatter;
+		};
+
+		explicit GpuParticles( Programs_ ) noexcept;
+
+		struct Emission_
+		{
+			float age;
+			Vec3f position;
+		};
+
+		Programs_ mPrograms;
+
+		GLuint mParticles;
+		GLuint mDeadList;
+		GLuint mDrawList;
+		GLuint mCommand;
+		GLuint mCounters;
+
+		// Sort buffers
+		GLuint mKeys[2];
+		GLuint mValues[2];
+		GLuint mHistogram;
+		GLuint mSortSize;
+		GLuint mSorted;
+
+		std::size_t mMaxParticles;
+		GLsizeiptr mSortedStride; // bytes per view in mSorted
+		GLsizei mIndexCount;
+		ParticleEmitter mEmitter;
+
+		std::uint32_t mFrame;
+		std::vector<Emission_> mEmissions;
+};
+
+// aMaxParticles is the size of the pool; aIndexCount the number of indices
+// of the billboard mesh (see make_particle_quad()).
+GpuParticles create_gpu_particles( std::size_t aMaxParticles, GLsizei aIndexCount, ParticleEmitter const& );
+
+#endif // GPU_PARTICLES_HPP_6C010E1A_0654_463C_AF96_2CE159A3ACD1
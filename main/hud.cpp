@@ -0,0 +1,386 @@
+#include "hud.hpp"
+
+#include <utility>
+#include <algorithm>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include <fontstash.h>
+
+#include "../support/error.hpp"
+
+namespace
+{
+	// Holds the printable ASCII range at the HUD's size many times over
+	constexpr int kAtlasSize_ = 512;
+
+	constexpr float kFontSize_ = 16.f;
+	constexpr float kPadding_ = 8.f;
+
+	constexpr float kGraphWidth_ = 2.f * float(kHudHistory);
+	constexpr float kGraphHeight_ = 48.f;
+
+	constexpr std::uint32_t rgba_( std::uint32_t aR, std::uint32_t aG, std::uint32_t aB, std::uint32_t aA ) noexcept
+	{
+		return aR | (aG << 8) | (aB << 16) | (aA << 24);
+	}
+
+	constexpr std::uint32_t kText_ = rgba_( 255, 255, 255, 255 );
+	constexpr std::uint32_t kBackground_ = rgba_( 0, 0, 0, 160 );
+	constexpr std::uint32_t kGraphBackground_ = rgba_( 255, 255, 255, 24 );
+	constexpr std::uint32_t kCpuGraph_ = rgba_( 96, 208, 96, 255 );
+	constexpr std::uint32_t kGpuGraph_ = rgba_( 240, 160, 48, 255 );
+
+	// Average of the samples that are known (not negative)
+	float average_( std::array<float, kHudHistory> const& aSamples, std::size_t aCount ) noexcept
+	{
+		float sum = 0.f;
+		std::size_t known = 0;
+		for( std::size_t i = 0; i < aCount; ++i )
+		{
+			if( aSamples[i] >= 0.f )
+			{
+				sum += aSamples[i];
+				++known;
+			}
+		}
+		return known ? sum / float(known) : -1.f;
+	}
+
+	// e.g. "1.25M"
+	void format_count_( char* aOut, std::size_t aSize, std::uint64_t aCount )
+	{
+		if( aCount >= 1000000 )
+			std::snprintf( aOut, aSize, "%.2fM", double(aCount) * 1e-6 );
+		else if( aCount >= 1000 )
+			std::snprintf( aOut, aSize, "%.1fk", double(aCount) * 1e-3 );
+		else
+			std::snprintf( aOut, aSize, "%u", unsigned(aCount) );
+	}
+
+	void format_ms_( char* aOut, std::size_t aSize, float aMs )
+	{
+		if( aMs < 0.f )
+			std::snprintf( aOut, aSize, "--" );
+		else
+			std::snprintf( aOut, aSize, "%.2f ms", aMs );
+	}
+}
+
+Hud::Hud( ShaderProgram aProgram ) noexcept
+	: mFons( nullptr )
+	, mFont( FONS_INVALID )
+	, mAtlas( 0 )
+	, mWhiteS( 0.f )
+	, mWhiteT( 0.f )
+	, mVao( 0 )
+	, mProgram( std::move(aProgram) )
+	, mFrameMs{}
+	, mCpuMs{}
+	, mGpuMs{}
+	, mNext( 0 )
+	, mCount( 0 )
+	, mLast{}
+{}
+
+Hud::~Hud()
+{
+	if( 0 != mVao )
+		glDeleteVertexArrays( 1, &mVao );
+	if( 0 != mAtlas )
+		glDeleteTextures( 1, &mAtlas );
+	if( mFons )
+		fonsDeleteInternal( mFons );
+}
+
+Hud::Hud( Hud&& aOther ) noexcept
+	: mFons( std::exchange( aOther.mFons, nullptr ) )
+	, mFont( aOther.mFont )
+	, mAtlas( std::exchange( aOther.mAtlas, 0 ) )
+	, mWhiteS( aOther.mWhiteS )
+	, mWhiteT( aOther.mWhiteT )
+	, mVao( std::exchange( aOther.mVao, 0 ) )
+	, mProgram( std::move(aOther.mProgram) )
+	, mVertices( std::move(aOther.mVertices) )
+	, mFrameMs( aOther.mFrameMs )
+	, mCpuMs( aOther.mCpuMs )
+	, mGpuMs( aOther.mGpuMs )
+	, mNext( aOther.mNext )
+	, mCount( aOther.mCount )
+	, mLast( aOther.mLast )
+{}
+Hud& Hud::operator= (Hud&& aOther) noexcept
+{
+	std::swap( mFons, aOther.mFons );
+	std::swap( mFont, aOther.mFont );
+	std::swap( mAtlas, aOther.mAtlas );
+	std::swap( mWhiteS, aOther.mWhiteS );
+	std::swap( mWhiteT, aOther.mWhiteT );
+	std::swap( mVao, aOther.mVao );
+	std::swap( mProgram, aOther.mProgram );
+	std::swap( mVertices, aOther.mVertices );
+	std::swap( mFrameMs, aOther.mFrameMs );
+	std::swap( mCpuMs, aOther.mCpuMs );
+	std::swap( mGpuMs, aOther.mGpuMs );
+	std::swap( mNext, aOther.mNext );
+	std::swap( mCount, aOther.mCount );
+	std::swap( mLast, aOther.mLast );
+	return *this;
+}
+
+void Hud::add_frame( HudFrameStats const& aStats )
+{
+	mFrameMs[mNext] = aStats.frameMs;
+	mCpuMs[mNext] = aStats.cpuMs;
+	mGpuMs[mNext] = aStats.gpuMs;
+	mNext = (mNext + 1) % kHudHistory;
+	mCount = std::min( mCount + 1, kHudHistory );
+
+	mLast = aStats;
+}
+
+void Hud::draw( StreamBuffer& aStream, float aWidth, float aHeight )
+{
+	mVertices.clear();
+
+	// The background goes first, but its size is only known at the end
+	add_rect_( 0.f, 0.f, 0.f, 0.f, kBackground_ );
+
+	float const frameMs = average_( mFrameMs, mCount );
+	float const cpuMs = average_( mCpuMs, mCount );
+	float const gpuMs = average_( mGpuMs, mCount );
+
+	float ascender = 0.f, descender = 0.f, lineHeight = 0.f;
+	fonsSetFont( mFons, mFont );
+	fonsSetSize( mFons, kFontSize_ );
+	fonsSetAlign( mFons, FONS_ALIGN_LEFT | FONS_ALIGN_TOP );
+	fonsVertMetrics( mFons, &ascender, &descender, &lineHeight );
+
+	char line[128], a[32], b[32];
+	float right = 0.f;
+	float y = kPadding_;
+	auto const text = [&] (std::uint32_t aColor) {
+		right = std::max( right, add_text_( kPadding_, y, line, aColor ) );
+		y += lineHeight;
+	};
+
+	std::snprintf( line, sizeof(line), "%.0f FPS (%.2f ms)", frameMs > 0.f ? 1000.f / frameMs : 0.f, std::max( frameMs, 0.f ) );
+	text( kText_ );
+
+	format_ms_( a, sizeof(a), cpuMs );
+	format_ms_( b, sizeof(b), gpuMs );
+	std::snprintf( line, sizeof(line), "CPU %s  GPU %s", a, b );
+	text( kText_ );
+
+	format_count_( a, sizeof(a), mLast.triangles );
+	std::snprintf( line, sizeof(line), "draws %u  dispatches %u  triangles %s", mLast.gl.drawCalls, mLast.gl.dispatches, a );
+	text( kText_ );
+
+	std::snprintf( line, sizeof(line), "binds %u  uniforms %u", state_changes( mLast.gl ), mLast.gl.uniformCalls );
+	text( kText_ );
+
+	if( mLast.particlesOnGpu )
+		std::snprintf( line, sizeof(line), "particles (on GPU)" );
+	else
+	{
+		format_count_( a, sizeof(a), mLast.particles );
+		std::snprintf( line, sizeof(line), "particles %s", a );
+	}
+	text( kText_ );
+
+	std::snprintf( line, sizeof(line), "upload %.1f KiB/frame", double(mLast.gl.uploadBytes) / 1024.0 );
+	text( kText_ );
+
+	// Graphs, oldest frame on the left
+	std::array<float, kHudHistory> ordered;
+	auto const graph = [&] (char const* aName, std::array<float, kHudHistory> const& aSamples, std::uint32_t aColor) {
+		for( std::size_t i = 0; i < kHudHistory; ++i )
+			ordered[i] = aSamples[(mNext + i) % kHudHistory];
+
+		// Scaled to the next whole millisecond above the slowest frame
+		float const slowest = *std::max_element( ordered.begin(), ordered.end() );
+		float const scale = std::max( std::ceil( slowest ), 1.f );
+
+		y += 0.5f * lineHeight;
+		std::snprintf( line, sizeof(line), "%s (max %.0f ms)", aName, scale );
+		text( aColor );
+
+		for( auto& sample : ordered )
+			sample = std::max( sample, 0.f ) / scale;
+		add_graph_( kPadding_, y, kGraphWidth_, kGraphHeight_, ordered, aColor );
+		y += kGraphHeight_;
+	};
+	graph( "CPU", mCpuMs, kCpuGraph_ );
+	graph( "GPU", mGpuMs, kGpuGraph_ );
+
+	right = std::max( right, kPadding_ + kGraphWidth_ );
+
+	mVertices[0].x = mVertices[3].x = mVertices[5].x = 0.f;
+	mVertices[1].x = mVertices[2].x = mVertices[4].x = right + kPadding_;
+	mVertices[0].y = mVertices[1].y = mVertices[3].y = 0.f;
+	mVertices[2].y = mVertices[4].y = mVertices[5].y = y + kPadding_;
+
+	update_atlas_();
+
+	// Whole triangles; anything beyond the budget is cut off
+	auto const count = std::min( mVertices.size(), kHudMaxVertices ) / 3 * 3;
+	auto const alloc = aStream.allocate( count * sizeof(Vertex_) );
+	std::memcpy( alloc.data, mVertices.data(), count * sizeof(Vertex_) );
+
+	GLboolean const depthTest = glIsEnabled( GL_DEPTH_TEST );
+	GLboolean const cullFace = glIsEnabled( GL_CULL_FACE );
+	glDisable( GL_DEPTH_TEST );
+	glDisable( GL_CULL_FACE );
+	glEnable( GL_BLEND );
+	glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+
+	glUseProgram( mProgram.programId() );
+	glUniform2f( 0, aWidth, aHeight );
+
+	glActiveTexture( GL_TEXTURE0 );
+	glBindTexture( GL_TEXTURE_2D, mAtlas );
+
+	glBindVertexArray( mVao );
+	aStream.bind_vertex_buffer( 0, alloc, sizeof(Vertex_) );
+	glDrawArrays( GL_TRIANGLES, 0, GLsizei(count) );
+
+	glBindVertexArray( 0 );
+	glBindTexture( GL_TEXTURE_2D, 0 );
+	glUseProgram( 0 );
+
+	glDisable( GL_BLEND );
+	if( cullFace )
+		glEnable( GL_CULL_FACE );
+	if( depthTest )
+		glEnable( GL_DEPTH_TEST );
+}
+
+void Hud::add_rect_( float aX0, float aY0, float aX1, float aY1, std::uint32_t aColor )
+{
+	Vertex_ const v00{ aX0, aY0, mWhiteS, mWhiteT, aColor };
+	Vertex_ const v10{ aX1, aY0, mWhiteS, mWhiteT, aColor };
+	Vertex_ const v11{ aX1, aY1, mWhiteS, mWhiteT, aColor };
+	Vertex_ const v01{ aX0, aY1, mWhiteS, mWhiteT, aColor };
+
+	mVertices.insert( mVertices.end(), { v00, v10, v11, v00, v11, v01 } );
+}
+
+float Hud::add_text_( float aX, float aY, char const* aText, std::uint32_t aColor )
+{
+	FONStextIter iter;
+	fonsTextIterInit( mFons, &iter, aX, aY, aText, nullptr );
+
+	FONSquad quad;
+	while( fonsTextIterNext( mFons, &iter, &quad ) )
+	{
+		Vertex_ const v00{ quad.x0, quad.y0, quad.s0, quad.t0, aColor };
+		Vertex_ const v10{ quad.x1, quad.y0, quad.s1, quad.t0, aColor };
+		Vertex_ const v11{ quad.x1, quad.y1, quad.s1, quad.t1, aColor };
+		Vertex_ const v01{ quad.x0, quad.y1, quad.s0, quad.t1, aColor };
+
+		mVertices.insert( mVertices.end(), { v00, v10, v11, v00, v11, v01 } );
+	}
+
+	return iter.nextx;
+}
+
+void Hud::add_graph_( float aX, float aY, float aWidth, float aHeight, std::array<float, kHudHistory> const& aSamples, std::uint32_t aColor )
+{
+	add_rect_( aX, aY, aX + aWidth, aY + aHeight, kGraphBackground_ );
+
+	// One bar per frame, growing upwards; aSamples are fractions of aHeight
+	float const barWidth = aWidth / float(kHudHistory);
+	for( std::size_t i = 0; i < kHudHistory; ++i )
+	{
+		float const height = std::min( aSamples[i], 1.f ) * aHeight;
+		if( height > 0.f )
+		{
+			float const x = aX + float(i) * barWidth;
+			add_rect_( x, aY + aHeight - height, x + barWidth, aY + aHeight, aColor );
+		}
+	}
+}
+
+void Hud::update_atlas_()
+{
+	int dirty[4];
+	if( !fonsValidateTexture( mFons, dirty ) )
+		return;
+
+	int width = 0, height = 0;
+	unsigned char const* data = fonsGetTextureData( mFons, &width, &height );
+
+	// Only the dirty rectangle of the atlas is uploaded
+	glBindTexture( GL_TEXTURE_2D, mAtlas );
+	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, width );
+	glPixelStorei( GL_UNPACK_SKIP_PIXELS, dirty[0] );
+	glPixelStorei( GL_UNPACK_SKIP_ROWS, dirty[1] );
+
+	glTexSubImage2D( GL_TEXTURE_2D, 0, dirty[0], dirty[1], dirty[2]-dirty[0], dirty[3]-dirty[1], GL_RED, GL_UNSIGNED_BYTE, data );
+
+	glPixelStorei( GL_UNPACK_SKIP_ROWS, 0 );
+	glPixelStorei( GL_UNPACK_SKIP_PIXELS, 0 );
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+	glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+	glBindTexture( GL_TEXTURE_2D, 0 );
+}
+
+Hud create_hud( char const* aFontPath )
+{
+	Hud ret( ShaderProgram( {
+		{ GL_VERTEX_SHADER, "assets/cw2/hud.vert" },
+		{ GL_FRAGMENT_SHADER, "assets/cw2/hud.frag" }
+	} ) );
+
+	// Glyphs are uploaded by update_atlas_(), so fontstash needs no
+	// rendering callbacks
+	FONSparams params{};
+	params.width = kAtlasSize_;
+	params.height = kAtlasSize_;
+	params.flags = FONS_ZERO_TOPLEFT;
+
+	ret.mFons = fonsCreateInternal( &params );
+	if( !ret.mFons )
+		throw Error( "Unable to create the fontstash context" );
+
+	ret.mFont = fonsAddFont( ret.mFons, "hud", aFontPath );
+	if( FONS_INVALID == ret.mFont )
+		throw Error( "Unable to load font '%s'", aFontPath );
+
+	glGenTextures( 1, &ret.mAtlas );
+	glBindTexture( GL_TEXTURE_2D, ret.mAtlas );
+	glTexStorage2D( GL_TEXTURE_2D, 1, GL_R8, kAtlasSize_, kAtlasSize_ );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+	glBindTexture( GL_TEXTURE_2D, 0 );
+
+	// fontstash places a 2x2 white rectangle at the origin; its center is
+	// white even with linear filtering
+	ret.mWhiteS = 1.f / float(kAtlasSize_);
+	ret.mWhiteT = 1.f / float(kAtlasSize_);
+	ret.update_atlas_();
+
+	glGenVertexArrays( 1, &ret.mVao );
+	glBindVertexArray( ret.mVao );
+
+	glEnableVertexAttribArray( 0 );
+	glVertexAttribFormat( 0, 2, GL_FLOAT, GL_FALSE, offsetof(Hud::Vertex_, x) );
+	glVertexAttribBinding( 0, 0 );
+
+	glEnableVertexAttribArray( 1 );
+	glVertexAttribFormat( 1, 2, GL_FLOAT, GL_FALSE, offsetof(Hud::Vertex_, s) );
+	glVertexAttribBinding( 1, 0 );
+
+	glEnableVertexAttribArray( 2 );
+	glVertexAttribFormat( 2, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(Hud::Vertex_, color) );
+	glVertexAttribBinding( 2, 0 );
+
+	glBindVertexArray( 0 );
+
+	return ret;
+}
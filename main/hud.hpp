@@ -0,0 +1,114 @@
+#ifndef HUD_HPP_7B2E94D1_5C08_4A3F_B61E_0D93A5C7F284
+#define HUD_HPP_7B2E94D1_5C08_4A3F_B61E_0D93A5C7F284
+
+#include <glad/glad.h>
+
+#include <array>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../support/program.hpp"
+#include "../support/gl_stats.hpp"
+
+#include "stream_buffer.hpp"
+
+struct FONScontext;
+
+/* Performance HUD
+ *
+ * Text and frame time graphs drawn over the finished frame. Glyphs are
+ * rasterized on demand by fontstash into a single-channel atlas. The solid
+ * parts (the background and the graph bars) sample the white rectangle that
+ * fontstash keeps at the atlas origin, so that the whole HUD is a single
+ * triangle list. It is written into the frame's stream buffer and drawn
+ * with one glDrawArrays() call, using assets/cw2/hud.vert and hud.frag.
+ *
+ * The graphs show the CPU and GPU frame times of the last kHudHistory
+ * frames; the text shows their averages, so that it stays readable.
+ */
+inline constexpr std::size_t kHudHistory = 120;
+
+// Upper bound of the bytes that draw() allocates from the stream buffer
+inline constexpr std::size_t kHudMaxVertices = 6 * 1024;
+inline constexpr std::size_t kHudStreamBytes = kHudMaxVertices * 20;
+
+struct HudFrameStats
+{
+	float frameMs; // wall clock, from the previous frame
+	float cpuMs;   // negative if unknown
+	float gpuMs;   // negative if unknown
+
+	GlFrameStats gl;
+	std::uint64_t triangles;
+
+	std::size_t particles;
+	bool particlesOnGpu; // count unknown; it stays on the GPU
+};
+
+// Owns the fontstash context, the atlas texture and the VAO. Move-only.
+class Hud final
+{
+	public:
+		~Hud();
+
+		Hud( Hud const& ) = delete;
+		Hud& operator= (Hud const&) = delete;
+
+		Hud( Hud&& ) noexcept;
+		Hud& operator= (Hud&&) noexcept;
+
+	public:
+		void add_frame( HudFrameStats const& );
+
+		// Draws the HUD in the top left corner of the current framebuffer,
+		// which is aWidth by aHeight pixels. The vertices are allocated from
+		// aStream (at most kHudStreamBytes). Blends over the frame without
+		// depth testing; leaves no program, texture or VAO bound.
+		void draw( StreamBuffer& aStream, float aWidth, float aHeight );
+
+	private:
+		friend Hud create_hud( char const* );
+
+		explicit Hud( ShaderProgram ) noexcept;
+
+		struct Vertex_
+		{
+			float x, y; // pixels, from the top left
+			float s, t;
+			std::uint32_t color; // RGBA8
+		};
+
+		static_assert( sizeof(Vertex_) * kHudMaxVertices == kHudStreamBytes );
+
+		void add_rect_( float aX0, float aY0, float aX1, float aY1, std::uint32_t aColor );
+		float add_text_( float aX, float aY, char const* aText, std::uint32_t aColor );
+		void add_graph_( float aX, float aY, float aWidth, float aHeight, std::array<float, kHudHistory> const&, std::uint32_t aColor );
+		void update_atlas_();
+
+		FONScontext* mFons;
+		int mFont;
+
+		GLuint mAtlas;
+		float mWhiteS, mWhiteT; // inside the white rectangle
+		GLuint mVao;
+		ShaderProgram mProgram;
+
+		std::vector<Vertex_> mVertices;
+
+		// Ring buffers, oldest first from mNext
+		std::array<float, kHudHistory> mFrameMs;
+		std::array<float, kHudHistory> mCpuMs;
+		std::array<float, kHudHistory> mGpuMs;
+		std::size_t mNext;
+		std::size_t mCount;
+
+		HudFrameStats mLast;
+};
+
+// Loads the font (a TrueType file). Throws Error if the font can't be
+// loaded. Requires a current OpenGL 4.3 context.
+Hud create_hud( char const* aFontPath );
+
+#endif // HUD_HPP_7B2E94D1_5C08_4A3F_B61E_0D93A5C7F284
@@ -6,6 +6,37 @@
 #include "../vmlib/vec3.hpp"
 #include "../vmlib/vec2.hpp"
 
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+namespace
+{
+	// A vertex is identified by the OBJ attribute indices it was built from,
+	// plus the material (which determines the vertex color).
+	struct VertexKey_
+	{
+		int position;
+		int normal;
+		int texcoord;
+		int material;
+
+		bool operator==(VertexKey_ const&) const = default;
+	};
+
+	struct VertexKeyHash_
+	{
+		std::size_t operator()(VertexKey_ const& aKey) const noexcept
+		{
+			std::uint64_t hash = std::uint32_t(aKey.position);
+			hash = hash * 0x9E3779B97F4A7C15ull ^ std::uint32_t(aKey.normal);
+			hash = hash * 0x9E3779B97F4A7C15ull ^ std::uint32_t(aKey.texcoord);
+			hash = hash * 0x9E3779B97F4A7C15ull ^ std::uint32_t(aKey.material);
+			return std::hash<std::uint64_t>{}(hash);
+		}
+	};
+}
+
 SimpleMeshData load_wavefront_obj(char const* aPath)
 	{
 		// Ask rapidobj to load the requested file
@@ -19,25 +50,43 @@ SimpleMeshData load_wavefront_obj(char const* aPath)
 		// this for us.
 		rapidobj::Triangulate(result);
 
-		// Convert the OBJ data into a SimpleMeshData structure. For now, we simply turn the object into a triangle
-		// soup, ignoring the indexing information that the OBJ file contains.
+		// Convert the OBJ data into an indexed SimpleMeshData structure. OBJ indexes each attribute separately, while
+		// OpenGL uses a single index per vertex. Each distinct combination of (position, normal, texcoord, material)
+		// becomes one vertex; repeated combinations reuse the existing vertex.
 		SimpleMeshData ret;
 
+		std::size_t corners = 0;
+		for (auto const& shape : result.shapes)
+			corners += shape.mesh.indices.size();
+
+		ret.indices.reserve(corners);
+
+		std::unordered_map<VertexKey_, GLuint, VertexKeyHash_> unique;
+		unique.reserve(corners);
+
 		for (auto const& shape : result.shapes)
 		{
 			for (std::size_t i = 0; i < shape.mesh.indices.size(); ++i)
 			{
 				auto const& idx = shape.mesh.indices[i];
 
+				// Always triangles, so we can find the face index by dividing the vertex index by three
+				auto const matId = shape.mesh.material_ids[i / 3];
+
+				VertexKey_ const key{ idx.position_index, idx.normal_index, idx.texcoord_index, matId };
+				auto const [it, inserted] = unique.emplace(key, GLuint(ret.positions.size()));
+				ret.indices.emplace_back(it->second);
+
+				if (!inserted)
+					continue;
+
 				ret.positions.emplace_back(Vec3f{
 					result.attributes.positions[idx.position_index * 3 + 0],
 					result.attributes.positions[idx.position_index * 3 + 1],
 					result.attributes.positions[idx.position_index * 3 + 2]
 				});
 
-				// Always triangles, so we can find the face index by dividing the vertex index by three
-				auto const& mat = result.materials[shape.mesh.material_ids[i / 3]];
-
+				auto const& mat = result.materials[matId];
 
 				// Just replicate the material ambient color for each vertex...
 				ret.colors.emplace_back(Vec3f{
@@ -1,38 +1,60 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <span>
+#include <array>
+#include <string>
+#include <vector>
 #include <numbers>
+#include <optional>
+#include <algorithm>
 #include <typeinfo>
 #include <stdexcept>
 #include <iostream>
 
 #include <cstdio>
+#include <cstddef>
 #include <cstdlib>
+#include <cstdint>
+#include <cstring>
 
 #include "../support/error.hpp"
 #include "../support/program.hpp"
 #include "../support/checkpoint.hpp"
+#include "../support/profiler.hpp"
+#include "../support/gl_stats.hpp"
 #include "../support/debug_output.hpp"
+#include "../support/job_system.hpp"
 
 #include "../vmlib/vec2.hpp"
 #include "../vmlib/vec4.hpp"
 #include "../vmlib/vec3.hpp"
 #include "../vmlib/mat44.hpp"
 #include "../vmlib/mat33.hpp"
+#include "../vmlib/transform.hpp"
+#include "../vmlib/sphere.hpp"
+#include "../vmlib/frustum.hpp"
+#include "../vmlib/particles.hpp"
+#include "../vmlib/depth_sort.hpp"
 
 #include "defaults.hpp"
 #include "rapidobj/rapidobj.hpp"
 #include "texture.hpp"
 #include "simple_mesh.hpp"
 #include "loadobj.hpp"
+#include "mesh_cache.hpp"
+#include "mesh_optimize.hpp"
+#include "mesh_simplify.hpp"
+#include "multiview.hpp"
 #include "shapes.hpp"
+#include "stream_buffer.hpp"
+#include "frame_uniforms.hpp"
+#include "gpu_particles.hpp"
+#include "render_queue.hpp"
+#include "benchmark.hpp"
+#include "hud.hpp"
 
-//#define PREPARE_BENCHMARK // Uncomment this to prepare benchmarking
-//#define ENABLE_BENCHMARK_FULL // Uncomment this to benchmark full rendering time
-//#define ENABLE_BENCHMARK_12 // Uncomment this to benchmark 1.2 rendering time
-//#define ENABLE_BENCHMARK_14 // Uncomment this to benchmark 1.4 rendering time
-//#define ENABLE_BENCHMARK_15 // Uncomment this to benchmark 1.5 rendering time
-//#define CPU_BENCHMARK // Uncomment this to benchmark CPU time
+//#define PREPARE_BENCHMARK // Uncomment this to turn off V-Sync and the debug context when profiling
 
 namespace
 {
@@ -41,36 +63,78 @@ namespace
 	constexpr float kMovementPerSecond_ = 5.f;
 	constexpr float kMouseSensitivity_ = 0.01f;
 
-    // Set up query queues for benchmarking
-    bool swapQueue = true;
-    GLuint queryQueueA[2], queryQueueB[2];
-    int frameCount = 0;
+	// Half of the width of a particle billboard
+	constexpr float kParticleHalfSize_ = 0.5f;
 
-	struct Particle_
+	// Seconds that a particle lives for
+	constexpr float kParticleLifetime_ = 0.5f;
+
+	// Rocket exhaust: downward velocity with a random spread
+	constexpr ParticleEmitter kParticleEmitter_{ kParticleLifetime_, kParticleHalfSize_, { 0.f, -2.f, 0.f }, 0.4f };
+
+	// Objects drawn and skipped by frustum culling in one viewport and frame.
+	// Terrain tiles count individually.
+	struct CullStats_
 	{
-		bool  active = false;
-		float life = 0.f;
-		Vec3f position;
-		Vec3f direction;
+		unsigned drawn = 0;
+		unsigned culled = 0;
 	};
 
-	Vec3f random_spread()
+	// How often the culling statistics in the window title are updated
+	constexpr double kCullReportInterval_ = 0.5;
+
+	// How often the profiler's zones are printed while it is enabled
+	constexpr double kProfileReportInterval_ = 2.0;
+
+	// Captures started with T stop after this many seconds, or when T is
+	// pressed again, and are written to kTraceFile_
+	constexpr double kTraceDuration_ = 10.0;
+	constexpr char const* kTraceFile_ = "trace.json";
+
+	// Vertical field of view of all views (radians); terrain LOD selection
+	// uses it too
+	constexpr float kFieldOfView_ = 60.f * std::numbers::pi_v<float> / 180.f;
+
+	// Distance of the far plane; render queue depths are relative to it
+	constexpr float kFarPlane_ = 100.f;
+
+	// Per-frame space for uniform blocks (see frame_uniforms.hpp): the frame
+	// block plus one block per object, each aligned to
+	// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.
+	constexpr std::size_t kUniformStreamBytes_ = 4096;
+
+	// Per-instance particle data, streamed every frame. The billboard quad
+	// itself is static (see make_particle_quad()).
+	struct ParticleInstance_
 	{
-		return {
-			// Positive spread along X
-			// Positive spread along Y
-			// Positive spread along Z
-			float(std::rand()) / RAND_MAX * 0.4f,
-			float(std::rand()) / RAND_MAX * 0.4f,
-			float(std::rand()) / RAND_MAX * 0.4f
-		};
-	}
+		Vec3f center;
+		float halfSize;
+		float life; // fraction of the lifetime left
+	};
+
+	static_assert(sizeof(ParticleInstance_) == 5 * sizeof(float));
+
+	// Vertex buffer binding point of the per-instance particle data. The
+	// quad's attributes use the binding points of their locations (0 and 3).
+	constexpr GLuint kParticleInstanceBinding_ = 5;
+
 	struct State_
 	{
 		ShaderProgram* prog = nullptr;
 		ShaderProgram* landingpadprog = nullptr;
 		ShaderProgram* particleprog = nullptr;
 
+		// Variants of the above for split-screen (see multiview.hpp)
+		ShaderProgram* multiviewprog = nullptr;
+		ShaderProgram* multiviewLandingpadprog = nullptr;
+		ShaderProgram* multiviewParticleprog = nullptr;
+
+		// Variants of the particle programs that read the particles simulated
+		// on the GPU (see gpu_particles.hpp)
+		ShaderProgram* gpuParticleprog = nullptr;
+		ShaderProgram* multiviewGpuParticleprog = nullptr;
+		EMultiviewMode multiviewMode = EMultiviewMode::ePerView;
+
 		bool splitScreen = false;
 
 		struct CamCtrl_
@@ -97,8 +161,9 @@ namespace
 		} camControl;
 
 
-		CamCtrl_ camControl1;
-		CamCtrl_ camControl2;
+		// Cameras of the split-screen views
+		std::array<CamCtrl_, kMaxViews> splitCams;
+		std::size_t splitViews = 2;
 
 		struct RockCtrl_
 		{
@@ -124,17 +189,68 @@ namespace
 
 		struct ParticleSys_
 		{
-			static constexpr int kMaxParticles_ = 200;
+			static constexpr int kMaxParticles_ = 4096;
 
-			std::array<Particle_, kMaxParticles_> particles_;
+			// Structure of arrays; only the live particles are touched (see
+			// particles.hpp)
+			ParticlePool pool{ kMaxParticles_ };
+
+			// Seeds the random velocities of each frame's new particles
+			std::uint64_t emitSeed = 0;
+
+			// Back-to-front order of the particles in each view, for blending
+			std::array<DepthSorter, kMaxViews> sorters;
 
 			float emitRate = 50.f;
 			float deltatimeEmit = 0.f; 
 			GLuint texture = 0;         
+
+			// World-space bounds of the active particles' billboards
+			BoundingSphere bounds = kEmptySphere;
+
+			// Simulate on the GPU instead of the CPU (toggled with G)
+			bool useGpu = false;
+			bool switchSimulator = false;
+			GpuParticles* gpu = nullptr;
 		} particleSys;
 
-		GLuint particleVao = 0;
-		GLuint particleVbo = 0;
+		// Per viewport (only the first is used without split-screen)
+		CullStats_ cullStats[kMaxViews];
+		double lastCullReport = 0.0;
+
+		// Opaque draws, sorted by state (see render_queue.hpp)
+		RenderQueue* renderQueue = nullptr;
+		RenderQueueStats queueStats;
+
+		// Particle triangles in the last frame. Particles simulated on the
+		// GPU add none, since their number isn't known on the CPU.
+		std::uint64_t particleTriangles = 0;
+
+		// GL calls and uploads of the last complete frame (see gl_stats.hpp)
+		GlFrameStats glStats{};
+
+		// Unit quad, with the per-instance attributes added
+		GpuMesh const* particleQuad = nullptr;
+
+		// Unit quad without them, for the particles simulated on the GPU
+		GpuMesh const* gpuParticleQuad = nullptr;
+
+		// Worker threads for the CPU particle update
+		JobSystem* jobs = nullptr;
+
+		// The profiler runs while its report is printed (toggled with P) or
+		// while the HUD is shown (toggled with H)
+		Profiler* profiler = nullptr;
+		bool printProfile = false;
+		double lastProfileReport = 0.0;
+
+		Hud* hud = nullptr;
+		bool showHud = false;
+
+		// Trace capture (toggled with T, see update_trace_())
+		double traceStart = 0.0;
+		bool traceRequested = false;
+		bool traceWritePending = false;
 	};
 
 	void glfw_callback_error_(int, char const*);
@@ -155,59 +271,69 @@ namespace
 		GLFWwindow* window;
 	};
 
-	Vec3f transform_position(const Mat44f& model2world, const Vec3f& localPos)
-	{
-		Vec4f transformed = model2world * Vec4f(localPos.x, localPos.y, localPos.z, 1.0f);
-		return Vec3f{ transformed.x, transformed.y, transformed.z };
-	}
-	void rendervaotext(
-		const Mat44f& projCameraWorld,
-		const Mat33f& normalMatrix,
-		GLuint texture,
-		GLuint vao,
-		std::size_t vertexCount) {
-
-		glUniformMatrix4fv(0, 1, GL_TRUE, projCameraWorld.v);
-		glUniformMatrix3fv(1, 1, GL_TRUE, normalMatrix.v);
-		glBindVertexArray(vao);
-		glDrawArrays(GL_TRIANGLES, 0, vertexCount);
-
-		glBindVertexArray(0);
-		glBindTexture(GL_TEXTURE_2D, 0);
-	}
+	// Level of detail selection for the terrain: the coarsest level whose
+	// error projects to at most this many pixels.
+	constexpr float kTerrainLodPixelError = 1.f;
+
+	// The terrain is split into kTerrainTiles x kTerrainTiles tiles, which are
+	// culled against the view frustum and get their own level of detail.
+	constexpr unsigned kTerrainTiles = 8;
+
+	// Levels of detail of the terrain (of each tile), including full detail
+	constexpr unsigned kTerrainLodLevels = 5;
+
+	// Per-frame space for the render queue's indirect commands: one per
+	// terrain tile and object, in every view's pass if the views are drawn
+	// one at a time (plus alignment).
+	constexpr std::size_t kQueueStreamBytes_ = kMaxViews
+		* ((kTerrainTiles * kTerrainTiles + 3) * sizeof(DrawElementsIndirectCommand) + alignof(DrawElementsIndirectCommand));
+
+	// Cameras and lights for all programs (see frame_uniforms.hpp)
+	FrameUniforms make_frame_uniforms_(
+		std::span<ViewSetup const> views,
+		Vec3f const* pointLightPos,
+		Vec3f const* pointLightsColor) {
+		FrameUniforms frame{};
+		for (std::size_t i = 0; i < views.size(); ++i) {
+			frame.viewProj[i] = views[i].projView;
+			frame.viewPositions[i] = to_std140(views[i].position);
+			frame.viewRight[i] = to_std140(views[i].right);
+			frame.viewUp[i] = to_std140(views[i].up);
+		}
 
-    void rendertexture(GLuint texture) {
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture);
-    }
+		for (std::size_t i = 0; i < kPointLightCount; ++i) {
+			frame.pointLightPos[i] = to_std140(pointLightPos[i]);
+			frame.pointLightColor[i] = to_std140(pointLightsColor[i]);
+		}
 
-	void renderlight(
-		const State_& state,
-		Vec3f* pointLightPos = nullptr,
-		Vec3f* pointLightsColor = nullptr) {
 		//light
-		Vec3f lightDirRocket = normalize(Vec3f{ 0.f, 1.f, -1.f });
-		glUniform3fv(2, 1, &lightDirRocket.x);
-
-		glUniform3f(3, 0.9f, 0.9f, 0.6f);
-		glUniform3f(4, 0.05f, 0.05f, 0.05f);
-		glUniform3fv(5, 3, &pointLightPos[0].x);
-		glUniform3fv(8, 3, &pointLightsColor[0].x);
-		glUniform3f(11, state.camControl.position.x, state.camControl.position.y, state.camControl.position.z);
-		glUniform1f(12, 32.0f);
+		frame.lightDir = normalize(Vec3f{ 0.f, 1.f, -1.f });
+		frame.lightDiffuse = Vec3f{ 0.9f, 0.9f, 0.6f };
+		frame.sceneAmbient = Vec3f{ 0.05f, 0.05f, 0.05f };
+		frame.shininess = 32.0f;
+		return frame;
 	}
-	void rendervao(
-		const Mat44f& projCameraWorld,
-		const Mat44f& model2world,
-		const Mat33f& normalMatrix,
-		GLuint vao,
-		std::size_t vertexCount) {
-		glUniformMatrix4fv(0, 1, GL_TRUE, projCameraWorld.v);
-		glUniformMatrix3fv(1, 1, GL_TRUE, normalMatrix.v);
-		glUniformMatrix4fv(13, 1, GL_TRUE, model2world.v);
-		glBindVertexArray(vao);
-		glDrawArrays(GL_TRIANGLES, 0, vertexCount);
-		glBindVertexArray(0);
+
+	// Copies a uniform block into this frame's region of the stream buffer
+	template <typename T>
+	StreamBuffer::Allocation upload_uniforms_(StreamBuffer& stream, T const& block, std::size_t alignment) {
+		auto const alloc = stream.allocate(sizeof(T), alignment);
+		std::memcpy(alloc.data, &block, sizeof(T));
+		return alloc;
+	}
+
+	// Load an OBJ file (through the mesh cache) and report how long loading
+	// took and how many unique vertices remained after indexing.
+	CachedMesh load_obj_verbose(char const* aPath, MeshProcessing const& aProcessing = {}) {
+		auto const start = Clock::now();
+		auto mesh = load_wavefront_obj_cached(aPath, aProcessing);
+		auto const elapsed = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(Clock::now() - start);
+
+		auto const view = mesh.view();
+		std::printf("Loaded '%s' in %.1f ms (%s): %zu corners -> %zu unique vertices\n",
+			aPath, elapsed.count(), mesh.from_cache() ? "cached" : "parsed OBJ",
+			view.indices.size(), view.positions.size());
+		return mesh;
 	}
 
 
@@ -301,168 +427,496 @@ namespace
 		// https://www.youtube.com/watch?v=6PkjU9LaDTQ
 		// https://www.youtube.com/watch?v=JXhOYS8mZzg
 		// https://gamedev.stackexchange.com/questions/1679/fastest-way-to-create-a-simple-particle-effect
+		PROFILE_CPU("particle update");
+
+		auto& sys = state.particleSys;
+
+		// Particles don't carry over when switching simulators
+		if (sys.switchSimulator)
+		{
+			sys.switchSimulator = false;
+			sys.useGpu = !sys.useGpu;
+
+			if (sys.useGpu)
+				sys.gpu->reset();
+			else
+				sys.pool.clear();
+			sys.bounds = kEmptySphere;
+		}
+
 		// Skip updating if the rocket is paused
 		if (state.rockControl.pause) return;
 
 		// Handle particle emission only if the rocket is playing
+		int numParticle = 0;
 		if (state.rockControl.play)
 		{
-			state.particleSys.deltatimeEmit += deltaTime;
-			int numParticle = static_cast<int>(state.particleSys.emitRate * state.particleSys.deltatimeEmit);
-			state.particleSys.deltatimeEmit -= numParticle / state.particleSys.emitRate;
-
-			//calculate exhaust position
-			Vec3f exhaustPos = state.rockControl.position + Vec3f{ 0.f, -1.f, 0.f };
+			sys.deltatimeEmit += deltaTime;
+			numParticle = static_cast<int>(sys.emitRate * sys.deltatimeEmit);
+			sys.deltatimeEmit -= numParticle / sys.emitRate;
+		}
 
-			for (auto& p : state.particleSys.particles_)
-			{
-				//stop if limit reached
-				if (numParticle <= 0) break;
-				if (!p.active)
-				{
-					p.active = true;
-					p.life = 0.5f;
-					p.position = exhaustPos;
+		//calculate exhaust position
+		Vec3f exhaustPos = state.rockControl.position + Vec3f{ 0.f, -1.f, 0.f };
 
-					// Downward velocity spread
-					p.direction = Vec3f{ 0.f, -2.f, 0.f } + random_spread();
-					numParticle--;
-				}
-			}
+		if (sys.useGpu)
+		{
+			sys.gpu->simulate(deltaTime, exhaustPos, unsigned(numParticle));
+			sys.bounds = sys.gpu->bounds();
+			return;
 		}
 
+		// Chunks of the pool are spawned and updated on the worker threads.
+		// Emission is deterministic: every chunk has its own random stream.
+		auto const parallel_for = [&](std::size_t count, auto const& job) {
+			state.jobs->parallel_for(count, [&](std::size_t chunk) {
+				PROFILE_TRACE("particle chunk");
+				job(chunk);
+			});
+		};
+
+		// Stops if limit reached
+		if (numParticle > 0)
+			sys.pool.emit(std::size_t(numParticle), exhaustPos, kParticleEmitter_, sys.emitSeed++, parallel_for);
+
 		// Update existing particles
-		for (auto& p : state.particleSys.particles_)
-		{
-			if (!p.active) continue;
+		AABB const centers = sys.pool.update(deltaTime, parallel_for);
 
-			p.life -= deltaTime;
-			if (p.life <= 0.f)
-			{
-				p.active = false;
-			}
+		// Billboards face the camera, so any orientation must be covered
+		auto& bounds = sys.bounds;
+		bounds = make_bounding_sphere(centers);
+		if (!is_empty(bounds))
+			bounds.radius += kParticleHalfSize_ * std::numbers::sqrt2_v<float>;
+	}
+
+	// Per-frame scene data shared by all views
+	struct SceneFrame_
+	{
+		GpuMesh const* terrain;
+		Mat44f terrainModel;
+		GLuint terrainTexture;
+
+		GpuMesh const* landingpad;
+		Mat44f landingpadModel[2];
+
+		GpuMesh const* rocket;
+		Mat44f rocketModel;
+
+		// Per-object uniform blocks in this frame's region of the stream
+		// buffer, which the render queue also takes its commands from
+		StreamBuffer* stream;
+		StreamBuffer::Allocation terrainObject;
+		StreamBuffer::Allocation landingpadObject[2];
+		StreamBuffer::Allocation rocketObject;
+
+		GLsizei particleCount;
+	};
+
+	// Counts an object as drawn or culled in each view of the pass
+	void count_views_(std::span<CullStats_> stats, ViewMask pass, ViewMask visible) {
+		for (std::size_t i = 0; i < stats.size(); ++i) {
+			ViewMask const bit = ViewMask(1) << i;
+			if (!(pass & bit))
+				continue;
+
+			if (visible & bit)
+				++stats[i].drawn;
 			else
-			{
-				p.position += p.direction * deltaTime;
-			}
+				++stats[i].culled;
 		}
 	}
 
-	//render particles
-	void render_particle_system_(const State_& state, const Mat44f& projView, const Vec3f& camRight, const Vec3f& camUp)
-	{
-		// Enable blending for transparency 
+	// Per-instance data of the active particles, sorted back to front in each
+	// of the views: view i's instances start at i * count. The billboards are
+	// expanded in the vertex shader. Particles simulated on the GPU stay there
+	// and are sorted there.
+	GLsizei upload_particles_(State_& state, std::span<ViewSetup const> views, StreamBuffer& stream) {
+		PROFILE_CPU("particle upload");
+
+		if (state.particleSys.useGpu) {
+			state.particleSys.gpu->sort(views);
+			return 0;
+		}
+
+		ParticlePool const& pool = state.particleSys.pool;
+		auto const active = pool.size();
+		if (0 == active)
+			return 0;
+
+		// Written straight into the mapped buffer
+		auto const alloc = stream.allocate(views.size() * active * sizeof(ParticleInstance_));
+		auto* instance = reinterpret_cast<ParticleInstance_*>(alloc.data);
+
+		auto const x = pool.x(), y = pool.y(), z = pool.z(), life = pool.life();
+		for (std::size_t v = 0; v < views.size(); ++v) {
+			auto const order = state.particleSys.sorters[v].sort(x, y, z, views[v].position, view_forward(views[v]));
+			for (auto const i : order)
+				*instance++ = ParticleInstance_{ { x[i], y[i], z[i] }, kParticleHalfSize_, life[i] / kParticleLifetime_ };
+		}
+
+		glBindVertexArray(state.particleQuad->vao());
+		stream.bind_vertex_buffer(kParticleInstanceBinding_, alloc, sizeof(ParticleInstance_));
+		glBindVertexArray(0);
+
+		return static_cast<GLsizei>(active);
+	}
+
+	//render particles into the views in pass
+	void render_particle_system_(
+		State_& state,
+		ShaderProgram const& program,
+		ShaderProgram const& gpuProgram,
+		std::span<ViewSetup const> views,
+		ViewMask pass,
+		GLsizei particleCount,
+		std::span<CullStats_> stats) {
+		bool const useGpu = state.particleSys.useGpu;
+
+		// The number of particles simulated on the GPU isn't known here; the
+		// indirect draw command holds it.
+		ViewMask const mask = visible_views(views, state.particleSys.bounds) & pass;
+		count_views_(stats, pass, mask);
+		if (!mask || (!useGpu && 0 == particleCount))
+			return;
+
+		PROFILE_CPU("particles");
+		PROFILE_GPU("particles");
+
+		// Enable blending for transparency
 		glEnable(GL_BLEND);
 		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 		// Use the particle shader program
-		glUseProgram(state.particleprog->programId());
+		glUseProgram(useGpu ? gpuProgram.programId() : program.programId());
 
 		glActiveTexture(GL_TEXTURE0);
 		glBindTexture(GL_TEXTURE_2D, state.particleSys.texture);
 
-		glUniformMatrix4fv(0, 1, GL_TRUE, projView.v);
+		// Each view has its own back-to-front order, so the views are drawn
+		// one at a time: one instance per particle, taken from the view's
+		// sorted list.
+		if (useGpu) {
+			glBindVertexArray(state.gpuParticleQuad->vao());
+			state.particleSys.gpu->bind_for_draw();
+		}
+		else {
+			glBindVertexArray(state.particleQuad->vao());
+			glVertexBindingDivisor(kParticleInstanceBinding_, 1);
+		}
+
+		for (std::size_t v = 0; v < views.size(); ++v) {
+			if (!(mask & (ViewMask(1) << v)))
+				continue;
 
-		// Prepare a vertex for all data 
-		std::vector<float> vertexData;
+			glUniform1ui(0, GLuint(v));
 
-		// Loop through each particle
-		for (const auto& particle : state.particleSys.particles_)
-		{
+			if (useGpu)
+				state.particleSys.gpu->draw(v);
+			else {
+				glDrawElementsInstancedBaseInstance(GL_TRIANGLES, state.particleQuad->count(), GL_UNSIGNED_INT, nullptr, particleCount, GLuint(v * std::size_t(particleCount)));
+				state.particleTriangles += std::uint64_t(state.particleQuad->count() / 3) * std::uint64_t(particleCount);
+			}
+		}
+
+		//Cleaning
+		glBindVertexArray(0);
+		glUseProgram(0);
 
-			// Skip if no active particles
-			if (!particle.active)
-				continue; 
+		glDisable(GL_BLEND);
+	}
 
-			// Define the size of each particle quad
-			float size = 0.5f;
+	// Programs that a scene is drawn with: the multiview variants (see
+	// multiview.hpp) or the single-view ones
+	struct ScenePrograms_
+	{
+		ShaderProgram const* terrain;
+		ShaderProgram const* objects;
+		ShaderProgram const* particles;
+		ShaderProgram const* gpuParticles;
+	};
 
-			// Calculate the four corners of the quad facing the camera
-			Vec3f right = camRight * size;
-			Vec3f up = camUp * size;
-			Vec3f center = particle.position;
+	// Render queue depth of a point: its distance to the nearest of the views
+	// in mask, relative to the far plane
+	float queue_depth_(std::span<ViewSetup const> views, ViewMask mask, Vec3f point) {
+		float nearest = kFarPlane_;
+		for (std::size_t i = 0; i < views.size(); ++i) {
+			if (mask & (ViewMask(1) << i))
+				nearest = std::min(nearest, length(point - views[i].position));
+		}
+		return nearest / kFarPlane_;
+	}
 
-			Vec3f topLeft = center - right + up;
-			Vec3f bottomLeft = center - right - up;
-			Vec3f bottomRight = center + right - up;
-			Vec3f topRight = center + right + up;
+	// Draws the scene into the views in pass; the caller sets up the
+	// viewport(s). Each object is drawn once, instanced for the views that it
+	// is visible in. Opaque objects go through the render queue; the
+	// particles are blended on top.
+	void draw_scene_views_(
+		State_& state,
+		SceneFrame_ const& scene,
+		std::span<ViewSetup const> views,
+		ViewMask pass,
+		ScenePrograms_ const& programs) {
+		PROFILE_CPU("scene");
+
+		std::span<CullStats_> const stats(state.cullStats, views.size());
+		RenderQueue& queue = *state.renderQueue;
+
+		// Terrain. A tile visible in several views is drawn at the finest
+		// level of detail that any of them needs.
+		{
+			PROFILE_CPU("terrain");
+			Mat44f const world2model = invert_rigid(scene.terrainModel);
+
+			std::array<Vec3f, kMaxViews> camModel;
+			std::array<float, kMaxViews> pixelsPerUnit;
+			for (std::size_t i = 0; i < views.size(); ++i) {
+				Vec4f const cam = world2model * Vec4f{ views[i].position.x, views[i].position.y, views[i].position.z, 1.f };
+				camModel[i] = Vec3f{ cam.x, cam.y, cam.z };
+				pixelsPerUnit[i] = pixels_per_unit(kFieldOfView_, views[i].viewport[3]);
+			}
 
-			// Define texture coordinates for each corner
-			float texLeft = 0.0f;
-			float texRight = 1.0f;
-			float texTop = 1.0f;
-			float texBottom = 0.0f;
+			std::vector<DrawElementsIndirectCommand> commands;
+			float terrainDepth = 1.f;
+			auto const add_tile = [&](AABB const& bounds, std::span<MeshLod const> lods) {
+				ViewMask const mask = visible_views(views, scene.terrainModel, bounds) & pass;
+				count_views_(stats, pass, mask);
+				if (!mask)
+					return;
+
+				std::size_t lod = lods.size() - 1;
+				for (std::size_t i = 0; i < views.size(); ++i) {
+					if (mask & (ViewMask(1) << i)) {
+						float const dist = distance(bounds, camModel[i]);
+						lod = std::min(lod, select_lod(lods, dist, pixelsPerUnit[i], kTerrainLodPixelError));
+						terrainDepth = std::min(terrainDepth, dist / kFarPlane_);
+					}
+				}
 
-			// First Triangle
-			vertexData.push_back(topLeft.x); vertexData.push_back(topLeft.y); vertexData.push_back(topLeft.z);
-			vertexData.push_back(texLeft);   vertexData.push_back(texTop);
+				commands.emplace_back(make_indirect_command(lods[lod].indexCount, lods[lod].firstIndex, mask));
+			};
 
-			vertexData.push_back(bottomLeft.x); vertexData.push_back(bottomLeft.y); vertexData.push_back(bottomLeft.z);
-			vertexData.push_back(texLeft);        vertexData.push_back(texBottom);
+			GpuMesh const& terrain = *scene.terrain;
+			if (terrain.tiles().empty())
+				add_tile(terrain.bounds(), terrain.lods());
+			for (auto const& tile : terrain.tiles())
+				add_tile(tile.bounds, std::span<MeshLod const>(tile.lods, tile.lodCount));
 
-			vertexData.push_back(bottomRight.x); vertexData.push_back(bottomRight.y); vertexData.push_back(bottomRight.z);
-			vertexData.push_back(texRight);       vertexData.push_back(texBottom);
+			GLuint const terrainProgram = programs.terrain->programId();
+			queue.submit(make_sort_key(terrainProgram, scene.terrainTexture, terrain.vao(), terrainDepth),
+				terrainProgram, scene.terrainTexture, terrain.vao(), *scene.stream, scene.terrainObject, commands);
+		}
 
-			// Second Triangl
-			vertexData.push_back(topLeft.x); vertexData.push_back(topLeft.y); vertexData.push_back(topLeft.z);
-			vertexData.push_back(texLeft);   vertexData.push_back(texTop);
+		// Landing pads and rocket
+		{
+			PROFILE_CPU("objects");
+			GLuint const objectProgram = programs.objects->programId();
+			auto const draw_mesh = [&](GpuMesh const& mesh, Mat44f const& model2world, StreamBuffer::Allocation const& object) {
+				ViewMask const mask = visible_views(views, model2world, mesh.bounds()) & pass;
+				count_views_(stats, pass, mask);
+				if (!mask)
+					return;
+
+				Vec3f const c = center(mesh.bounds());
+				Vec4f const world = model2world * Vec4f{ c.x, c.y, c.z, 1.f };
+				float const depth = queue_depth_(views, mask, Vec3f{ world.x, world.y, world.z });
+
+				DrawElementsIndirectCommand const command = make_indirect_command(GLuint(mesh.count()), 0, mask);
+				queue.submit(make_sort_key(objectProgram, 0, mesh.vao(), depth),
+					objectProgram, 0, mesh.vao(), *scene.stream, object, std::span(&command, 1));
+			};
 
-			vertexData.push_back(bottomRight.x); vertexData.push_back(bottomRight.y); vertexData.push_back(bottomRight.z);
-			vertexData.push_back(texRight);       vertexData.push_back(texBottom);
+			draw_mesh(*scene.landingpad, scene.landingpadModel[0], scene.landingpadObject[0]);
+			draw_mesh(*scene.landingpad, scene.landingpadModel[1], scene.landingpadObject[1]);
+			draw_mesh(*scene.rocket, scene.rocketModel, scene.rocketObject);
+		}
 
-			vertexData.push_back(topRight.x); vertexData.push_back(topRight.y); vertexData.push_back(topRight.z);
-			vertexData.push_back(texRight);    vertexData.push_back(texTop);
+		{
+			PROFILE_CPU("opaque");
+			PROFILE_GPU("opaque");
+			queue.execute(*scene.stream, state.queueStats);
 		}
 
-		// Bind the Particle VAO
-		// Bind the Particle VBO
-		// Vertex data
-		// Draw all particles as triangles
+		render_particle_system_(state, *programs.particles, *programs.gpuParticles, views, pass, scene.particleCount, stats);
+	}
 
-		glBindVertexArray(state.particleVao);
+	// Split-screen rendering. With EMultiviewMode::eSinglePass, the scene is
+	// submitted once for all views; otherwise once per view.
+	void render_split_views_(
+		State_& state,
+		SceneFrame_ const& scene,
+		std::span<ViewSetup const> views) {
+		ScenePrograms_ const programs{ state.multiviewprog, state.multiviewLandingpadprog, state.multiviewParticleprog, state.multiviewGpuParticleprog };
 
-		glBindBuffer(GL_ARRAY_BUFFER, state.particleVbo);
-		glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(float), vertexData.data(), GL_STREAM_DRAW);
+		if (EMultiviewMode::eSinglePass == state.multiviewMode) {
+			std::array<GLfloat, 4 * kMaxViews> viewports{};
+			for (std::size_t i = 0; i < views.size(); ++i)
+				std::copy(views[i].viewport.begin(), views[i].viewport.end(), viewports.begin() + 4 * i);
 
-		glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertexData.size() / 5));
-		
+			glViewportArrayv(0, GLsizei(views.size()), viewports.data());
+
+			ViewMask const all = (ViewMask(1) << views.size()) - 1;
+			draw_scene_views_(state, scene, views, all, programs);
+		}
+		else {
+			for (std::size_t i = 0; i < views.size(); ++i) {
+				auto const& vp = views[i].viewport;
+				glViewport(GLint(vp[0]), GLint(vp[1]), GLsizei(vp[2]), GLsizei(vp[3]));
+				draw_scene_views_(state, scene, views, ViewMask(1) << i, programs);
+			}
+		}
 
-		//Cleaning
-		glBindVertexArray(0);
 		glUseProgram(0);
+	}
 
-		glDisable(GL_BLEND);
+	// Shows the culling and render queue statistics of the last frame in the
+	// window title. State changes are shown as sorted/unsorted (see
+	// RenderQueueStats).
+	void report_cull_stats_(GLFWwindow* window, State_& state, double now) {
+		if (now - state.lastCullReport < kCullReportInterval_)
+			return;
+		state.lastCullReport = now;
+
+		char title[256];
+		auto const& queue = state.queueStats;
+		int len = std::snprintf(title, sizeof(title), "%s | particles: %s | draws: %u | state changes: %u/%u", kWindowTitle,
+			state.particleSys.useGpu ? "GPU" : "CPU", queue.drawCalls, queue.stateChanges, queue.unsortedStateChanges);
+
+		int const views = state.splitScreen ? int(state.splitViews) : 1;
+		for (int i = 0; i < views && len < int(sizeof(title)); ++i) {
+			len += std::snprintf(title + len, sizeof(title) - len, " | view %d: %u drawn, %u culled",
+				i + 1, state.cullStats[i].drawn, state.cullStats[i].culled);
+		}
+
+		glfwSetWindowTitle(window, title);
+	}
+
+	// Prints the profiler's rolling statistics every kProfileReportInterval_
+	// seconds while it is enabled
+	void report_profile_(State_& state, double now) {
+		if (!state.profiler || !state.printProfile)
+			return;
+		if (now - state.lastProfileReport < kProfileReportInterval_)
+			return;
+		state.lastProfileReport = now;
+
+		state.profiler->print_report(stdout);
+	}
+
+	// Starts and stops trace captures as requested with T, stopping them
+	// after kTraceDuration_ seconds. A stopped capture is written once the
+	// GPU results of its last frame are in.
+	void update_trace_(State_& state, Profiler& profiler, double now) {
+		if (state.traceRequested && !profiler.tracing()) {
+			profiler.start_trace();
+			state.traceStart = now;
+			state.traceWritePending = false;
+		}
+		else if (profiler.tracing() && (!state.traceRequested || now - state.traceStart >= kTraceDuration_)) {
+			profiler.stop_trace();
+			state.traceRequested = false;
+			state.traceWritePending = true;
+		}
+
+		if (state.traceWritePending && profiler.trace_complete()) {
+			profiler.write_trace(kTraceFile_);
+			state.traceWritePending = false;
+			std::printf("Trace written to '%s'\n", kTraceFile_);
+		}
 	}
 
+	// Benchmark run (see benchmark.hpp)
+	struct BenchRun_
+	{
+		BenchScript script;
+		std::string output;
 
-    //https://www.lighthouse3d.com/tutorials/opengl-timer-query/
-    //https://chatgpt.com for idea generation
-    void getTimes(GLuint* queryQueue, const char* benchmark) {
-        GLuint64 startTime = 0, endTime = 0;
-        glGetQueryObjectui64v(queryQueue[0], GL_QUERY_RESULT, &startTime);
-        glGetQueryObjectui64v(queryQueue[1], GL_QUERY_RESULT, &endTime);
+		std::size_t frame = 0; // counts from the first warm-up frame
+		Clock::time_point last;
+		BenchResults results;
 
-        // Calculate elapsed time
-        GLuint64 resultTime = endTime - startTime;
-        std::cout << benchmark << resultTime / 1e6 << " ms" << std::endl;
-    }
+		std::string trace; // trace of the recorded frames, if not empty
+	};
 
-    void startTimer(GLuint* queryQueue) {
+	// Moves the camera and rocket along the script, and records the frame
+	// times. Called before the profiler's begin_frame(), so that recording
+	// starts with the first frame after the warm-up. Returns false once the
+	// GPU results of the last recorded frame have been collected.
+	bool step_bench_(BenchRun_& bench, State_& state, Profiler& profiler) {
+		auto const& script = bench.script;
+		auto const recordEnd = script.warmup + script.frames;
+
+		auto const now = Clock::now();
+		if (bench.frame > script.warmup && bench.frame <= recordEnd) {
+			bench.results.frameMs.emplace_back(std::chrono::duration<float, std::milli>(now - bench.last).count());
+			bench.results.gl.emplace_back(state.glStats);
+		}
+		bench.last = now;
 
-    	// Start recording results into queue A
-    	glQueryCounter(queryQueue[0], GL_TIMESTAMP);
-    }
+		if (bench.frame == script.warmup) {
+			profiler.set_recording(true);
+			if (!bench.trace.empty())
+				profiler.start_trace();
+		}
+		else if (bench.frame == recordEnd) {
+			profiler.set_recording(false);
+			profiler.stop_trace();
+		}
+		else if (bench.frame == recordEnd + kProfilerFrames)
+			return false;
 
-    void endTimer(GLuint* queryQueue) {
+		float const time = float(bench.frame) * script.timestep;
+		auto const key = sample_bench_camera(script, time);
 
-		// Start recording results into queue B
-        glQueryCounter(queryQueue[1], GL_TIMESTAMP);
-    }
+		auto const follow = [&](State_::CamCtrl_& cam) {
+			cam.position = key.position;
+			cam.phi = key.phi;
+			cam.theta = key.theta;
+			cam.changeCamera = 0;
+		};
+		follow(state.camControl);
+		for (auto& cam : state.splitCams)
+			follow(cam);
+
+		if (script.launchTime >= 0.f && time >= script.launchTime)
+			state.rockControl.play = true;
+
+		++bench.frame;
+		return true;
+	}
 
+	void finish_bench_(BenchRun_& bench, Profiler const& profiler) {
+		bench.results.renderer = reinterpret_cast<char const*>(glGetString(GL_RENDERER));
+		bench.results.version = reinterpret_cast<char const*>(glGetString(GL_VERSION));
+		bench.results.zones = profiler.recorded_stats();
+
+		write_bench_report(bench.output.c_str(), bench.script, bench.results);
+		if (!bench.trace.empty())
+			profiler.write_trace(bench.trace.c_str());
+
+		auto const frame = summarize_samples(bench.results.frameMs);
+		std::printf("Benchmark '%s': %zu frames, frame time p50 %.3f ms, p95 %.3f ms, p99 %.3f ms -> %s\n",
+			bench.script.path.c_str(), frame.samples, frame.p50Ms, frame.p95Ms, frame.p99Ms, bench.output.c_str());
+	}
 }
 
-int main() try
+int main(int argc, char* argv[]) try
 {
+	// main --bench <script> [--out <report>] [--trace <trace>]
+	std::optional<BenchRun_> bench;
+	if (argc > 1) {
+		bool valid = argc >= 3 && 0 == std::strcmp(argv[1], "--bench") && 1 == argc % 2;
+		for (int i = 3; valid && i < argc; i += 2)
+			valid = 0 == std::strcmp(argv[i], "--out") || 0 == std::strcmp(argv[i], "--trace");
+		if (!valid)
+			throw Error("Usage: %s [--bench <script> [--out <report.json|report.csv>] [--trace <trace.json>]]", argv[0]);
+
+		bench.emplace();
+		bench->script = load_bench_script(argv[2]);
+		bench->output = "bench.json";
+		for (int i = 3; i < argc; i += 2)
+			(0 == std::strcmp(argv[i], "--out") ? bench->output : bench->trace) = argv[i + 1];
+	}
+
 	// Initialize GLFW
 	if (GLFW_TRUE != glfwInit())
 	{
@@ -483,7 +937,7 @@ int main() try
 	//glfwWindowHint( GLFW_RESIZABLE, GLFW_FALSE );
 
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4); // glBufferStorage(), see stream_buffer.hpp
 	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
@@ -500,9 +954,16 @@ int main() try
 	glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_FALSE);
 	#endif
 
+	// Benchmarks render offscreen, into a hidden window
+	if (bench) {
+		glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_FALSE);
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+	}
+
 	GLFWwindow* window = glfwCreateWindow(
-		1280,
-		720,
+		bench ? bench->script.width : 1280,
+		bench ? bench->script.height : 720,
 		kWindowTitle,
 		nullptr, nullptr
 	);
@@ -535,12 +996,17 @@ int main() try
     #ifdef PREPARE_BENCHMARK
     glfwSwapInterval(0);
     #endif
+	if (bench)
+		glfwSwapInterval(0);
 
 	// Initialize GLAD
 	// This will load the OpenGL API. We mustn't make any OpenGL calls before this!
 	if (!gladLoadGLLoader((GLADloadproc)&glfwGetProcAddress))
 		throw Error("gladLoaDGLLoader() failed - cannot load GL API!");
 
+	// Counts draw calls, state changes and uploads (see gl_stats.hpp)
+	install_gl_stats();
+
 	std::printf("RENDERER %s\n", glGetString(GL_RENDERER));
 	std::printf("VENDOR %s\n", glGetString(GL_VENDOR));
 	std::printf("VERSION %s\n", glGetString(GL_VERSION));
@@ -564,10 +1030,6 @@ int main() try
     #ifdef PREPARE_BENCHMARK
     glDisable(GL_DEBUG_OUTPUT);
     glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
-
-   	// Set up queries
-    glGenQueries(2, queryQueueA);
-    glGenQueries(2, queryQueueB);
     #endif
 
 	OGL_CHECKPOINT_ALWAYS();
@@ -597,35 +1059,95 @@ int main() try
 	{ GL_FRAGMENT_SHADER, "assets/cw2/particle.frag" } 
 		});
 
+	// Split-screen variants (see multiview.hpp)
+	state.multiviewMode = detect_multiview_mode();
+	std::printf("Split-screen: %s\n", EMultiviewMode::eSinglePass == state.multiviewMode
+		? "single pass (gl_ViewportIndex)" : "one pass per view");
+
+	auto const multiviewDefines = multiview_shader_defines(state.multiviewMode);
+	ShaderProgram multiviewProg({
+		{ GL_VERTEX_SHADER, "assets/cw2/default.vert", multiviewDefines },
+		{ GL_FRAGMENT_SHADER, "assets/cw2/default.frag", multiviewDefines }
+		});
+	ShaderProgram multiviewLandingpadProg({
+		{ GL_VERTEX_SHADER, "assets/cw2/landingpad_shader.vert", multiviewDefines },
+		{ GL_FRAGMENT_SHADER, "assets/cw2/landingpad_shader.frag", multiviewDefines }
+		});
+	ShaderProgram multiviewParticleProg({
+		{ GL_VERTEX_SHADER, "assets/cw2/particle.vert", multiviewDefines },
+		{ GL_FRAGMENT_SHADER, "assets/cw2/particle.frag" }
+		});
+
 	state.prog = &prog;
 	state.landingpadprog = &landingpadProg;
 	state.particleprog = &particleProg;
+	state.multiviewprog = &multiviewProg;
+	state.multiviewLandingpadprog = &multiviewLandingpadProg;
+	state.multiviewParticleprog = &multiviewParticleProg;
+
+	// Particles simulated on the GPU
+	auto gpuParticleDefines = multiviewDefines;
+	gpuParticleDefines.emplace_back("GPU_PARTICLES");
+
+	ShaderProgram gpuParticleProg({
+		{ GL_VERTEX_SHADER, "assets/cw2/particle.vert", { "GPU_PARTICLES" } },
+		{ GL_FRAGMENT_SHADER, "assets/cw2/particle.frag" }
+		});
+	ShaderProgram multiviewGpuParticleProg({
+		{ GL_VERTEX_SHADER, "assets/cw2/particle.vert", gpuParticleDefines },
+		{ GL_FRAGMENT_SHADER, "assets/cw2/particle.frag" }
+		});
+
+	state.gpuParticleprog = &gpuParticleProg;
+	state.multiviewGpuParticleprog = &multiviewGpuParticleProg;
+
+	// The third and fourth views start out following the rocket and on the
+	// ground, respectively
+	state.splitCams[2].changeCamera = 1;
+	state.splitCams[3].changeCamera = 2;
 
 	OGL_CHECKPOINT_ALWAYS();
-	//For dinamic VAO
-	glGenVertexArrays(1, &state.particleVao);
-	glBindVertexArray(state.particleVao);
+	// Particles are instances of a static quad; the per-instance data is
+	// streamed every frame (see upload_particles_())
+	GpuMesh particleQuadMesh = create_gpu_mesh(make_particle_quad());
+	state.particleQuad = &particleQuadMesh;
 
-	glGenBuffers(1, &state.particleVbo);
-	glBindBuffer(GL_ARRAY_BUFFER, state.particleVbo);
-	glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_STREAM_DRAW);
+	glBindVertexArray(particleQuadMesh.vao());
 
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(5);
+	glVertexAttribFormat(5, 4, GL_FLOAT, GL_FALSE, offsetof(ParticleInstance_, center));
+	glVertexAttribBinding(5, kParticleInstanceBinding_);
 
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(6);
+	glVertexAttribFormat(6, 1, GL_FLOAT, GL_FALSE, offsetof(ParticleInstance_, life));
+	glVertexAttribBinding(6, kParticleInstanceBinding_);
 
 	glBindVertexArray(0);
 
+	// GPU simulation (toggled with G). Its particles are read straight from
+	// the storage buffers, so its quad has no per-instance attributes.
+	GpuMesh gpuParticleQuadMesh = create_gpu_mesh(make_particle_quad());
+	state.gpuParticleQuad = &gpuParticleQuadMesh;
+
+	GpuParticles gpuParticles = create_gpu_particles(State_::ParticleSys_::kMaxParticles_, gpuParticleQuadMesh.count(),
+		kParticleEmitter_);
+	state.particleSys.gpu = &gpuParticles;
+
+	JobSystem jobs;
+	state.jobs = &jobs;
+	std::printf("Particle update: %zu threads\n", jobs.thread_count());
+
 	 //VAO
-	SimpleMeshData langerso = load_wavefront_obj("assets/cw2/langerso.obj");
-	GLuint vaolangerso = create_vao(langerso);
-	std::size_t vertexCountlangerso = langerso.positions.size();
+	GpuMesh langersoMesh, landingpadMesh;
+	{
+		// The cached meshes may refer to memory-mapped files, which are
+		// released at the end of this scope, after the data is uploaded.
+		auto const langerso = load_obj_verbose("assets/cw2/langerso.obj", MeshProcessing{ kTerrainTiles, kTerrainTiles, kTerrainLodLevels });
+		langersoMesh = create_gpu_mesh(langerso.view());
 
-	SimpleMeshData landingpad = load_wavefront_obj("assets/cw2/landingpad.obj");
-	GLuint vaolandingpad = create_vao(landingpad);
-	std::size_t vertexCountlandingpad = landingpad.positions.size();
+		auto const landingpad = load_obj_verbose("assets/cw2/landingpad.obj");
+		landingpadMesh = create_gpu_mesh(landingpad.view());
+	}
 
 	GLuint orthophoto = load_texture_2d("assets/cw2/L3211E-4k.jpg");
 	state.particleSys.texture = load_texture_2d("assets/cw2/particle.png");
@@ -674,32 +1196,62 @@ int main() try
 					concatenate(sideWing2,
 						concatenate(sideWing1,
 							concatenate(rocketCylinder, rocketCone)))))));
-	GLuint vao_rocket = create_vao(rocket);
-	std::size_t vertex_rocket = rocket.positions.size();
-
-    #ifdef CPU_BENCHMARK
-	using clock = std::chrono::high_resolution_clock;
-    auto frameStart = clock::now();
-  	#endif
+	print_optimize_report("rocket", optimize_mesh(rocket));
+	GpuMesh rocketMesh = create_gpu_mesh(rocket);
+
+	MultiviewBuffers multiviewBuffers = create_multiview_buffers();
+	for (GLuint vao : { langersoMesh.vao(), landingpadMesh.vao(), rocketMesh.vao() })
+		multiviewBuffers.attach(vao);
+
+	RenderQueue renderQueue;
+	state.renderQueue = &renderQueue;
+
+	// Uniform blocks (see frame_uniforms.hpp), indirect commands, particle
+	// instances and the HUD are written straight into a persistently mapped
+	// buffer
+	GLint uniformOffsetAlignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformOffsetAlignment);
+	std::size_t const uniformAlignment = std::size_t(std::max(uniformOffsetAlignment, 16));
+
+	std::size_t const particleStreamBytes = kMaxViews * State_::ParticleSys_::kMaxParticles_ * sizeof(ParticleInstance_);
+	StreamBuffer frameStream = create_stream_buffer(kUniformStreamBytes_ + kQueueStreamBytes_ + particleStreamBytes + kHudStreamBytes);
+
+	// CPU and GPU timings (see profiler.hpp)
+	Profiler profiler;
+	profiler.make_current();
+	state.profiler = &profiler;
+
+	// Performance overlay (toggled with H)
+	Hud hud = create_hud("assets/cw2/DroidSansMonoDotted.ttf");
+	state.hud = &hud;
+
+	if (bench) {
+		state.splitScreen = bench->script.views > 1;
+		state.splitViews = bench->script.views;
+		state.particleSys.useGpu = bench->script.gpuParticles;
+	}
 
 	// Main loop
 	while (!glfwWindowShouldClose(window))
 	{
-		// Let GLFW process events
-		glfwPollEvents();
+		if (bench && !step_bench_(*bench, state, profiler)) {
+			finish_bench_(*bench, profiler);
+			break;
+		}
 
-        #ifdef CPU_BENCHMARK
-        auto frameEnd = clock::now();
-        std::chrono::duration<float, std::milli> elapsedTime = frameEnd - frameStart;
-        float timeDifference = elapsedTime.count();
-        frameStart = frameEnd;
-        std::cout << "Frame-to-frame time: " << timeDifference << " ms" << std::endl;
+		profiler.set_enabled(bench || state.printProfile || state.showHud);
+		profiler.begin_frame();
 
-        auto renderStart = clock::now();
-	    #endif
+		// Let GLFW process events
+		{
+			PROFILE_CPU("events");
+			glfwPollEvents();
+		}
 
+		// Benchmarks advance by a fixed step, so that every run renders the
+		// same frames
 		double currentTime = glfwGetTime();
-		float deltaTime = static_cast<float>(currentTime - lastTime);
+		float deltaTime = bench ? bench->script.timestep : static_cast<float>(currentTime - lastTime);
 
 		// Check if window was resized.
 		float fbwidth, fbheight;
@@ -725,15 +1277,22 @@ int main() try
 
 		if (auto* statePtr = static_cast<State_*>(glfwGetWindowUserPointer(window)))
 		{
+			PROFILE_CPU("frame");
+			PROFILE_GPU("frame");
+
 			// Update cameras
 			if (statePtr->splitScreen)
 			{
-				// Update both split-screen cameras
-				update_camera(*statePtr, statePtr->camControl1, window, deltaTime);
-				update_camera(*statePtr, statePtr->camControl2, window, deltaTime);
+				PROFILE_CPU("camera");
+
+				// Update the split-screen cameras
+				for (std::size_t i = 0; i < statePtr->splitViews; ++i)
+					update_camera(*statePtr, statePtr->splitCams[i], window, deltaTime);
 			}
 			else
 			{
+				PROFILE_CPU("camera");
+
 				// Update primary camera
 				update_camera(*statePtr, statePtr->camControl, window, deltaTime);
 			}
@@ -808,9 +1367,12 @@ int main() try
 				statePtr->camControl.moveDown = glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS;
 			}
 
+			// Ends once the views are set up
+			std::optional<ProfileScope> matricesZone;
+			matricesZone.emplace("matrices", EProfileClock::cpu);
+
 			float angle = 0.0f;
 			Mat44f model2world = make_rotation_y(angle);
-			Mat33f normalMatrix = mat44_to_mat33(transpose(invert(model2world)));
 
 			Mat44f Rx = make_rotation_x(state.camControl.theta);
 			Mat44f Ry = make_rotation_y(state.camControl.phi);
@@ -822,332 +1384,183 @@ int main() try
 			Mat44f world2camera = Rx * Ry * T;
 
 			Mat44f projection = make_perspective_projection(
-				60.f * std::numbers::pi_v<float> / 180.f,
+				kFieldOfView_,
 				fbwidth / fbheight,
-				0.1f, 100.0f
+				0.1f, kFarPlane_
 			);
 
 			//landing pad 1 location
 			Mat44f model2worldpad1 = make_translation({ 6.f, 0.f, -6.f });
-			Mat33f model2worldpad1matrix = mat44_to_mat33(transpose(invert(model2worldpad1)));
 
 			//landing pad 2 location
 			Mat44f model2worldpad2 = make_translation({ -10.f, 0.f, -3.f });
-			Mat33f model2worldpad2matrix = mat44_to_mat33(transpose(invert(model2worldpad2)));
 
 			// new rocket position
 			Mat44f model2world_rocket = make_translation(state.rockControl.position) * make_rotation_x(state.rockControl.rotation);
-			Mat33f rocketmatrix = mat44_to_mat33(transpose(invert(model2world_rocket)));
-			Vec3f rocket1WorldPos = transform_position(model2world_rocket, statePtr->rockControl.rocketPos[0]);
-			Vec3f rocket2WorldPos = transform_position(model2world_rocket, statePtr->rockControl.rocketPos[1]);
-			Vec3f rocket3WorldPos = transform_position(model2world_rocket, statePtr->rockControl.rocketPos[2]);
-			Vec3f pointLightPos[3] = { rocket1WorldPos, rocket2WorldPos, rocket3WorldPos };
+			// Point lights follow the rocket
+			Vec3f pointLightPos[3] = {
+				statePtr->rockControl.rocketPos[0],
+				statePtr->rockControl.rocketPos[1],
+				statePtr->rockControl.rocketPos[2]
+			};
+			transform_positions(pointLightPos, model2world_rocket);
 			Vec3f pointLightsColor[3] = { {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f} };
 			Mat44f projView = projection * world2camera;
 
             // Invert world2camera to get camera2world
-            Mat44f camera2world = invert(world2camera);
+            Mat44f camera2world = invert_rigid(world2camera);
 
             // Extract camera right and up vectors from camera2world matrix
             Vec3f camRight{ camera2world(0, 0), camera2world(1, 0), camera2world(2, 0) };
             Vec3f camUp{ camera2world(0, 1), camera2world(1, 1), camera2world(2, 1) };
 
-			#ifdef ENABLE_BENCHMARK_FULL
-            float distancex = std::abs(statePtr->camControl.position.x - statePtr->rockControl.position.x);
-            float distancey = std::abs(statePtr->camControl.position.y - statePtr->rockControl.position.y);
-            float distancez = std::abs(statePtr->camControl.position.z - statePtr->rockControl.position.z);
-            float totalDistance = std::sqrt(std::pow(distancex,2) + std::pow(distancey,2) + std::pow(distancez,2));
-            std::cout << totalDistance << " " << frameCount++ << std::endl;
-            std::cout << statePtr->camControl.position.x << " " << statePtr->camControl.position.y << " " << statePtr->camControl.position.z << std::endl;
-			#endif
 
 			// Clear the screen
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-			if (statePtr->splitScreen)
-			{
-				// Define viewports for split-screen (horizontal split: top and bottom)
-				int windowWidth, windowHeight;
-				glfwGetFramebufferSize(window, &windowWidth, &windowHeight);
-
-				int viewWidth = windowWidth / 2;
-				int viewHeight = windowHeight;
+			for (auto& stats : statePtr->cullStats)
+				stats = CullStats_{};
+			statePtr->queueStats = RenderQueueStats{};
+			statePtr->particleTriangles = 0;
 
-				//Left View
-				glViewport(0, 0, viewWidth, viewHeight);
+			std::array<ViewSetup, kMaxViews> views;
+			std::size_t const viewCount = statePtr->splitScreen ? statePtr->splitViews : 1;
 
+			if (statePtr->splitScreen)
+			{
+				for (std::size_t i = 0; i < viewCount; ++i)
+				{
+					auto const& cam = statePtr->splitCams[i];
+					auto& view = views[i];
 
-				// Compute camera matrices for Left
-				Mat44f projection1 = make_perspective_projection(
-					60.f * std::numbers::pi_v<float> / 180.f,
-					static_cast<float>(viewWidth) / static_cast<float>(viewHeight),
-					0.1f, 100.0f
-				);
-
-				Mat44f Rx1 = make_rotation_x(statePtr->camControl1.theta);
-				Mat44f Ry1 = make_rotation_y(statePtr->camControl1.phi);
-				Mat44f T1 = make_translation({ -statePtr->camControl1.position.x, -statePtr->camControl1.position.y, -statePtr->camControl1.position.z });
-
-				Mat44f world2camera1 = Rx1 * Ry1 * T1;
-				Mat44f projView1 = projection1 * world2camera1;
-				Mat44f camera2world1 = invert(world2camera1);
-				Vec3f camRight1{ camera2world1(0, 0), camera2world1(1, 0), camera2world1(2, 0) };
-				Vec3f camUp1{ camera2world1(0, 1), camera2world1(1, 1), camera2world1(2, 1) };
-
-				// Left View
-				glUseProgram(statePtr->prog->programId());
-
-                rendertexture(orthophoto);
-				rendervaotext(projection1 * world2camera1 * model2world, normalMatrix, orthophoto, vaolangerso, vertexCountlangerso);
-
-				renderlight(*statePtr, pointLightPos, pointLightsColor);
-
-				// Landing pads for View 1
-				glUseProgram(statePtr->landingpadprog->programId());
-				rendervao(projection1 * world2camera1 * model2worldpad1, model2worldpad1, model2worldpad1matrix, vaolandingpad, vertexCountlandingpad);
-				rendervao(projection1 * world2camera1 * model2worldpad2, model2worldpad2, model2worldpad2matrix, vaolandingpad, vertexCountlandingpad);
-
-				// Rocket for View 1
-				rendervao(projection1 * world2camera1 * model2world_rocket, model2world_rocket, rocketmatrix, vao_rocket, vertex_rocket);
-				
-				// Lights
-				renderlight(*statePtr, pointLightPos, pointLightsColor);
-
-				// Particles
-				render_particle_system_(*statePtr, projView1, camRight1, camUp1);
-
-				// Right view
-				glViewport(viewWidth, 0, viewWidth, viewHeight);
-
-				// Coamera matrices for Right
-				Mat44f projection2 = make_perspective_projection(
-					60.f * std::numbers::pi_v<float> / 180.f,
-					static_cast<float>(viewWidth) / static_cast<float>(windowHeight),
-					0.1f, 100.0f
-				);
-
-				Mat44f Rx2 = make_rotation_x(statePtr->camControl2.theta);
-				Mat44f Ry2 = make_rotation_y(statePtr->camControl2.phi);
-				Mat44f T2 = make_translation({ -statePtr->camControl2.position.x, -statePtr->camControl2.position.y, -statePtr->camControl2.position.z });
+					view.viewport = split_viewport(i, viewCount, fbwidth, fbheight);
 
-				Mat44f world2camera2 = Rx2 * Ry2 * T2;
-				Mat44f projView2 = projection2 * world2camera2;
-				Mat44f camera2world2 = invert(world2camera2);
-				Vec3f camRight2{ camera2world2(0, 0), camera2world2(1, 0), camera2world2(2, 0) };
-				Vec3f camUp2{ camera2world2(0, 1), camera2world2(1, 1), camera2world2(2, 1) };
+					Mat44f const viewProjection = make_perspective_projection(
+						kFieldOfView_,
+						view.viewport[2] / view.viewport[3],
+						0.1f, kFarPlane_
+					);
 
-				// Right view
-				glUseProgram(statePtr->prog->programId());
+					Mat44f const viewWorld2camera = make_rotation_x(cam.theta) * make_rotation_y(cam.phi)
+						* make_translation({ -cam.position.x, -cam.position.y, -cam.position.z });
+					Mat44f const viewCamera2world = invert_rigid(viewWorld2camera);
 
-                rendertexture(orthophoto);
-				rendervaotext(projection2 * world2camera2 * model2world, normalMatrix, orthophoto, vaolangerso, vertexCountlangerso);
+					view.projView = viewProjection * viewWorld2camera;
+					view.position = cam.position;
+					view.right = Vec3f{ viewCamera2world(0, 0), viewCamera2world(1, 0), viewCamera2world(2, 0) };
+					view.up = Vec3f{ viewCamera2world(0, 1), viewCamera2world(1, 1), viewCamera2world(2, 1) };
+				}
+			}
+			else
+			{
+				views[0] = ViewSetup{ projView, statePtr->camControl.position, camRight, camUp, { 0.f, 0.f, fbwidth, fbheight } };
+			}
 
-				renderlight(*statePtr, pointLightPos, pointLightsColor);
+			std::span<ViewSetup const> const activeViews(views.data(), viewCount);
+			matricesZone.reset();
 
-				// Landing pads for View 2
-				glUseProgram(statePtr->landingpadprog->programId());
-				rendervao(projection2 * world2camera2 * model2worldpad1, model2worldpad1, model2worldpad1matrix, vaolandingpad, vertexCountlandingpad);
-				rendervao(projection2 * world2camera2 * model2worldpad2, model2worldpad2, model2worldpad2matrix, vaolandingpad, vertexCountlandingpad);
+			// Uniforms and streamed vertices for the whole frame. The stream
+			// buffer waits until the GPU is done with the region that it hands
+			// out here.
+			frameStream.begin_frame();
 
-				// Rocket for View 2
-				rendervao(projection2 * world2camera2 * model2world_rocket, model2world_rocket, rocketmatrix, vao_rocket, vertex_rocket);
-				
-				// Lights
-				renderlight(*statePtr, pointLightPos, pointLightsColor);
+			auto const frameUniforms = upload_uniforms_(frameStream, make_frame_uniforms_(activeViews, pointLightPos, pointLightsColor), uniformAlignment);
+			frameStream.bind_range(GL_UNIFORM_BUFFER, kFrameUniformsBinding, frameUniforms);
 
-				// Particles
-				render_particle_system_(*statePtr, projView2, camRight2, camUp2);
+			SceneFrame_ const scene{
+				&langersoMesh, model2world, orthophoto,
+				&landingpadMesh, { model2worldpad1, model2worldpad2 },
+				&rocketMesh, model2world_rocket,
+				&frameStream,
+				upload_uniforms_(frameStream, make_object_uniforms(model2world), uniformAlignment),
+				{
+					upload_uniforms_(frameStream, make_object_uniforms(model2worldpad1), uniformAlignment),
+					upload_uniforms_(frameStream, make_object_uniforms(model2worldpad2), uniformAlignment)
+				},
+				upload_uniforms_(frameStream, make_object_uniforms(model2world_rocket), uniformAlignment),
+				upload_particles_(*statePtr, activeViews, frameStream)
+			};
 
-				glBindVertexArray(0);
-				glUseProgram(0);
+			if (statePtr->splitScreen)
+			{
+				render_split_views_(*statePtr, scene, activeViews);
 			}
 			else
 			{
 				// Single view rendering
 				glViewport(0, 0, fbwidth, fbheight);
 
-				// Compute camera matrices for the primary view
-				Mat44f projection = make_perspective_projection(
-					60.f * std::numbers::pi_v<float> / 180.f,
-					fbwidth / fbheight,
-					0.1f, 100.0f
-				);
-
-				Mat44f Rx = make_rotation_x(statePtr->camControl.theta);
-				Mat44f Ry = make_rotation_y(statePtr->camControl.phi);
-				Mat44f T = make_translation({ -statePtr->camControl.position.x, -statePtr->camControl.position.y, -statePtr->camControl.position.z });
-
-				Mat44f world2camera = Rx * Ry * T;
-
-                // Start benchmarking for full rendering
-                #ifdef ENABLE_BENCHMARK_FULL
-                if (swapQueue) {
-
-                    getTimes(queryQueueB, "Full: ");
-                    startTimer(queryQueueA);
-                }
-
-                else {
-
-                    getTimes(queryQueueA, "Full: ");
-                    startTimer(queryQueueB);
-                }
-                #endif
 
-				// Render the primary view
-				glUseProgram(statePtr->prog->programId());
+				ScenePrograms_ const programs{ statePtr->prog, statePtr->landingpadprog, statePtr->particleprog, statePtr->gpuParticleprog };
+				draw_scene_views_(*statePtr, scene, activeViews, 1, programs);
 
-                // Render texture
-                rendertexture(orthophoto);
-
-				// Start benchmarking for task 1.2
-                #ifdef ENABLE_BENCHMARK_12
-                if (swapQueue) {
-
-                    getTimes(queryQueueB, "1.2: ");
-                    startTimer(queryQueueA);
-                }
-
-                else {
-
-                    getTimes(queryQueueA, "1.2: ");
-                    startTimer(queryQueueB);
-                }
-                #endif
-
-                // Render mesh
-				rendervaotext(projection * world2camera * model2world, normalMatrix, orthophoto, vaolangerso, vertexCountlangerso);
-
-                // Finish benchmarking for task 1.2
-                #ifdef ENABLE_BENCHMARK_12
-                if (swapQueue) {
-                	endTimer(queryQueueA);
-                }
-                else {
-                	endTimer(queryQueueB);
-                }
-                swapQueue = !swapQueue;
-                #endif
-
-                // Render lights
-				renderlight(*statePtr, pointLightPos, pointLightsColor);
-
-				glUseProgram(statePtr->landingpadprog->programId());
+				glBindVertexArray(0);
+				glUseProgram(0);
 
-                // Start benchmarking for task 1.4
-                #ifdef ENABLE_BENCHMARK_14
-                if (swapQueue) {
-                    getTimes(queryQueueB, "1.4: ");
-                    startTimer(queryQueueA);
-                }
-                else {
-                    getTimes(queryQueueA, "1.4: ");
-                    startTimer(queryQueueB);
-                }
-                #endif
 
-				// Render landing pads
-				rendervao(projection * world2camera * model2worldpad1, model2worldpad1, model2worldpad1matrix, vaolandingpad, vertexCountlandingpad);
-				rendervao(projection * world2camera * model2worldpad2, model2worldpad2, model2worldpad2matrix, vaolandingpad, vertexCountlandingpad);
+			}
 
-                // Finish benchmarking for task 1.4
-                #ifdef ENABLE_BENCHMARK_14
-                if (swapQueue) {
-                	endTimer(queryQueueA);
-                }
-                else {
-                	endTimer(queryQueueB);
-                }
-                swapQueue = !swapQueue;
-                #endif
-
-				// Start benchmarking for task 1.5
-                #ifdef ENABLE_BENCHMARK_15
-                if (swapQueue) {
-                    getTimes(queryQueueB, "1.5: ");
-                    startTimer(queryQueueA);
-                }
+			// Shows the statistics up to the previous frame
+			if (statePtr->showHud) {
+				PROFILE_CPU("hud");
+				PROFILE_GPU("hud");
 
-                else {
-                    getTimes(queryQueueA, "1.5: ");
-                    startTimer(queryQueueB);
-                }
-                #endif
+				glViewport(0, 0, GLsizei(fbwidth), GLsizei(fbheight));
+				statePtr->hud->draw(frameStream, fbwidth, fbheight);
+			}
 
-                // Render rocket
-				rendervao(projection * world2camera * model2world_rocket, model2world_rocket, rocketmatrix, vao_rocket, vertex_rocket);
+			// GL calls from here on count towards the next frame
+			statePtr->glStats = end_gl_stats_frame();
 
-                // Finish benchmarking for task 1.5
-                #ifdef ENABLE_BENCHMARK_15
-                if (swapQueue) {
+			// The frame zones of this frame are still open, so the times are
+			// those of earlier frames
+			statePtr->hud->add_frame(HudFrameStats{
+				float(currentTime - lastTime) * 1000.f,
+				float(profiler.latest_ms("frame", EProfileClock::cpu)),
+				float(profiler.latest_ms("frame", EProfileClock::gpu)),
+				statePtr->glStats,
+				statePtr->queueStats.triangles + statePtr->particleTriangles,
+				statePtr->particleSys.pool.size(),
+				statePtr->particleSys.useGpu
+			});
 
-                	endTimer(queryQueueA);
-                }
-                else {
+			frameStream.end_frame();
 
-                	endTimer(queryQueueB);
-                }
-                swapQueue = !swapQueue;
-                #endif
+			report_cull_stats_(window, *statePtr, currentTime);
+			if (!bench)
+				report_profile_(*statePtr, currentTime);
 
-				renderlight(*statePtr, pointLightPos, pointLightsColor);
-				render_particle_system_(*statePtr, projView, camRight, camUp);
+			lastTime = currentTime;
+		}
 
-				glBindVertexArray(0);
-				glUseProgram(0);
+		profiler.end_frame();
 
-                // Finish CPU benchmarking
-                #ifdef CPU_BENCHMARK
-                auto renderEnd = clock::now();
-                std::chrono::duration<float, std::milli> renderTime = renderEnd - renderStart;
-                std::cout << "Render Submission Time: " << renderTime.count() << " ms" << std::endl;
-                #endif
-
-                // Finish benchmarking for full rendering
-                #ifdef ENABLE_BENCHMARK_FULL
-                if (swapQueue) {
-                    endTimer(queryQueueA);
-                }
-                else {
-                    endTimer(queryQueueB);
-                }
-                swapQueue = !swapQueue;
-                #endif
-			}
+		if (!bench)
+			update_trace_(state, profiler, glfwGetTime());
 
-			// Swap buffers and update time
-			glfwSwapBuffers(window);
-			lastTime = currentTime;
-		}
+		// Swap buffers
+		glfwSwapBuffers(window);
 	}
 
 	// ... [Cleanup code] ...
-	if (state.particleVao)
-		glDeleteVertexArrays(1, &state.particleVao);
-	if (state.particleVbo)
-		glDeleteBuffers(1, &state.particleVbo);
 	if (state.particleSys.texture)
 		glDeleteTextures(1, &state.particleSys.texture);
 
-    glDeleteBuffers(1, &vao_rocket);
-    glDeleteBuffers(1, &vaolandingpad);
-    glDeleteBuffers(1, &vaolangerso);
-
-    glDeleteVertexArrays(1, &vao_rocket);
-    glDeleteVertexArrays(1, &vaolandingpad);
-    glDeleteVertexArrays(1, &vaolangerso);
-
     glDeleteTextures(1, &orthophoto);
 
 	// program has already been deleted
     state.prog = nullptr;
     state.landingpadprog = nullptr;
     state.particleprog = nullptr;
-
-    #ifdef PREPARE_BENCHMARK
-    glDeleteQueries(2, queryQueueA);
-    glDeleteQueries(2, queryQueueB);
-    #endif
+    state.multiviewprog = nullptr;
+    state.multiviewLandingpadprog = nullptr;
+    state.multiviewParticleprog = nullptr;
+    state.gpuParticleprog = nullptr;
+    state.multiviewGpuParticleprog = nullptr;
+    state.particleSys.gpu = nullptr;
+    state.renderQueue = nullptr;
+    state.jobs = nullptr;
+    state.profiler = nullptr;
 
 	return 0;
 }
@@ -1180,22 +1593,30 @@ void glfw_callback_key_(GLFWwindow* aWindow, int aKey, int, int aAction, int aMo
 		{
 			if (aKey == GLFW_KEY_V)
 			{
-				// Toggle split-screen mode
-				state->splitScreen = !state->splitScreen;
+				// Cycle split-screen mode: off, two views, four views
+				if (!state->splitScreen)
+				{
+					state->splitScreen = true;
+					state->splitViews = 2;
+				}
+				else if (state->splitViews < kMaxViews)
+					state->splitViews = kMaxViews;
+				else
+					state->splitScreen = false;
 			}
 			else if (aKey == GLFW_KEY_C)
 			{
 				if (aMods & GLFW_MOD_SHIFT)
 				{
 					// Cycle camera mode for View 2
-					state->camControl2.changeCamera = (state->camControl2.changeCamera + 1) % 4;
+					state->splitCams[1].changeCamera = (state->splitCams[1].changeCamera + 1) % 4;
 				}
 				else
 				{
 					if (state->splitScreen)
 					{
 						// Cycle camera mode for View 1
-						state->camControl1.changeCamera = (state->camControl1.changeCamera + 1) % 4;
+						state->splitCams[0].changeCamera = (state->splitCams[0].changeCamera + 1) % 4;
 					}
 					else
 					{
@@ -1212,36 +1633,58 @@ void glfw_callback_key_(GLFWwindow* aWindow, int aKey, int, int aAction, int aMo
 			{
 				state->rockControl.reset = true;
 			}
+			else if (aKey == GLFW_KEY_P)
+			{
+				// Toggle the profiler's report; takes effect on the next frame
+				state->printProfile = !state->printProfile;
+				std::printf("Profiler %s\n", state->printProfile ? "on" : "off");
+			}
+			else if (aKey == GLFW_KEY_H)
+			{
+				state->showHud = !state->showHud;
+			}
+			else if (aKey == GLFW_KEY_T)
+			{
+				// Start or stop a trace capture (see update_trace_())
+				state->traceRequested = !state->traceRequested;
+				std::printf("Trace capture %s\n", state->traceRequested ? "started" : "stopped");
+			}
+			else if (aKey == GLFW_KEY_G)
+			{
+				// Switch between the CPU and GPU particle simulations; takes
+				// effect on the next update
+				state->particleSys.switchSimulator = true;
+			}
 
 			// Handle movement flags based on split-screen
 			if (state->splitScreen)
 			{
-				// Update both cameras
+				// Update all split-screen cameras
 				switch (aKey)
 				{
 				case GLFW_KEY_W:
-					state->camControl1.moveForward = true;
-					state->camControl2.moveForward = true;
+					for (auto& cam : state->splitCams)
+						cam.moveForward = true;
 					break;
 				case GLFW_KEY_S:
-					state->camControl1.moveBackward = true;
-					state->camControl2.moveBackward = true;
+					for (auto& cam : state->splitCams)
+						cam.moveBackward = true;
 					break;
 				case GLFW_KEY_A:
-					state->camControl1.moveLeft = true;
-					state->camControl2.moveLeft = true;
+					for (auto& cam : state->splitCams)
+						cam.moveLeft = true;
 					break;
 				case GLFW_KEY_D:
-					state->camControl1.moveRight = true;
-					state->camControl2.moveRight = true;
+					for (auto& cam : state->splitCams)
+						cam.moveRight = true;
 					break;
 				case GLFW_KEY_E:
-					state->camControl1.moveUp = true;
-					state->camControl2.moveUp = true;
+					for (auto& cam : state->splitCams)
+						cam.moveUp = true;
 					break;
 				case GLFW_KEY_Q:
-					state->camControl1.moveDown = true;
-					state->camControl2.moveDown = true;
+					for (auto& cam : state->splitCams)
+						cam.moveDown = true;
 					break;
 				default:
 					break;
@@ -1280,32 +1723,32 @@ void glfw_callback_key_(GLFWwindow* aWindow, int aKey, int, int aAction, int aMo
 			// Handle movement flags based on split-screen
 			if (state->splitScreen)
 			{
-				// Update both cameras
+				// Update all split-screen cameras
 				switch (aKey)
 				{
 				case GLFW_KEY_W:
-					state->camControl1.moveForward = false;
-					state->camControl2.moveForward = false;
+					for (auto& cam : state->splitCams)
+						cam.moveForward = false;
 					break;
 				case GLFW_KEY_S:
-					state->camControl1.moveBackward = false;
-					state->camControl2.moveBackward = false;
+					for (auto& cam : state->splitCams)
+						cam.moveBackward = false;
 					break;
 				case GLFW_KEY_A:
-					state->camControl1.moveLeft = false;
-					state->camControl2.moveLeft = false;
+					for (auto& cam : state->splitCams)
+						cam.moveLeft = false;
 					break;
 				case GLFW_KEY_D:
-					state->camControl1.moveRight = false;
-					state->camControl2.moveRight = false;
+					for (auto& cam : state->splitCams)
+						cam.moveRight = false;
 					break;
 				case GLFW_KEY_E:
-					state->camControl1.moveUp = false;
-					state->camControl2.moveUp = false;
+					for (auto& cam : state->splitCams)
+						cam.moveUp = false;
 					break;
 				case GLFW_KEY_Q:
-					state->camControl1.moveDown = false;
-					state->camControl2.moveDown = false;
+					for (auto& cam : state->splitCams)
+						cam.moveDown = false;
 					break;
 				default:
 					break;
@@ -1368,22 +1811,22 @@ void glfw_callback_motion_(GLFWwindow* aWindow, double aX, double aY)
 		}
 		else
 		{
-			// If split-screen is active, update camControl left
-			if (state->camControl1.cameraActive)
+			// If split-screen is active, update the first view's camera
+			if (state->splitCams[0].cameraActive)
 			{
-				auto const dx = float(aX - state->camControl1.lastX);
-				auto const dy = float(aY - state->camControl1.lastY);
+				auto const dx = float(aX - state->splitCams[0].lastX);
+				auto const dy = float(aY - state->splitCams[0].lastY);
 
-				state->camControl1.phi += dx * kMouseSensitivity_;
-				state->camControl1.theta += dy * kMouseSensitivity_;
+				state->splitCams[0].phi += dx * kMouseSensitivity_;
+				state->splitCams[0].theta += dy * kMouseSensitivity_;
 				if (state->camControl.theta > std::numbers::pi_v<float> / 2.f)
 					state->camControl.theta = std::numbers::pi_v<float> / 2.f;
 				else if (state->camControl.theta < -std::numbers::pi_v<float> / 2.f)
 					state->camControl.theta = -std::numbers::pi_v<float> / 2.f;
 			}
 
-			state->camControl1.lastX = static_cast<float>(aX);
-			state->camControl1.lastY = static_cast<float>(aY);
+			state->splitCams[0].lastX = static_cast<float>(aX);
+			state->splitCams[0].lastY = static_cast<float>(aY);
 		}
 	}
 }
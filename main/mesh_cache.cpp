@@ -0,0 +1,308 @@
+#include "mesh_cache.hpp"
+
+#include <filesystem>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+
+#include <cstdio>
+#include <cstring>
+
+#include "loadobj.hpp"
+#include "mesh_optimize.hpp"
+#include "mesh_simplify.hpp"
+#include "mesh_tiles.hpp"
+
+#include "../support/error.hpp"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	constexpr char kMagic_[8] = { 'S', 'M', 'E', 'S', 'H', 'C', 'A', 'C' };
+
+	// Section data is aligned so that it can be viewed in place.
+	constexpr std::uint64_t kSectionAlign_ = 16;
+
+	enum ESection_ : std::size_t
+	{
+		eSectionPositions_,
+		eSectionColors_,
+		eSectionNormals_,
+		eSectionTexcoords_,
+		eSectionIndices_,
+		eSectionLods_,
+		eSectionTiles_,
+
+		eSectionCount_
+	};
+
+	struct Section_
+	{
+		std::uint64_t offset; // bytes from start of file
+		std::uint64_t count;  // number of elements
+	};
+
+	// Identifies the version of a source file.
+	struct SourceStamp_
+	{
+		std::uint64_t size;
+		std::int64_t mtime; // file_time_type ticks; 0 if the file doesn't exist
+
+		bool operator==( SourceStamp_ const& ) const = default;
+	};
+
+	struct Header_
+	{
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t sectionCount;
+
+		SourceStamp_ obj;
+		SourceStamp_ mtl;
+
+		std::uint32_t tilesX, tilesZ;
+		std::uint32_t lodLevels;
+		std::uint32_t padding_;
+
+		Section_ sections[eSectionCount_];
+	};
+
+	static_assert( std::is_trivially_copyable_v<Header_> );
+	static_assert( std::is_trivially_copyable_v<MeshLod> && std::is_trivially_copyable_v<MeshTile> );
+	static_assert( sizeof(Header_) % kSectionAlign_ == 0 );
+
+	constexpr std::size_t kElementSize_[eSectionCount_] = {
+		sizeof(Vec3f), sizeof(Vec3f), sizeof(Vec3f), sizeof(Vec2f), sizeof(GLuint), sizeof(MeshLod), sizeof(MeshTile)
+	};
+
+	SourceStamp_ stamp_( fs::path const& aPath )
+	{
+		std::error_code ec;
+		auto const size = fs::file_size( aPath, ec );
+		if( ec )
+			return SourceStamp_{ 0, 0 };
+
+		auto const mtime = fs::last_write_time( aPath, ec );
+		if( ec )
+			return SourceStamp_{ 0, 0 };
+
+		return SourceStamp_{ std::uint64_t(size), std::int64_t(mtime.time_since_epoch().count()) };
+	}
+
+	Header_ make_header_( SourceStamp_ const& aObj, SourceStamp_ const& aMtl, MeshProcessing const& aProcessing )
+	{
+		Header_ header{};
+		std::memcpy( header.magic, kMagic_, sizeof(kMagic_) );
+		header.version = kMeshCacheVersion;
+		header.sectionCount = eSectionCount_;
+		header.obj = aObj;
+		header.mtl = aMtl;
+		header.tilesX = aProcessing.tilesX;
+		header.tilesZ = aProcessing.tilesZ;
+		header.lodLevels = aProcessing.lodLevels;
+		return header;
+	}
+
+	template< typename tType >
+	std::span<tType const> section_view_( MappedFile const& aFile, Section_ const& aSection )
+	{
+		return { reinterpret_cast<tType const*>(aFile.data() + aSection.offset), std::size_t(aSection.count) };
+	}
+
+	// Returns false if the file isn't a valid cache for the given sources.
+	bool validate_( MappedFile const& aFile, Header_ const& aExpected, SimpleMeshView& aView )
+	{
+		if( aFile.size() < sizeof(Header_) )
+			return false;
+
+		Header_ header;
+		std::memcpy( &header, aFile.data(), sizeof(Header_) );
+
+		if( 0 != std::memcmp( header.magic, aExpected.magic, sizeof(header.magic) ) )
+			return false;
+		if( header.version != aExpected.version || header.sectionCount != aExpected.sectionCount )
+			return false;
+		if( !(header.obj == aExpected.obj) || !(header.mtl == aExpected.mtl) )
+			return false;
+		if( header.tilesX != aExpected.tilesX || header.tilesZ != aExpected.tilesZ || header.lodLevels != aExpected.lodLevels )
+			return false;
+
+		auto const vertexCount = header.sections[eSectionPositions_].count;
+		for( std::size_t i = 0; i < eSectionCount_; ++i )
+		{
+			auto const& sec = header.sections[i];
+			if( sec.offset % kSectionAlign_ )
+				return false;
+			if( sec.offset > aFile.size() || sec.count > (aFile.size() - sec.offset) / kElementSize_[i] )
+				return false;
+
+			// Vertex attributes are either absent or present for each vertex
+			if( i < eSectionIndices_ && 0 != sec.count && vertexCount != sec.count )
+				return false;
+		}
+
+		aView.positions = section_view_<Vec3f>( aFile, header.sections[eSectionPositions_] );
+		aView.colors = section_view_<Vec3f>( aFile, header.sections[eSectionColors_] );
+		aView.normals = section_view_<Vec3f>( aFile, header.sections[eSectionNormals_] );
+		aView.texcoords = section_view_<Vec2f>( aFile, header.sections[eSectionTexcoords_] );
+		aView.indices = section_view_<GLuint>( aFile, header.sections[eSectionIndices_] );
+		aView.lods = section_view_<MeshLod>( aFile, header.sections[eSectionLods_] );
+		aView.tiles = section_view_<MeshTile>( aFile, header.sections[eSectionTiles_] );
+
+		auto const valid_range_ = [&] (MeshLod const& aLod) {
+			return aLod.firstIndex <= aView.indices.size() && aLod.indexCount <= aView.indices.size() - aLod.firstIndex;
+		};
+
+		for( auto const& lod : aView.lods )
+		{
+			if( !valid_range_( lod ) )
+				return false;
+		}
+		for( auto const& tile : aView.tiles )
+		{
+			if( 0 == tile.lodCount || tile.lodCount > kMaxTileLods )
+				return false;
+			if( !std::all_of( tile.lods, tile.lods + tile.lodCount, valid_range_ ) )
+				return false;
+		}
+
+		return true;
+	}
+
+	// Writes to a temporary file first and renames it into place, so that a
+	// partially written cache is never picked up.
+	void write_cache_( fs::path const& aPath, Header_ aHeader, SimpleMeshView const& aMesh )
+	{
+		std::span<std::byte const> const data[eSectionCount_] = {
+			std::as_bytes( aMesh.positions ),
+			std::as_bytes( aMesh.colors ),
+			std::as_bytes( aMesh.normals ),
+			std::as_bytes( aMesh.texcoords ),
+			std::as_bytes( aMesh.indices ),
+			std::as_bytes( aMesh.lods ),
+			std::as_bytes( aMesh.tiles )
+		};
+
+		std::uint64_t offset = sizeof(Header_);
+		for( std::size_t i = 0; i < eSectionCount_; ++i )
+		{
+			aHeader.sections[i].offset = offset;
+			aHeader.sections[i].count = data[i].size() / kElementSize_[i];
+
+			offset += (data[i].size() + kSectionAlign_-1) & ~(kSectionAlign_-1);
+		}
+
+		auto tmpPath = aPath;
+		tmpPath += ".tmp";
+
+		std::FILE* fout = std::fopen( tmpPath.string().c_str(), "wb" );
+		if( !fout )
+			throw Error( "Unable to open '%s' for writing", tmpPath.string().c_str() );
+
+		bool ok = 1 == std::fwrite( &aHeader, sizeof(Header_), 1, fout );
+
+		static constexpr char kPadding_[kSectionAlign_]{};
+		for( std::size_t i = 0; ok && i < eSectionCount_; ++i )
+		{
+			auto const bytes = data[i].size();
+			if( bytes )
+				ok = 1 == std::fwrite( data[i].data(), bytes, 1, fout );
+
+			auto const pad = ((bytes + kSectionAlign_-1) & ~(kSectionAlign_-1)) - bytes;
+			if( ok && pad )
+				ok = 1 == std::fwrite( kPadding_, pad, 1, fout );
+		}
+
+		ok = (0 == std::fclose( fout )) && ok;
+
+		std::error_code ec;
+		if( ok )
+			fs::rename( tmpPath, aPath, ec );
+
+		if( !ok || ec )
+		{
+			fs::remove( tmpPath, ec );
+			throw Error( "Unable to write mesh cache '%s'", aPath.string().c_str() );
+		}
+	}
+}
+
+CachedMesh::CachedMesh( SimpleMeshData aData )
+	: mData( std::move(aData) )
+{}
+
+CachedMesh::CachedMesh( MappedFile aFile, SimpleMeshView aView )
+	: mFile( std::move(aFile) )
+	, mMappedView( aView )
+{}
+
+SimpleMeshView CachedMesh::view() const noexcept
+{
+	return from_cache() ? mMappedView : view_of( mData );
+}
+
+bool CachedMesh::from_cache() const noexcept
+{
+	return 0 != mFile.size();
+}
+
+std::string mesh_cache_path( char const* aPath )
+{
+	return std::string( aPath ) + ".meshcache";
+}
+
+CachedMesh load_wavefront_obj_cached( char const* aPath, MeshProcessing const& aProcessing )
+{
+	fs::path const objPath( aPath );
+	fs::path const cachePath( mesh_cache_path( aPath ) );
+
+	auto mtlPath = objPath;
+	mtlPath.replace_extension( ".mtl" );
+
+	auto const expected = make_header_( stamp_( objPath ), stamp_( mtlPath ), aProcessing );
+
+	std::error_code ec;
+	if( fs::exists( cachePath, ec ) )
+	{
+		try
+		{
+			MappedFile file( cachePath.string().c_str() );
+
+			SimpleMeshView view;
+			if( validate_( file, expected, view ) )
+				return CachedMesh( std::move(file), view );
+		}
+		catch( Error const& eErr )
+		{
+			std::fprintf( stderr, "Note: ignoring mesh cache: %s\n", eErr.what() );
+		}
+	}
+
+	// (Re-)build the cache
+	auto mesh = load_wavefront_obj( aPath );
+	print_optimize_report( aPath, optimize_mesh( mesh ) );
+
+	if( aProcessing.tilesX && aProcessing.tilesZ )
+	{
+		auto const tiles = tile_mesh( mesh, aProcessing.tilesX, aProcessing.tilesZ, aProcessing.lodLevels );
+		std::printf( "  %zu tiles (%u x %u)\n", tiles, aProcessing.tilesX, aProcessing.tilesZ );
+	}
+	else
+		build_lod_chain( mesh, aProcessing.lodLevels );
+
+	for( std::size_t i = 1; i < mesh.lods.size(); ++i )
+		std::printf( "  LOD %zu: %u triangles, error %g\n", i, mesh.lods[i].indexCount / 3, double(mesh.lods[i].error) );
+
+	try
+	{
+		write_cache_( cachePath, expected, view_of( mesh ) );
+	}
+	catch( Error const& eErr )
+	{
+		std::fprintf( stderr, "Warning: %s\n", eErr.what() );
+	}
+
+	return CachedMesh( std::move(mesh) );
+}
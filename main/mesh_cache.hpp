@@ -0,0 +1,70 @@
+#ifndef MESH_CACHE_HPP_CE74C975_680A_4AE3_9DCB_54E9986B5D1C
+#define MESH_CACHE_HPP_CE74C975_680A_4AE3_9DCB_54E9986B5D1C
+
+#include <string>
+
+#include <cstdint>
+
+#include "simple_mesh.hpp"
+#include "../support/mapped_file.hpp"
+
+/* Binary mesh cache
+ *
+ * Parsing OBJ files is slow. load_wavefront_obj_cached() stores the processed
+ * mesh (indexed, optimized, optionally tiled and with levels of detail; see
+ * mesh_optimize.hpp, mesh_tiles.hpp and mesh_simplify.hpp) in a binary file
+ * next to the OBJ
+ * ("<obj path>.meshcache") the first time it is loaded. Later loads memory-map
+ * the cache and return views into the mapping, which can be passed to
+ * create_gpu_mesh() directly; there is no per-vertex work.
+ *
+ * The cache is rebuilt if it is missing or malformed, if its version does not
+ * match kMeshCacheVersion, if it was built with different MeshProcessing
+ * settings, or if the size or modification time of the OBJ (or
+ * the MTL file with the same name, if any) changed. Bump kMeshCacheVersion
+ * whenever the mesh processing or the file layout changes.
+ *
+ * The cache uses the native byte order and is not meant to be shared between
+ * machines. Failure to write the cache is reported but not fatal.
+ */
+inline constexpr std::uint32_t kMeshCacheVersion = 4;
+
+struct MeshProcessing
+{
+	// Number of tiles along X and Z; zero disables tiling.
+	unsigned tilesX = 0;
+	unsigned tilesZ = 0;
+
+	// Levels of detail, including the full-detail level. Per tile if the mesh
+	// is tiled. The default builds no simplified levels; only opt in for
+	// meshes whose renderer selects a level (see select_lod()).
+	unsigned lodLevels = 1;
+};
+
+class CachedMesh final
+{
+	public:
+		CachedMesh() = default;
+
+		explicit CachedMesh( SimpleMeshData );
+		CachedMesh( MappedFile, SimpleMeshView );
+
+	public:
+		// Valid as long as this object is alive.
+		SimpleMeshView view() const noexcept;
+
+		bool from_cache() const noexcept;
+
+	private:
+		MappedFile mFile;
+		SimpleMeshView mMappedView;
+
+		SimpleMeshData mData;
+};
+
+CachedMesh load_wavefront_obj_cached( char const* aPath, MeshProcessing const& = {} );
+
+// Path of the cache file for the given OBJ file
+std::string mesh_cache_path( char const* aPath );
+
+#endif // MESH_CACHE_HPP_CE74C975_680A_4AE3_9DCB_54E9986B5D1C
@@ -0,0 +1,394 @@
+#include "mesh_optimize.hpp"
+
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <algorithm>
+
+#include <cstdio>
+#include <cassert>
+#include <cstdint>
+
+namespace
+{
+	constexpr GLuint kInvalid_ = std::numeric_limits<GLuint>::max();
+
+	Vec3f cross_( Vec3f aLeft, Vec3f aRight ) noexcept
+	{
+		return Vec3f{
+			aLeft.y * aRight.z - aLeft.z * aRight.y,
+			aLeft.z * aRight.x - aLeft.x * aRight.z,
+			aLeft.x * aRight.y - aLeft.y * aRight.x
+		};
+	}
+
+	// Vertex -> triangle adjacency in compressed (CSR) form: the triangles
+	// using vertex v are triangles[offsets[v] .. offsets[v+1]).
+	struct Adjacency_
+	{
+		std::vector<std::uint32_t> offsets;
+		std::vector<std::uint32_t> triangles;
+	};
+
+	Adjacency_ build_adjacency_( std::span<GLuint const> aIndices, std::size_t aVertexCount )
+	{
+		Adjacency_ adj;
+		adj.offsets.assign( aVertexCount+1, 0 );
+		for( auto const idx : aIndices )
+			++adj.offsets[idx+1];
+
+		std::partial_sum( adj.offsets.begin(), adj.offsets.end(), adj.offsets.begin() );
+
+		adj.triangles.resize( aIndices.size() );
+		std::vector<std::uint32_t> fill( adj.offsets.begin(), adj.offsets.end()-1 );
+		for( std::size_t i = 0; i < aIndices.size(); ++i )
+			adj.triangles[fill[aIndices[i]]++] = std::uint32_t(i / 3);
+
+		return adj;
+	}
+
+	// Split the clusters found by Tipsify ("hard" boundaries, where the cache
+	// is cold anyway) further at "soft" boundaries. A cluster is ended as soon
+	// as its ACMR, simulated from a cold cache, drops to aThreshold times the
+	// ACMR of the whole mesh; smaller clusters would cost too much locality.
+	std::vector<std::size_t> split_clusters_( std::span<GLuint const> aIndices, std::size_t aVertexCount, std::span<std::size_t const> aHardStarts, std::size_t aCacheSize, float aThreshold )
+	{
+		auto const meshAcmr = analyze_vertex_cache( aIndices, aVertexCount, aCacheSize ).acmr;
+		auto const limit = meshAcmr * aThreshold;
+
+		std::vector<std::size_t> starts;
+		std::vector<std::size_t> insertedAt( aVertexCount, 0 );
+
+		std::size_t time = 0;
+		for( std::size_t c = 0; c < aHardStarts.size(); ++c )
+		{
+			auto const end = c+1 < aHardStarts.size() ? aHardStarts[c+1] : aIndices.size();
+
+			std::size_t clusterStart = aHardStarts[c];
+			std::size_t misses = 0;
+
+			// Starting a cluster flushes the simulated cache
+			starts.emplace_back( clusterStart );
+			time += aCacheSize + 1;
+
+			for( std::size_t i = clusterStart; i < end; i += 3 )
+			{
+				for( std::size_t k = 0; k < 3; ++k )
+				{
+					auto const v = aIndices[i+k];
+					if( time - insertedAt[v] > aCacheSize )
+					{
+						insertedAt[v] = time++;
+						++misses;
+					}
+				}
+
+				auto const triangles = (i+3 - clusterStart) / 3;
+				if( i+3 < end && float(misses) <= limit * triangles )
+				{
+					clusterStart = i+3;
+					misses = 0;
+
+					starts.emplace_back( clusterStart );
+					time += aCacheSize + 1;
+				}
+			}
+		}
+
+		return starts;
+	}
+}
+
+VertexCacheStats analyze_vertex_cache( std::span<GLuint const> aIndices, std::size_t aVertexCount, std::size_t aCacheSize )
+{
+	assert( aCacheSize > 0 );
+
+	// FIFO cache: vertex v is in the cache if it was inserted less than
+	// aCacheSize insertions ago.
+	std::vector<std::size_t> insertedAt( aVertexCount, 0 );
+	std::vector<bool> referenced( aVertexCount, false );
+
+	std::size_t misses = 0, time = aCacheSize + 1, unique = 0;
+	for( auto const idx : aIndices )
+	{
+		if( time - insertedAt[idx] > aCacheSize )
+		{
+			insertedAt[idx] = time++;
+			++misses;
+		}
+
+		if( !referenced[idx] )
+		{
+			referenced[idx] = true;
+			++unique;
+		}
+	}
+
+	auto const triangles = aIndices.size() / 3;
+	return VertexCacheStats{
+		triangles ? float(misses) / triangles : 0.f,
+		unique ? float(misses) / unique : 0.f
+	};
+}
+
+std::vector<std::size_t> optimize_vertex_cache( std::span<GLuint> aIndices, std::size_t aVertexCount, std::size_t aCacheSize )
+{
+	assert( aCacheSize > 0 );
+	assert( aIndices.size() % 3 == 0 );
+
+	std::vector<std::size_t> clusters;
+
+	auto const triangleCount = aIndices.size() / 3;
+	if( 0 == triangleCount )
+		return clusters;
+
+	auto const adj = build_adjacency_( aIndices, aVertexCount );
+
+	// Live triangle count per vertex and cache time stamps
+	std::vector<std::uint32_t> live( aVertexCount );
+	for( std::size_t v = 0; v < aVertexCount; ++v )
+		live[v] = adj.offsets[v+1] - adj.offsets[v];
+
+	std::vector<std::size_t> stamp( aVertexCount, 0 );
+	std::vector<bool> emitted( triangleCount, false );
+
+	std::vector<GLuint> deadEnd; // stack of recently used vertices
+	std::vector<GLuint> candidates;
+
+	std::vector<GLuint> output;
+	output.reserve( aIndices.size() );
+
+	std::size_t time = aCacheSize + 1;
+	std::size_t cursor = 0; // for the linear search over vertices
+
+	GLuint fan = aIndices[0];
+	clusters.emplace_back( 0 );
+
+	while( kInvalid_ != fan )
+	{
+		candidates.clear();
+
+		// Emit all remaining triangles around the fanning vertex
+		for( auto t = adj.offsets[fan]; t < adj.offsets[fan+1]; ++t )
+		{
+			auto const tri = adj.triangles[t];
+			if( emitted[tri] )
+				continue;
+
+			for( std::size_t c = 0; c < 3; ++c )
+			{
+				auto const v = aIndices[tri*3+c];
+				output.emplace_back( v );
+				deadEnd.emplace_back( v );
+				candidates.emplace_back( v );
+
+				--live[v];
+				if( time - stamp[v] > aCacheSize )
+					stamp[v] = time++;
+			}
+
+			emitted[tri] = true;
+		}
+
+		// Select the next fanning vertex: a candidate that will still be in
+		// the cache after its remaining triangles are emitted, preferring
+		// the oldest one.
+		GLuint next = kInvalid_;
+		std::size_t best = 0;
+		bool found = false;
+		for( auto const v : candidates )
+		{
+			if( 0 == live[v] )
+				continue;
+
+			std::size_t priority = 0;
+			if( time - stamp[v] + 2*live[v] <= aCacheSize )
+				priority = time - stamp[v];
+
+			if( !found || priority > best )
+			{
+				best = priority;
+				next = v;
+				found = true;
+			}
+		}
+
+		if( !found )
+		{
+			// Dead end: try recently used vertices first, then fall back to
+			// a linear search. The latter starts a new cluster, as the cache
+			// contents are unrelated to the next triangles.
+			while( !deadEnd.empty() && kInvalid_ == next )
+			{
+				auto const v = deadEnd.back();
+				deadEnd.pop_back();
+				if( live[v] > 0 )
+					next = v;
+			}
+
+			if( kInvalid_ == next )
+			{
+				while( kInvalid_ == next && cursor < aVertexCount )
+				{
+					if( live[cursor] > 0 )
+						next = GLuint(cursor);
+					++cursor;
+				}
+
+				if( kInvalid_ != next )
+					clusters.emplace_back( output.size() );
+			}
+		}
+
+		fan = next;
+	}
+
+	assert( output.size() == aIndices.size() );
+	std::copy( output.begin(), output.end(), aIndices.begin() );
+
+	return clusters;
+}
+
+void optimize_overdraw( std::span<GLuint> aIndices, std::span<Vec3f const> aPositions, std::span<std::size_t const> aHardClusterStarts, std::size_t aCacheSize, float aThreshold )
+{
+	if( aHardClusterStarts.empty() )
+		return;
+
+	auto const clusterStarts = split_clusters_( aIndices, aPositions.size(), aHardClusterStarts, aCacheSize, aThreshold );
+	if( clusterStarts.size() < 2 )
+		return;
+
+	auto const clusterCount = clusterStarts.size();
+	auto const cluster_end_ = [&] (std::size_t aCluster) {
+		return aCluster+1 < clusterCount ? clusterStarts[aCluster+1] : aIndices.size();
+	};
+
+	// Area-weighted centroid of the whole mesh
+	Vec3f meshCenter{ 0.f, 0.f, 0.f };
+	float meshArea = 0.f;
+
+	std::vector<Vec3f> centers( clusterCount );
+	std::vector<Vec3f> normals( clusterCount );
+
+	for( std::size_t c = 0; c < clusterCount; ++c )
+	{
+		Vec3f center{ 0.f, 0.f, 0.f }, normal{ 0.f, 0.f, 0.f };
+		float area = 0.f;
+
+		for( std::size_t i = clusterStarts[c]; i < cluster_end_( c ); i += 3 )
+		{
+			auto const p0 = aPositions[aIndices[i+0]];
+			auto const p1 = aPositions[aIndices[i+1]];
+			auto const p2 = aPositions[aIndices[i+2]];
+
+			auto const n = cross_( p1 - p0, p2 - p0 ); // length = 2 * area
+			auto const a = length( n );
+
+			center += (a / 3.f) * (p0 + p1 + p2);
+			normal += n;
+			area += a;
+		}
+
+		meshCenter += center;
+		meshArea += area;
+
+		centers[c] = area > 0.f ? center / area : aPositions[aIndices[clusterStarts[c]]];
+		normals[c] = normal;
+	}
+
+	if( meshArea > 0.f )
+		meshCenter /= meshArea;
+
+	// Clusters that face away from the center are on the outside of the mesh
+	// and are more likely to occlude the rest; draw those first.
+	std::vector<float> sortKey( clusterCount );
+	for( std::size_t c = 0; c < clusterCount; ++c )
+	{
+		auto const len = length( normals[c] );
+		sortKey[c] = len > 0.f ? dot( centers[c] - meshCenter, normals[c] / len ) : 0.f;
+	}
+
+	std::vector<std::size_t> order( clusterCount );
+	std::iota( order.begin(), order.end(), std::size_t(0) );
+	std::stable_sort( order.begin(), order.end(), [&] (std::size_t aA, std::size_t aB) {
+		return sortKey[aA] > sortKey[aB];
+	} );
+
+	std::vector<GLuint> reordered;
+	reordered.reserve( aIndices.size() );
+	for( auto const c : order )
+		reordered.insert( reordered.end(), aIndices.begin() + clusterStarts[c], aIndices.begin() + cluster_end_( c ) );
+
+	std::copy( reordered.begin(), reordered.end(), aIndices.begin() );
+}
+
+void optimize_vertex_fetch( SimpleMeshData& aMesh )
+{
+	auto const vertexCount = aMesh.positions.size();
+
+	std::vector<GLuint> remap( vertexCount, kInvalid_ );
+	GLuint next = 0;
+	for( auto& idx : aMesh.indices )
+	{
+		if( kInvalid_ == remap[idx] )
+			remap[idx] = next++;
+		idx = remap[idx];
+	}
+
+	auto const reorder_ = [&] (auto& aAttribute) {
+		if( aAttribute.empty() )
+			return;
+
+		std::remove_reference_t<decltype(aAttribute)> result( next );
+		for( std::size_t v = 0; v < vertexCount; ++v )
+		{
+			if( kInvalid_ != remap[v] )
+				result[remap[v]] = aAttribute[v];
+		}
+		aAttribute = std::move(result);
+	};
+
+	reorder_( aMesh.positions );
+	reorder_( aMesh.colors );
+	reorder_( aMesh.normals );
+	reorder_( aMesh.texcoords );
+}
+
+MeshOptimizeReport optimize_mesh( SimpleMeshData& aMesh, std::size_t aCacheSize )
+{
+	assert( aMesh.lods.empty() );
+
+	if( aMesh.indices.empty() )
+		aMesh = make_indexed( aMesh );
+
+	MeshOptimizeReport report{};
+	report.before = analyze_vertex_cache( aMesh.indices, aMesh.positions.size(), aCacheSize );
+
+	auto const original = aMesh.indices;
+
+	auto const clusters = optimize_vertex_cache( aMesh.indices, aMesh.positions.size(), aCacheSize );
+	optimize_overdraw( aMesh.indices, aMesh.positions, clusters, aCacheSize );
+
+	// Meshes that are generated in a cache-friendly order (e.g. the procedural
+	// shapes) can come out slightly worse. Keep the original order unless the
+	// result is within the overdraw threshold of it.
+	auto const reordered = analyze_vertex_cache( aMesh.indices, aMesh.positions.size(), aCacheSize );
+	if( reordered.acmr > report.before.acmr * kDefaultOverdrawThreshold )
+		aMesh.indices = original;
+
+	optimize_vertex_fetch( aMesh );
+
+	report.after = analyze_vertex_cache( aMesh.indices, aMesh.positions.size(), aCacheSize );
+	report.clusters = clusters.size();
+	return report;
+}
+
+void print_optimize_report( char const* aName, MeshOptimizeReport const& aReport )
+{
+	std::printf( "Optimized '%s': ACMR %.3f -> %.3f, ATVR %.3f -> %.3f (%zu clusters)\n",
+		aName,
+		aReport.before.acmr, aReport.after.acmr,
+		aReport.before.atvr, aReport.after.atvr,
+		aReport.clusters
+	);
+}
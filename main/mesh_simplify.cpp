@@ -0,0 +1,452 @@
+#include "mesh_simplify.hpp"
+
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <algorithm>
+#include <unordered_map>
+
+#include <bit>
+#include <cassert>
+#include <cstdint>
+
+#include "mesh_optimize.hpp"
+
+namespace
+{
+	constexpr GLuint kInvalid_ = std::numeric_limits<GLuint>::max();
+
+	// Symmetric 4x4 quadric: p^T A p + 2 b^T p + c
+	struct Quadric_
+	{
+		double a00, a01, a02, a11, a12, a22;
+		double b0, b1, b2;
+		double c;
+		double weight;
+	};
+
+	Quadric_& operator+=( Quadric_& aQ, Quadric_ const& aR ) noexcept
+	{
+		aQ.a00 += aR.a00; aQ.a01 += aR.a01; aQ.a02 += aR.a02;
+		aQ.a11 += aR.a11; aQ.a12 += aR.a12; aQ.a22 += aR.a22;
+		aQ.b0 += aR.b0; aQ.b1 += aR.b1; aQ.b2 += aR.b2;
+		aQ.c += aR.c;
+		aQ.weight += aR.weight;
+		return aQ;
+	}
+
+	// Plane n.p + d = 0 (n normalized), weighted by aWeight
+	Quadric_ plane_quadric_( Vec3f aN, float aD, float aWeight ) noexcept
+	{
+		double const x = aN.x, y = aN.y, z = aN.z, d = aD, w = aWeight;
+		return Quadric_{
+			w*x*x, w*x*y, w*x*z, w*y*y, w*y*z, w*z*z,
+			w*d*x, w*d*y, w*d*z,
+			w*d*d,
+			w
+		};
+	}
+
+	// Weighted mean squared distance to the planes in the quadric
+	double evaluate_( Quadric_ const& aQ, Vec3f aP ) noexcept
+	{
+		double const x = aP.x, y = aP.y, z = aP.z;
+		double const err = aQ.a00*x*x + 2.0*aQ.a01*x*y + 2.0*aQ.a02*x*z
+			+ aQ.a11*y*y + 2.0*aQ.a12*y*z
+			+ aQ.a22*z*z
+			+ 2.0*(aQ.b0*x + aQ.b1*y + aQ.b2*z)
+			+ aQ.c
+		;
+
+		return aQ.weight > 0.0 ? std::max( 0.0, err / aQ.weight ) : 0.0;
+	}
+
+	Vec3f cross_( Vec3f aLeft, Vec3f aRight ) noexcept
+	{
+		return Vec3f{
+			aLeft.y * aRight.z - aLeft.z * aRight.y,
+			aLeft.z * aRight.x - aLeft.x * aRight.z,
+			aLeft.x * aRight.y - aLeft.y * aRight.x
+		};
+	}
+
+	struct PositionHash_
+	{
+		std::size_t operator() (Vec3f const& aP) const noexcept
+		{
+			std::uint64_t hash = std::bit_cast<std::uint32_t>( aP.x );
+			hash = hash * 0x9E3779B97F4A7C15ull ^ std::bit_cast<std::uint32_t>( aP.y );
+			hash = hash * 0x9E3779B97F4A7C15ull ^ std::bit_cast<std::uint32_t>( aP.z );
+			return std::size_t(hash ^ (hash >> 29));
+		}
+	};
+	struct PositionEqual_
+	{
+		bool operator() (Vec3f const& aA, Vec3f const& aB) const noexcept
+		{
+			return aA.x == aB.x && aA.y == aB.y && aA.z == aB.z;
+		}
+	};
+
+	// Maps each vertex to a representative vertex with the same position.
+	// Vertices that share a position are "wedges" of the same group.
+	std::vector<GLuint> build_position_groups_( std::span<Vec3f const> aPositions )
+	{
+		std::vector<GLuint> group( aPositions.size() );
+
+		std::unordered_map<Vec3f, GLuint, PositionHash_, PositionEqual_> first;
+		first.reserve( aPositions.size() );
+
+		for( std::size_t v = 0; v < aPositions.size(); ++v )
+			group[v] = first.emplace( aPositions[v], GLuint(v) ).first->second;
+
+		return group;
+	}
+
+	// Groups on open borders or non-manifold edges may not move.
+	std::vector<bool> find_locked_groups_( std::span<GLuint const> aIndices, std::vector<GLuint> const& aGroup )
+	{
+		std::vector<std::uint64_t> edges;
+		edges.reserve( aIndices.size() );
+
+		for( std::size_t i = 0; i < aIndices.size(); i += 3 )
+		{
+			for( std::size_t k = 0; k < 3; ++k )
+			{
+				std::uint64_t a = aGroup[aIndices[i+k]];
+				std::uint64_t b = aGroup[aIndices[i+(k+1)%3]];
+				if( a == b )
+					continue;
+				if( a > b )
+					std::swap( a, b );
+				edges.emplace_back( (a << 32) | b );
+			}
+		}
+
+		std::sort( edges.begin(), edges.end() );
+
+		std::vector<bool> locked( aGroup.size(), false );
+		for( std::size_t i = 0; i < edges.size(); )
+		{
+			std::size_t j = i+1;
+			while( j < edges.size() && edges[j] == edges[i] )
+				++j;
+
+			if( 2 != j-i )
+			{
+				locked[edges[i] >> 32] = true;
+				locked[edges[i] & 0xffffffffu] = true;
+			}
+
+			i = j;
+		}
+
+		return locked;
+	}
+
+	struct Collapse_
+	{
+		double cost;
+		GLuint from; // group
+		GLuint to;   // group
+	};
+
+	// Works on a compact vertex set, see simplify_mesh().
+	SimplifyResult simplify_compact_( std::span<GLuint const> aIndices, std::span<Vec3f const> aPositions, std::size_t aTargetIndexCount, float aMaxError )
+	{
+		SimplifyResult ret{ std::vector<GLuint>( aIndices.begin(), aIndices.end() ), 0.f };
+		auto& tris = ret.indices;
+
+		auto const vertexCount = aPositions.size();
+		auto const group = build_position_groups_( aPositions );
+		auto const locked = find_locked_groups_( aIndices, group );
+
+		// Per-group quadrics from the planes of the adjacent triangles, weighted
+		// by triangle area
+		std::vector<Quadric_> quadrics( vertexCount, Quadric_{} );
+		for( std::size_t i = 0; i < tris.size(); i += 3 )
+		{
+			auto const p0 = aPositions[tris[i+0]];
+			auto const p1 = aPositions[tris[i+1]];
+			auto const p2 = aPositions[tris[i+2]];
+
+			auto const n = cross_( p1 - p0, p2 - p0 );
+			auto const len = length( n );
+			if( len <= 0.f )
+				continue;
+
+			auto const normal = n / len;
+			auto const q = plane_quadric_( normal, -dot( normal, p0 ), 0.5f * len );
+			for( std::size_t k = 0; k < 3; ++k )
+				quadrics[group[tris[i+k]]] += q;
+		}
+
+		double const maxCost = double(aMaxError) * double(aMaxError);
+		double worstCost = 0.0;
+
+		std::vector<GLuint> remap( vertexCount );
+		std::vector<bool> touched( vertexCount );
+		std::vector<std::uint32_t> adjOffsets( vertexCount+1 );
+		std::vector<std::uint32_t> adjTris;
+		std::vector<Collapse_> candidates;
+		std::vector<std::pair<GLuint,GLuint>> wedgeMap;
+
+		while( tris.size() > aTargetIndexCount )
+		{
+			// Group -> triangle adjacency for the current triangles
+			std::fill( adjOffsets.begin(), adjOffsets.end(), 0 );
+			for( auto const idx : tris )
+				++adjOffsets[group[idx]+1];
+			std::partial_sum( adjOffsets.begin(), adjOffsets.end(), adjOffsets.begin() );
+
+			adjTris.resize( tris.size() );
+			{
+				std::vector<std::uint32_t> fill( adjOffsets.begin(), adjOffsets.end()-1 );
+				for( std::size_t i = 0; i < tris.size(); ++i )
+					adjTris[fill[group[tris[i]]]++] = std::uint32_t(i / 3);
+			}
+
+			// Collect and rank candidate collapses along triangle edges
+			candidates.clear();
+			for( std::size_t i = 0; i < tris.size(); i += 3 )
+			{
+				for( std::size_t k = 0; k < 3; ++k )
+				{
+					auto const a = group[tris[i+k]];
+					auto const b = group[tris[i+(k+1)%3]];
+					if( a == b )
+						continue;
+
+					auto q = quadrics[a];
+					q += quadrics[b];
+
+					if( !locked[a] )
+						candidates.emplace_back( Collapse_{ evaluate_( q, aPositions[b] ), a, b } );
+					if( !locked[b] )
+						candidates.emplace_back( Collapse_{ evaluate_( q, aPositions[a] ), b, a } );
+				}
+			}
+
+			std::sort( candidates.begin(), candidates.end(), [] (Collapse_ const& aX, Collapse_ const& aY) {
+				return aX.cost < aY.cost;
+			} );
+
+			// Apply independent collapses, cheapest first
+			std::iota( remap.begin(), remap.end(), GLuint(0) );
+			std::fill( touched.begin(), touched.end(), false );
+
+			std::size_t const trianglesToRemove = (tris.size() - aTargetIndexCount + 2) / 3;
+			std::size_t removed = 0, collapses = 0;
+
+			for( auto const& cand : candidates )
+			{
+				if( cand.cost > maxCost || removed >= trianglesToRemove )
+					break;
+
+				auto const from = cand.from, to = cand.to;
+				if( touched[from] || touched[to] )
+					continue;
+
+				// Each wedge of "from" must collapse onto the single wedge of "to"
+				// that it shares a triangle with.
+				wedgeMap.clear();
+				bool ok = true;
+				for( auto t = adjOffsets[from]; ok && t < adjOffsets[from+1]; ++t )
+				{
+					auto const tri = adjTris[t]*3;
+
+					GLuint fromWedge = kInvalid_, toWedge = kInvalid_;
+					for( std::size_t k = 0; k < 3; ++k )
+					{
+						auto const g = group[tris[tri+k]];
+						if( g == from ) fromWedge = tris[tri+k];
+						if( g == to ) toWedge = tris[tri+k];
+					}
+
+					if( kInvalid_ == toWedge )
+						continue;
+
+					auto const it = std::find_if( wedgeMap.begin(), wedgeMap.end(), [fromWedge] (auto const& aP) { return aP.first == fromWedge; } );
+					if( wedgeMap.end() == it )
+						wedgeMap.emplace_back( fromWedge, toWedge );
+					else if( it->second != toWedge )
+						ok = false;
+				}
+
+				// Check that all wedges are mapped and that no triangle flips
+				for( auto t = adjOffsets[from]; ok && t < adjOffsets[from+1]; ++t )
+				{
+					auto const tri = adjTris[t]*3;
+
+					Vec3f before[3], after[3];
+					bool hasTo = false;
+					for( std::size_t k = 0; k < 3; ++k )
+					{
+						auto const v = tris[tri+k];
+						before[k] = after[k] = aPositions[v];
+
+						if( group[v] == to )
+							hasTo = true;
+						else if( group[v] == from )
+						{
+							after[k] = aPositions[to];
+
+							auto const it = std::find_if( wedgeMap.begin(), wedgeMap.end(), [v] (auto const& aP) { return aP.first == v; } );
+							if( wedgeMap.end() == it )
+								ok = false;
+						}
+					}
+
+					if( hasTo )
+						continue; // this triangle collapses
+
+					auto const nb = cross_( before[1] - before[0], before[2] - before[0] );
+					auto const na = cross_( after[1] - after[0], after[2] - after[0] );
+					if( dot( nb, na ) <= 0.f )
+						ok = false;
+				}
+
+				if( !ok )
+					continue;
+
+				// Apply
+				for( auto const& [fromWedge, toWedge] : wedgeMap )
+					remap[fromWedge] = toWedge;
+
+				for( auto t = adjOffsets[from]; t < adjOffsets[from+1]; ++t )
+				{
+					auto const tri = adjTris[t]*3;
+
+					bool hasTo = false;
+					for( std::size_t k = 0; k < 3; ++k )
+					{
+						touched[group[tris[tri+k]]] = true;
+						hasTo = hasTo || group[tris[tri+k]] == to;
+					}
+
+					if( hasTo )
+						++removed;
+				}
+
+				quadrics[to] += quadrics[from];
+				worstCost = std::max( worstCost, cand.cost );
+				++collapses;
+			}
+
+			if( 0 == collapses )
+				break;
+
+			// Rewrite the triangles and drop the ones that collapsed
+			std::size_t out = 0;
+			for( std::size_t i = 0; i < tris.size(); i += 3 )
+			{
+				auto const a = remap[tris[i+0]], b = remap[tris[i+1]], c = remap[tris[i+2]];
+				if( group[a] == group[b] || group[b] == group[c] || group[a] == group[c] )
+					continue;
+
+				tris[out++] = a;
+				tris[out++] = b;
+				tris[out++] = c;
+			}
+
+			tris.resize( out );
+		}
+
+		ret.error = float(std::sqrt( worstCost ));
+		return ret;
+	}
+}
+
+SimplifyResult simplify_mesh( std::span<GLuint const> aIndices, std::span<Vec3f const> aPositions, std::size_t aTargetIndexCount, float aMaxError )
+{
+	assert( aIndices.size() % 3 == 0 );
+
+	// Only work on the vertices that are referenced. When simplifying a small
+	// part of a large mesh (e.g. one tile), this keeps the per-vertex data
+	// proportional to the part.
+	std::unordered_map<GLuint, GLuint> toLocal;
+	toLocal.reserve( aIndices.size() / 2 );
+
+	std::vector<GLuint> toGlobal;
+	std::vector<Vec3f> positions;
+	std::vector<GLuint> indices( aIndices.size() );
+
+	for( std::size_t i = 0; i < aIndices.size(); ++i )
+	{
+		auto const [it, inserted] = toLocal.emplace( aIndices[i], GLuint(toGlobal.size()) );
+		if( inserted )
+		{
+			toGlobal.emplace_back( aIndices[i] );
+			positions.emplace_back( aPositions[aIndices[i]] );
+		}
+		indices[i] = it->second;
+	}
+
+	auto ret = simplify_compact_( indices, positions, aTargetIndexCount, aMaxError );
+	for( auto& idx : ret.indices )
+		idx = toGlobal[idx];
+
+	return ret;
+}
+
+std::vector<MeshLod> append_lod_chain( std::vector<GLuint>& aIndices, MeshLod const& aBase, std::span<Vec3f const> aPositions, std::size_t aMaxLevels, float aReduction )
+{
+	// Stop once a level removes less than this fraction of the triangles
+	constexpr float kMinReduction = 0.2f;
+
+	std::vector<MeshLod> lods;
+
+	std::vector<GLuint> previous( aIndices.begin() + aBase.firstIndex, aIndices.begin() + aBase.firstIndex + aBase.indexCount );
+	float error = aBase.error;
+
+	while( lods.size()+1 < aMaxLevels )
+	{
+		auto const target = std::size_t(float(previous.size() / 3) * aReduction) * 3;
+		auto result = simplify_mesh( previous, aPositions, target, std::numeric_limits<float>::max() );
+
+		if( result.indices.empty() || float(result.indices.size()) > float(previous.size()) * (1.f - kMinReduction) )
+			break;
+
+		optimize_vertex_cache( result.indices, aPositions.size() );
+
+		error += result.error;
+		lods.emplace_back( MeshLod{ GLuint(aIndices.size()), GLuint(result.indices.size()), error } );
+		aIndices.insert( aIndices.end(), result.indices.begin(), result.indices.end() );
+
+		previous = std::move(result.indices);
+	}
+
+	return lods;
+}
+
+std::size_t build_lod_chain( SimpleMeshData& aMesh, std::size_t aMaxLevels, float aReduction )
+{
+	assert( !aMesh.indices.empty() );
+	assert( aMesh.lods.empty() );
+
+	aMesh.lods.emplace_back( MeshLod{ 0, GLuint(aMesh.indices.size()), 0.f } );
+
+	auto const levels = append_lod_chain( aMesh.indices, aMesh.lods[0], aMesh.positions, aMaxLevels, aReduction );
+	aMesh.lods.insert( aMesh.lods.end(), levels.begin(), levels.end() );
+
+	return aMesh.lods.size();
+}
+
+std::size_t select_lod( std::span<MeshLod const> aLods, float aDistance, float aPixelsPerUnit, float aMaxPixelError )
+{
+	auto const distance = std::max( aDistance, 1e-4f );
+
+	for( std::size_t i = aLods.size(); i > 1; --i )
+	{
+		if( aLods[i-1].error * aPixelsPerUnit <= aMaxPixelError * distance )
+			return i-1;
+	}
+
+	return 0;
+}
+
+float pixels_per_unit( float aFovY, float aViewportHeight ) noexcept
+{
+	return aViewportHeight / (2.f * std::tan( 0.5f * aFovY ));
+}
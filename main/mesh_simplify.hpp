@@ -0,0 +1,83 @@
+#ifndef MESH_SIMPLIFY_HPP_3BCF1C0A_2941_4DB1_BEFE_4D4C8C0AAB3C
+#define MESH_SIMPLIFY_HPP_3BCF1C0A_2941_4DB1_BEFE_4D4C8C0AAB3C
+
+#include <span>
+#include <vector>
+
+#include <cstddef>
+
+#include "simple_mesh.hpp"
+
+/* Mesh simplification and levels of detail
+ *
+ * simplify_mesh() reduces the number of triangles by quadric error edge
+ * collapse ("Surface Simplification Using Quadric Error Metrics", Garland &
+ * Heckbert, 1997). Vertices are only ever collapsed onto existing vertices,
+ * so the result is a new index list over the unchanged vertex arrays; all
+ * attributes, including texture coordinates, keep their original values.
+ *
+ * Vertices with the same position but different attributes (e.g. along UV
+ * seams) are collapsed together, each onto the matching vertex on its side of
+ * the seam, so seams stay intact. A collapse is rejected if this is not
+ * possible. Vertices on open borders or non-manifold edges are locked, as are
+ * collapses that would flip a triangle.
+ *
+ * The reported error is the largest error of any collapse: the RMS distance
+ * (in model units) from the removed vertex to the planes of the triangles it
+ * represents.
+ */
+struct SimplifyResult
+{
+	std::vector<GLuint> indices;
+	float error;
+};
+
+SimplifyResult simplify_mesh(
+	std::span<GLuint const> aIndices,
+	std::span<Vec3f const> aPositions,
+	std::size_t aTargetIndexCount,
+	float aMaxError
+);
+
+/* Appends up to aMaxLevels-1 levels of detail to the mesh (level 0 is the
+ * existing index list). Each level targets aReduction times the triangles of
+ * the previous one; generation stops early once simplification is no longer
+ * effective. Each level is ordered for the vertex cache. Returns the number
+ * of levels, including level 0.
+ *
+ * MeshLod::error accumulates, i.e., it bounds the error relative to level 0.
+ */
+std::size_t build_lod_chain(
+	SimpleMeshData&,
+	std::size_t aMaxLevels = 5,
+	float aReduction = 0.5f
+);
+
+// Like build_lod_chain(), but for the triangles in the range aBase of
+// aIndices. Appends the new levels to aIndices and returns them (without
+// aBase).
+std::vector<MeshLod> append_lod_chain(
+	std::vector<GLuint>& aIndices,
+	MeshLod const& aBase,
+	std::span<Vec3f const> aPositions,
+	std::size_t aMaxLevels = 5,
+	float aReduction = 0.5f
+);
+
+/* Select the coarsest level whose error, projected to the screen, is at most
+ * aMaxPixelError pixels.
+ *
+ * aDistance is the distance from the camera to the (closest point of the)
+ * object. aPixelsPerUnit is the size in pixels of one unit at distance one,
+ * i.e., viewportHeight / (2 tan(fovY/2)); see pixels_per_unit().
+ */
+std::size_t select_lod(
+	std::span<MeshLod const>,
+	float aDistance,
+	float aPixelsPerUnit,
+	float aMaxPixelError
+);
+
+float pixels_per_unit( float aFovY, float aViewportHeight ) noexcept;
+
+#endif // MESH_SIMPLIFY_HPP_3BCF1C0A_2941_4DB1_BEFE_4D4C8C0AAB3C
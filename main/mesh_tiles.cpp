@@ -0,0 +1,149 @@
+#include "mesh_tiles.hpp"
+
+#include <vector>
+#include <algorithm>
+
+#include <cassert>
+#include <cstdint>
+
+#include "../support/error.hpp"
+
+#include "mesh_optimize.hpp"
+#include "mesh_simplify.hpp"
+
+namespace
+{
+	// A tile while it is being built. Index ranges in lods refer to indices.
+	struct TileBuild_
+	{
+		AABB bounds;
+
+		std::vector<GLuint> indices;
+		std::vector<MeshLod> lods;
+	};
+
+	// Sorts the triangles by tile, keeping their relative order within each
+	// tile. Returns the index (into aIndices) at which each tile starts, plus
+	// the end of the last tile.
+	std::vector<std::size_t> sort_by_tile_( std::vector<GLuint>& aIndices, std::span<Vec3f const> aPositions, unsigned aTilesX, unsigned aTilesZ )
+	{
+		auto const bounds = make_aabb( aPositions );
+		auto const scaleX = float(aTilesX) / std::max( bounds.max.x - bounds.min.x, 1e-6f );
+		auto const scaleZ = float(aTilesZ) / std::max( bounds.max.z - bounds.min.z, 1e-6f );
+
+		auto const triangleCount = aIndices.size() / 3;
+
+		std::vector<std::uint32_t> tileOf( triangleCount );
+		std::vector<std::size_t> starts( std::size_t(aTilesX)*aTilesZ + 1, 0 );
+		for( std::size_t t = 0; t < triangleCount; ++t )
+		{
+			auto const c = (aPositions[aIndices[3*t+0]] + aPositions[aIndices[3*t+1]] + aPositions[aIndices[3*t+2]]) / 3.f;
+
+			auto const x = std::min( unsigned(std::max( (c.x - bounds.min.x) * scaleX, 0.f )), aTilesX-1 );
+			auto const z = std::min( unsigned(std::max( (c.z - bounds.min.z) * scaleZ, 0.f )), aTilesZ-1 );
+
+			tileOf[t] = z * aTilesX + x;
+			starts[tileOf[t]+1] += 3;
+		}
+
+		for( std::size_t i = 1; i < starts.size(); ++i )
+			starts[i] += starts[i-1];
+
+		std::vector<GLuint> sorted( aIndices.size() );
+		auto next = starts;
+		for( std::size_t t = 0; t < triangleCount; ++t )
+		{
+			auto& out = next[tileOf[t]];
+			sorted[out+0] = aIndices[3*t+0];
+			sorted[out+1] = aIndices[3*t+1];
+			sorted[out+2] = aIndices[3*t+2];
+			out += 3;
+		}
+
+		aIndices = std::move(sorted);
+		return starts;
+	}
+}
+
+std::size_t tile_mesh( SimpleMeshData& aMesh, unsigned aTilesX, unsigned aTilesZ, std::size_t aLodLevels )
+{
+	assert( !aMesh.indices.empty() );
+	assert( aMesh.lods.empty() && aMesh.tiles.empty() );
+	assert( aTilesX > 0 && aTilesZ > 0 );
+
+	// MeshTile has room for kMaxTileLods levels
+	if( 0 == aLodLevels || aLodLevels > kMaxTileLods )
+		throw Error( "Unable to tile mesh: %zu levels of detail requested, must be 1 to %zu", aLodLevels, kMaxTileLods );
+
+	auto const starts = sort_by_tile_( aMesh.indices, aMesh.positions, aTilesX, aTilesZ );
+
+	// Tiles are now contiguous, so first-use order keeps each tile's vertices
+	// together (apart from those on tile borders).
+	optimize_vertex_fetch( aMesh );
+
+	std::vector<TileBuild_> tiles;
+	for( std::size_t i = 0; i+1 < starts.size(); ++i )
+	{
+		if( starts[i] == starts[i+1] )
+			continue;
+
+		auto& tile = tiles.emplace_back();
+		tile.indices.assign( aMesh.indices.begin() + starts[i], aMesh.indices.begin() + starts[i+1] );
+
+		tile.bounds = kEmptyAABB;
+		for( auto const idx : tile.indices )
+			tile.bounds = expand( tile.bounds, aMesh.positions[idx] );
+
+		// Simplified levels only use a subset of the vertices, so the bounds
+		// hold for all of them.
+		tile.lods.emplace_back( MeshLod{ 0, GLuint(tile.indices.size()), 0.f } );
+
+		auto const levels = append_lod_chain( tile.indices, tile.lods[0], aMesh.positions, aLodLevels );
+		tile.lods.insert( tile.lods.end(), levels.begin(), levels.end() );
+	}
+
+	// Lay out the index array by level (see header)
+	std::size_t levelCount = 0, indexCount = 0;
+	for( auto const& tile : tiles )
+	{
+		levelCount = std::max( levelCount, tile.lods.size() );
+		indexCount += tile.indices.size();
+	}
+
+	aMesh.indices.clear();
+	aMesh.indices.reserve( indexCount );
+
+	aMesh.tiles.resize( tiles.size(), MeshTile{} );
+	for( std::size_t level = 0; level < levelCount; ++level )
+	{
+		auto const levelStart = GLuint(aMesh.indices.size());
+
+		bool complete = true;
+		float error = 0.f;
+		for( std::size_t i = 0; i < tiles.size(); ++i )
+		{
+			auto const& src = tiles[i];
+			if( level >= src.lods.size() )
+			{
+				complete = false;
+				continue;
+			}
+
+			auto const& lod = src.lods[level];
+			auto& dst = aMesh.tiles[i];
+			dst.bounds = src.bounds;
+			dst.lodCount = GLuint(level+1);
+			dst.lods[level] = MeshLod{ GLuint(aMesh.indices.size()), lod.indexCount, lod.error };
+
+			aMesh.indices.insert( aMesh.indices.end(), src.indices.begin() + lod.firstIndex, src.indices.begin() + lod.firstIndex + lod.indexCount );
+
+			error = std::max( error, lod.error );
+		}
+
+		// Mesh-wide levels must be consecutive
+		if( complete && aMesh.lods.size() == level )
+			aMesh.lods.emplace_back( MeshLod{ levelStart, GLuint(aMesh.indices.size()) - levelStart, error } );
+	}
+
+	return aMesh.tiles.size();
+}
@@ -0,0 +1,38 @@
+#ifndef MESH_TILES_HPP_9C79A878_1CA3_41DE_8146_53A7DFBDFC5E
+#define MESH_TILES_HPP_9C79A878_1CA3_41DE_8146_53A7DFBDFC5E
+
+#include <cstddef>
+
+#include "simple_mesh.hpp"
+
+/* Spatial tiling
+ *
+ * tile_mesh() splits an indexed mesh into a regular grid of aTilesX by aTilesZ
+ * tiles in the XZ plane (i.e., it is meant for terrain-like meshes). Each
+ * triangle is assigned to the tile that contains its centroid. Tiles without
+ * triangles are dropped.
+ *
+ * All tiles share the mesh's vertex and index buffers. Each tile gets its own
+ * bounding box and up to aLodLevels levels of detail (see build_lod_chain()),
+ * so tiles can be culled and their level of detail selected individually.
+ * Vertices on tile borders are never removed by simplification, so adjacent
+ * tiles at different levels of detail still meet without cracks.
+ *
+ * The index array is laid out by level: the full-detail triangles of all
+ * tiles come first, followed by the first simplified level of all tiles, and
+ * so on. The mesh's own levels of detail (SimpleMeshData::lods) are the
+ * ranges that cover every tile at the same level; lods[0] is the whole
+ * full-detail mesh.
+ *
+ * The mesh must not have levels of detail yet. Run optimize_mesh() first; the
+ * triangle order within each tile is kept. Returns the number of tiles.
+ * Throws Error if aLodLevels is zero or greater than kMaxTileLods.
+ */
+std::size_t tile_mesh(
+	SimpleMeshData&,
+	unsigned aTilesX,
+	unsigned aTilesZ,
+	std::size_t aLodLevels = 5
+);
+
+#endif // MESH_TILES_HPP_9C79A878_1CA3_41DE_8146_53A7DFBDFC5E
@@ -0,0 +1,162 @@
+#include "multiview.hpp"
+
+#include <bit>
+#include <utility>
+#include <string_view>
+
+#include <cassert>
+#include <cstdint>
+
+#include "../vmlib/frustum.hpp"
+
+namespace
+{
+	constexpr GLuint kViewIndexAttribute_ = 4;
+
+	bool has_extension_( std::string_view aName )
+	{
+		GLint count = 0;
+		glGetIntegerv( GL_NUM_EXTENSIONS, &count );
+
+		for( GLint i = 0; i < count; ++i )
+		{
+			auto const* ext = reinterpret_cast<char const*>(glGetStringi( GL_EXTENSIONS, GLuint(i) ));
+			if( ext && aName == ext )
+				return true;
+		}
+
+		return false;
+	}
+}
+
+EMultiviewMode detect_multiview_mode()
+{
+	GLint maxViewports = 0;
+	glGetIntegerv( GL_MAX_VIEWPORTS, &maxViewports );
+	if( maxViewports < GLint(kMaxViews) )
+		return EMultiviewMode::ePerView;
+
+	if( has_extension_( "GL_ARB_shader_viewport_layer_array" ) || has_extension_( "GL_AMD_vertex_shader_viewport_index" ) )
+		return EMultiviewMode::eSinglePass;
+
+	return EMultiviewMode::ePerView;
+}
+
+std::vector<std::string> multiview_shader_defines( EMultiviewMode aMode )
+{
+	std::vector<std::string> defines;
+
+	if( EMultiviewMode::eSinglePass == aMode )
+	{
+		if( has_extension_( "GL_ARB_shader_viewport_layer_array" ) )
+			defines.emplace_back( "VIEWPORT_INDEX_ARB" );
+		else
+			defines.emplace_back( "VIEWPORT_INDEX_AMD" );
+	}
+
+	return defines;
+}
+
+std::array<GLfloat, 4> split_viewport( std::size_t aIndex, std::size_t aCount, float aWidth, float aHeight ) noexcept
+{
+	assert( aIndex < aCount && aCount <= kMaxViews );
+
+	if( aCount <= 2 )
+	{
+		auto const w = aWidth / float(aCount);
+		return { w * float(aIndex), 0.f, w, aHeight };
+	}
+
+	auto const w = 0.5f * aWidth, h = 0.5f * aHeight;
+	auto const column = float(aIndex % 2), row = float(aIndex / 2);
+	return { w * column, h * (1.f - row), w, h };
+}
+
+Vec3f view_forward( ViewSetup const& aView ) noexcept
+{
+	auto const& u = aView.up;
+	auto const& r = aView.right;
+	return { u.y*r.z - u.z*r.y, u.z*r.x - u.x*r.z, u.x*r.y - u.y*r.x };
+}
+
+std::pair<GLuint,GLsizei> view_range( ViewMask aMask ) noexcept
+{
+	assert( 0 != aMask );
+	auto const first = std::countr_zero( aMask );
+	auto const last = 31 - std::countl_zero( aMask );
+	return { GLuint(first), GLsizei(last - first + 1) };
+}
+
+ViewMask visible_views( std::span<ViewSetup const> aViews, Mat44f const& aModel2World, AABB const& aBounds )
+{
+	ViewMask mask = 0;
+	for( std::size_t i = 0; i < aViews.size(); ++i )
+	{
+		if( intersects( make_frustum( aViews[i].projView * aModel2World ), aBounds ) )
+			mask |= ViewMask(1) << i;
+	}
+	return mask;
+}
+
+ViewMask visible_views( std::span<ViewSetup const> aViews, BoundingSphere const& aSphere )
+{
+	ViewMask mask = 0;
+	for( std::size_t i = 0; i < aViews.size(); ++i )
+	{
+		if( intersects( make_frustum( aViews[i].projView ), aSphere ) )
+			mask |= ViewMask(1) << i;
+	}
+	return mask;
+}
+
+DrawElementsIndirectCommand make_indirect_command( GLuint aCount, GLuint aFirstIndex, ViewMask aMask ) noexcept
+{
+	auto const [first, count] = view_range( aMask );
+	return DrawElementsIndirectCommand{ aCount, GLuint(count), aFirstIndex, 0, first };
+}
+
+MultiviewBuffers::MultiviewBuffers() noexcept
+	: mViewIndices( 0 )
+{}
+
+MultiviewBuffers::~MultiviewBuffers()
+{
+	if( 0 != mViewIndices )
+		glDeleteBuffers( 1, &mViewIndices );
+}
+
+MultiviewBuffers::MultiviewBuffers( MultiviewBuffers&& aOther ) noexcept
+	: mViewIndices( std::exchange( aOther.mViewIndices, 0 ) )
+{}
+MultiviewBuffers& MultiviewBuffers::operator= (MultiviewBuffers&& aOther) noexcept
+{
+	std::swap( mViewIndices, aOther.mViewIndices );
+	return *this;
+}
+
+void MultiviewBuffers::attach( GLuint aVao ) const
+{
+	glBindVertexArray( aVao );
+	glBindBuffer( GL_ARRAY_BUFFER, mViewIndices );
+	glEnableVertexAttribArray( kViewIndexAttribute_ );
+	glVertexAttribIPointer( kViewIndexAttribute_, 1, GL_UNSIGNED_INT, 0, nullptr );
+	glVertexAttribDivisor( kViewIndexAttribute_, 1 );
+	glBindVertexArray( 0 );
+	glBindBuffer( GL_ARRAY_BUFFER, 0 );
+}
+
+MultiviewBuffers create_multiview_buffers()
+{
+	MultiviewBuffers ret;
+
+	GLuint viewIndices[kMaxViews];
+	for( std::size_t i = 0; i < kMaxViews; ++i )
+		viewIndices[i] = GLuint(i);
+
+	glGenBuffers( 1, &ret.mViewIndices );
+	glBindBuffer( GL_ARRAY_BUFFER, ret.mViewIndices );
+	glBufferData( GL_ARRAY_BUFFER, sizeof(viewIndices), viewIndices, GL_STATIC_DRAW );
+	glBindBuffer( GL_ARRAY_BUFFER, 0 );
+
+	return ret;
+}
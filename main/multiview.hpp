@@ -0,0 +1,128 @@
+#ifndef MULTIVIEW_HPP_B0D9DC54_42D1_474F_88A3_0BA442D27488
+#define MULTIVIEW_HPP_B0D9DC54_42D1_474F_88A3_0BA442D27488
+
+#include <glad/glad.h>
+
+#include <span>
+#include <array>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../vmlib/vec3.hpp"
+#include "../vmlib/mat44.hpp"
+#include "../vmlib/aabb.hpp"
+#include "../vmlib/sphere.hpp"
+
+/* Multi-view rendering
+ *
+ * Renders the scene into up to kMaxViews viewports (split-screen). Every draw
+ * is instanced, one instance per view. The view index comes from a
+ * per-instance vertex attribute (location 4, see MultiviewBuffers::attach()),
+ * so that the base instance selects the first view. Shaders pick the view's
+ * camera from the per-view arrays in the FrameUniforms block (see
+ * frame_uniforms.hpp). Draws that aren't instanced get view 0. Particles,
+ * which are instanced already, are drawn once per view instead, with the
+ * view index in a uniform.
+ *
+ * With eSinglePass, the vertex shader also routes each instance to its
+ * viewport via gl_ViewportIndex (ARB_shader_viewport_layer_array or
+ * AMD_vertex_shader_viewport_index). All views are then drawn with a single
+ * submission of the scene, after setting the viewports with
+ * glViewportArrayv(). Without either extension (ePerView), the scene is
+ * submitted once per view with a regular glViewport(), and each draw only
+ * instances that view.
+ */
+inline constexpr std::size_t kMaxViews = 4;
+
+enum class EMultiviewMode
+{
+	eSinglePass,
+	ePerView
+};
+
+// Bit i is set if view i is included
+using ViewMask = std::uint32_t;
+
+struct ViewSetup
+{
+	Mat44f projView;
+
+	// Camera in world space
+	Vec3f position;
+	Vec3f right;
+	Vec3f up;
+
+	// x, y, width, height (as glViewportArrayv() expects)
+	std::array<GLfloat, 4> viewport;
+};
+
+// Matches the layout that glMultiDrawElementsIndirect() expects.
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+// Requires a current OpenGL context.
+EMultiviewMode detect_multiview_mode();
+
+// Shader defines for the mode: VIEWPORT_INDEX_ARB or VIEWPORT_INDEX_AMD with
+// eSinglePass, none otherwise.
+std::vector<std::string> multiview_shader_defines( EMultiviewMode );
+
+// Viewport of view aIndex when a aWidth x aHeight framebuffer is split into
+// aCount views: one or two views are placed side by side, three or four in a
+// 2x2 grid (top left, top right, bottom left, bottom right).
+std::array<GLfloat, 4> split_viewport( std::size_t aIndex, std::size_t aCount, float aWidth, float aHeight ) noexcept;
+
+// Direction that the camera of the view looks in (up x right)
+Vec3f view_forward( ViewSetup const& ) noexcept;
+
+// First view and number of views from the lowest to the highest view in
+// aMask, which must not be zero.
+std::pair<GLuint,GLsizei> view_range( ViewMask aMask ) noexcept;
+
+// Views in which the box (in model space) is (potentially) visible
+ViewMask visible_views( std::span<ViewSetup const>, Mat44f const& aModel2World, AABB const& );
+
+// Views in which the sphere (in world space) is (potentially) visible
+ViewMask visible_views( std::span<ViewSetup const>, BoundingSphere const& );
+
+// Command that draws the views in aMask, which must not be zero. Instances
+// cover the range from the lowest to the highest view in aMask; views in
+// between that aren't in the mask are clipped on the GPU.
+DrawElementsIndirectCommand make_indirect_command( GLuint aCount, GLuint aFirstIndex, ViewMask aMask ) noexcept;
+
+// Owns the per-instance view index buffer. Move-only.
+class MultiviewBuffers final
+{
+	public:
+		MultiviewBuffers() noexcept;
+		~MultiviewBuffers();
+
+		MultiviewBuffers( MultiviewBuffers const& ) = delete;
+		MultiviewBuffers& operator= (MultiviewBuffers const&) = delete;
+
+		MultiviewBuffers( MultiviewBuffers&& ) noexcept;
+		MultiviewBuffers& operator= (MultiviewBuffers&&) noexcept;
+
+	public:
+		// Adds the per-instance view index attribute to the VAO.
+		void attach( GLuint aVao ) const;
+
+	private:
+		friend MultiviewBuffers create_multiview_buffers();
+
+		GLuint mViewIndices;
+};
+
+MultiviewBuffers create_multiview_buffers();
+
+#endif // MULTIVIEW_HPP_B0D9DC54_42D1_474F_88A3_0BA442D27488
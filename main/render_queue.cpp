@@ -0,0 +1,103 @@
+#include "render_queue.hpp"
+
+#include <algorithm>
+
+#include <cstring>
+
+#include "frame_uniforms.hpp"
+
+std::uint64_t make_sort_key( GLuint aProgram, GLuint aTexture, GLuint aVao, float aDepth ) noexcept
+{
+	auto const depth = std::uint64_t(std::clamp( aDepth, 0.f, 1.f ) * 65535.f + 0.5f);
+
+	return (std::uint64_t(aProgram & 0xffff) << 48)
+		| (std::uint64_t(aTexture & 0xffff) << 32)
+		| (std::uint64_t(aVao & 0xffff) << 16)
+		| depth;
+}
+
+void RenderQueue::submit( std::uint64_t aKey, GLuint aProgram, GLuint aTexture, GLuint aVao, StreamBuffer const& aUniforms, StreamBuffer::Allocation const& aObject, std::span<DrawElementsIndirectCommand const> aCommands )
+{
+	if( aCommands.empty() )
+		return;
+
+	mPackets.emplace_back( DrawPacket{
+		aKey,
+		aProgram, aTexture, aVao,
+		&aUniforms, aObject,
+		std::uint32_t(mCommands.size()), std::uint32_t(aCommands.size())
+	} );
+	mCommands.insert( mCommands.end(), aCommands.begin(), aCommands.end() );
+}
+
+void RenderQueue::execute( StreamBuffer& aStream, RenderQueueStats& aStats )
+{
+	if( mPackets.empty() )
+		return;
+
+	// Immediate submission binds everything, every draw
+	for( auto const& packet : mPackets )
+		aStats.unsortedStateChanges += 0 != packet.texture ? 4 : 3;
+
+	// Stable, so that packets with equal keys keep their submission order
+	std::stable_sort( mPackets.begin(), mPackets.end(), [] (DrawPacket const& aX, DrawPacket const& aY) {
+		return aX.key < aY.key;
+	} );
+
+	// All commands in one allocation from the stream buffer
+	auto const bytes = mCommands.size() * sizeof(DrawElementsIndirectCommand);
+	auto const commands = aStream.allocate( bytes, alignof(DrawElementsIndirectCommand) );
+	std::memcpy( commands.data, mCommands.data(), bytes );
+
+	glBindBuffer( GL_DRAW_INDIRECT_BUFFER, aStream.buffer() );
+
+	for( auto const& command : mCommands )
+		aStats.triangles += std::uint64_t(command.count / 3) * command.instanceCount;
+
+	// Currently bound state; nothing is assumed to be bound at first
+	GLuint program = 0, texture = 0, vao = 0;
+	StreamBuffer const* uniforms = nullptr;
+	GLintptr objectOffset = -1;
+
+	for( auto const& packet : mPackets )
+	{
+		if( packet.program != program )
+		{
+			glUseProgram( program = packet.program );
+			++aStats.stateChanges;
+		}
+		// Packets without a texture keep whatever is bound
+		if( 0 != packet.texture && packet.texture != texture )
+		{
+			glActiveTexture( GL_TEXTURE0 );
+			glBindTexture( GL_TEXTURE_2D, texture = packet.texture );
+			++aStats.stateChanges;
+		}
+		if( packet.vao != vao )
+		{
+			glBindVertexArray( vao = packet.vao );
+			++aStats.stateChanges;
+		}
+		if( packet.uniforms != uniforms || packet.object.offset != objectOffset )
+		{
+			uniforms = packet.uniforms;
+			objectOffset = packet.object.offset;
+			uniforms->bind_range( GL_UNIFORM_BUFFER, kObjectUniformsBinding, packet.object );
+			++aStats.stateChanges;
+		}
+
+		auto const offset = std::uintptr_t(commands.offset) + std::uintptr_t(packet.firstCommand) * sizeof(DrawElementsIndirectCommand);
+		glMultiDrawElementsIndirect( GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<void const*>(offset), GLsizei(packet.commandCount), 0 );
+		++aStats.drawCalls;
+	}
+
+	aStats.packets += unsigned(mPackets.size());
+
+	glBindBuffer( GL_DRAW_INDIRECT_BUFFER, 0 );
+	glBindVertexArray( 0 );
+	glBindTexture( GL_TEXTURE_2D, 0 );
+	glUseProgram( 0 );
+
+	mPackets.clear();
+	mCommands.clear();
+}
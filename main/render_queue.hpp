@@ -0,0 +1,94 @@
+#ifndef RENDER_QUEUE_HPP_3E58A0C2_9D41_4B7F_A6E3_5C2F17D94B08
+#define RENDER_QUEUE_HPP_3E58A0C2_9D41_4B7F_A6E3_5C2F17D94B08
+
+#include <glad/glad.h>
+
+#include <span>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "multiview.hpp"
+#include "stream_buffer.hpp"
+
+/* Render queue
+ *
+ * Opaque draws are submitted as packets instead of being issued straight
+ * away. execute() sorts the packets by their 64-bit keys (see make_sort_key())
+ * and draws them in that order:
+ *
+ *   bits 48-63  program
+ *   bits 32-47  texture
+ *   bits 16-31  VAO
+ *   bits  0-15  depth, front to back
+ *
+ * Packets that share a program, texture or VAO are thus drawn back to back,
+ * and state is only changed when it differs from the previous packet's. Only
+ * the low 16 bits of each GL name go into the key; colliding names just sort
+ * next to each other, since execution compares the full names.
+ *
+ * A packet draws a list of DrawElementsIndirectCommand (multiview.hpp), e.g.
+ * the visible tiles of the terrain, with a single glMultiDrawElementsIndirect().
+ * execute() writes the commands of all packets into the frame's stream
+ * buffer at once and draws them from there.
+ *
+ * Transparent geometry (particles) isn't queued; it needs blending and its
+ * own back-to-front order, and is drawn after the queue.
+ */
+
+// Depth as a fraction of the far plane distance, in [0, 1]
+std::uint64_t make_sort_key( GLuint aProgram, GLuint aTexture, GLuint aVao, float aDepth ) noexcept;
+
+struct DrawPacket
+{
+	std::uint64_t key;
+
+	GLuint program;
+	GLuint texture; // bound to unit 0; zero if the program samples none
+	GLuint vao;
+
+	// Per-object uniform block (see frame_uniforms.hpp)
+	StreamBuffer const* uniforms;
+	StreamBuffer::Allocation object;
+
+	// Range of the queue's commands
+	std::uint32_t firstCommand;
+	std::uint32_t commandCount;
+};
+
+// Per frame, before and after sorting
+struct RenderQueueStats
+{
+	unsigned packets = 0;
+	unsigned drawCalls = 0;
+	std::uint64_t triangles = 0; // over all views
+
+	// Programs, textures, VAOs and uniform blocks bound by execute()
+	unsigned stateChanges = 0;
+
+	// State bound if each packet set all of its state in submission order,
+	// as immediate draws do
+	unsigned unsortedStateChanges = 0;
+};
+
+// The packet and command arrays are kept between frames, so that queueing
+// the same number of draws every frame doesn't allocate.
+class RenderQueue final
+{
+	public:
+		// Queues a draw of aCommands; nothing is queued if aCommands is
+		// empty. The commands are copied.
+		void submit( std::uint64_t aKey, GLuint aProgram, GLuint aTexture, GLuint aVao, StreamBuffer const& aUniforms, StreamBuffer::Allocation const& aObject, std::span<DrawElementsIndirectCommand const> aCommands );
+
+		// Sorts and draws the queued packets, then empties the queue. The
+		// commands are allocated from aStream's current region. Adds to
+		// aStats. Leaves no program, texture or VAO bound.
+		void execute( StreamBuffer& aStream, RenderQueueStats& aStats );
+
+	private:
+		std::vector<DrawPacket> mPackets;
+		std::vector<DrawElementsIndirectCommand> mCommands;
+};
+
+#endif // RENDER_QUEUE_HPP_3E58A0C2_9D41_4B7F_A6E3_5C2F17D94B08
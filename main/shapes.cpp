@@ -2,16 +2,22 @@
 
 #include <numbers>
 
+#include "../vmlib/transform.hpp"
+
 // Derived from exercise 4 - authors @Mayur Shankar and @Jose Vaz
 SimpleMeshData make_cylinder( bool aCapped, std::size_t aSubdivs, Vec3f aColor, Mat44f aPreTransform )
 {
   	std::vector< Vec3f > pos;
     std::vector< Vec3f > normal;
+
+    pos.reserve(aSubdivs * 6 + (aCapped ? aSubdivs * 6 : 0));
+    normal.reserve(pos.capacity());
+
     float prevY = std::cos(0.f);
     float prevZ = std::sin(0.f);
 
     // Pre-compute normal
-    Mat33f const N = mat44_to_mat33 ( transpose (invert ( aPreTransform ) ) );
+    Mat33f const N = normal_matrix( aPreTransform );
 
     // aSubDivs refers to how many segments the cylinder contains
     for (std::size_t i = 0; i < aSubdivs; ++i) {
@@ -81,20 +87,9 @@ SimpleMeshData make_cylinder( bool aCapped, std::size_t aSubdivs, Vec3f aColor,
         }
     }
 
-    // Apply transformation
-    for (auto& p : pos) {
-        Vec4f p4{p.x, p.y, p.z, 1.f};
-        Vec4f t = aPreTransform * p4;
-        t /= t.w;
-
-        p = Vec3f{t.x, t.y, t.z};
-    }
-
-    // Apply normals
-    for (auto& n : normal) {
-      Vec3f z = N * n;
-      n = Vec3f{ z.x, z.y, z.z };
-    }
+    // Apply transformation and normals
+    transform_positions(pos, aPreTransform);
+    transform_normals(normal, N);
 
     // Use inputted colour
     std::vector col (pos.size(), aColor);
@@ -110,9 +105,10 @@ SimpleMeshData make_cone(bool aCapped, std::size_t aSubdivs, Vec3f aColor, Mat44
     std::vector< Vec3f > normal;
 
     pos.reserve(aSubdivs * 3 + (aCapped ? aSubdivs * 3 : 0));
+    normal.reserve(pos.capacity());
 
     // Pre-compute normal
-    Mat33f const N = mat44_to_mat33 ( transpose (invert ( aPreTransform ) ) );
+    Mat33f const N = normal_matrix( aPreTransform );
 
     // Apex of the cone
     Vec3f apex = { 1.f, 0.f, 0.f };
@@ -157,20 +153,9 @@ SimpleMeshData make_cone(bool aCapped, std::size_t aSubdivs, Vec3f aColor, Mat44
         prevZ = z;
     }
 
-    // Apply transformation
-    for (auto& p : pos)
-    {
-        Vec4f p4{ p.x, p.y, p.z, 1.f };
-        Vec4f t = aPreTransform * p4;
-        t /= t.w;
-        p = Vec3f{ t.x, t.y, t.z };
-    }
-
-    // Apply normals
-    for (auto& n: normal) {
-      Vec3f z = N * n;
-      n = Vec3f{ z.x, z.y, z.z };
-	}
+    // Apply transformation and normals
+    transform_positions(pos, aPreTransform);
+    transform_normals(normal, N);
 
     // Use inputted colour
     std::vector<Vec3f> colors (pos.size(), aColor);
@@ -185,7 +170,7 @@ SimpleMeshData make_cube(bool aCapped, std::size_t aSubdivs, Vec3f aColor, Mat44
     std::vector<Vec3f> normal;
 
     // Pre-compute normal
-    Mat33f const N = mat44_to_mat33 ( transpose (invert ( aPreTransform ) ) );
+    Mat33f const N = normal_matrix( aPreTransform );
 
     // 36 vertices - 6 * 6 since each face is made up of two triangles
     for (std::size_t i = 0; i < 36; i++)
@@ -197,20 +182,9 @@ SimpleMeshData make_cube(bool aCapped, std::size_t aSubdivs, Vec3f aColor, Mat44
         normal.push_back(Vec3f{kCubePositions[i*3], kCubePositions[i*3+1], kCubePositions[i*3+2]});
     }
 
-    // Apply the pre-transform
-    for (auto& p : pos)
-    {
-        Vec4f p4{ p.x, p.y, p.z, 1.f };
-        Vec4f t = aPreTransform * p4;
-        t /= t.w;
-        p = Vec3f{ t.x, t.y, t.z };
-    }
-
-    // Apply normal
-    for (auto& n: normal) {
-      Vec3f z = N * n;
-      n = Vec3f{ z.x, z.y, z.z };
-	}
+    // Apply the pre-transform and normal
+    transform_positions(pos, aPreTransform);
+    transform_normals(normal, N);
 
     // Use inputted colour
     std::vector<Vec3f> colors (pos.size(), aColor);
@@ -219,31 +193,23 @@ SimpleMeshData make_cube(bool aCapped, std::size_t aSubdivs, Vec3f aColor, Mat44
 }
 
 // Author @Jose Vaz
-SimpleMeshData make_particle_quad(const std::vector<Vec3f>& particleCenters, const Vec3f& camRight, const Vec3f& camUp, float size)
+SimpleMeshData make_particle_quad()
 {
     SimpleMeshData mesh;
-    for (const auto& centre : particleCenters)
-    {
-        Vec3f right = camRight * size;
-        Vec3f up = camUp * size;
-
-        // First triangle
-        mesh.positions.emplace_back(centre - right - up);
-        mesh.positions.emplace_back(centre + right - up);
-        mesh.positions.emplace_back(centre + right + up);
-
-        mesh.texcoords.emplace_back(Vec2f{ 0.f, 0.f });
-        mesh.texcoords.emplace_back(Vec2f{ 1.f, 0.f });
-        mesh.texcoords.emplace_back(Vec2f{ 1.f, 1.f });
-
-        // Second triangle
-        mesh.positions.emplace_back(centre - right - up);
-        mesh.positions.emplace_back(centre + right + up);
-        mesh.positions.emplace_back(centre - right + up);
-
-        mesh.texcoords.emplace_back(Vec2f{ 0.f, 0.f });
-        mesh.texcoords.emplace_back(Vec2f{ 1.f, 1.f });
-        mesh.texcoords.emplace_back(Vec2f{ 0.f, 1.f });
-    }
+    mesh.positions = {
+        Vec3f{ -1.f, -1.f, 0.f },
+        Vec3f{ +1.f, -1.f, 0.f },
+        Vec3f{ +1.f, +1.f, 0.f },
+        Vec3f{ -1.f, +1.f, 0.f }
+    };
+    mesh.texcoords = {
+        Vec2f{ 0.f, 0.f },
+        Vec2f{ 1.f, 0.f },
+        Vec2f{ 1.f, 1.f },
+        Vec2f{ 0.f, 1.f }
+    };
+
+    // Two triangles
+    mesh.indices = { 0, 1, 2, 0, 2, 3 };
     return mesh;
 }
@@ -79,6 +79,10 @@ constexpr float const kCubePositions[] = {
 	+1.f, +1.f, -1.f,
 	+1.f, -1.f, -1.f,
 };
-SimpleMeshData make_particle_quad(const std::vector<Vec3f>& particleCenters, const Vec3f& camRight, const Vec3f& camUp, float size);
+
+// Unit billboard quad for instanced particles: corners at (+-1, +-1, 0),
+// counter-clockwise, with texture coordinates from (0,0) to (1,1). The
+// vertex shader places the corners along the camera's right and up axes.
+SimpleMeshData make_particle_quad();
 
 #endif // SHAPES_HPP_E4D1E8EC_6CDA_4800_ABDD_264F643AF5DB
@@ -1,57 +1,386 @@
 #include "simple_mesh.hpp"
 
+#include <bit>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+#include <cassert>
+#include <cstdint>
+#include <unordered_map>
+
+#include "../support/error.hpp"
+
+namespace
+{
+	// Number of float components per attribute, see VertexLayout::EAttribute
+	constexpr GLint kAttributeComponents_[VertexLayout::eAttributeCount] = { 3, 3, 3, 2 };
+
+	// Append aSrc (the attribute of aSrcCount vertices) to aDst (the attribute
+	// of aDstCount vertices). If only one side has the attribute, the other
+	// side is padded with zeros, so the attribute stays one-per-vertex.
+	template< typename tType >
+	void append_attribute_( std::vector<tType>& aDst, std::size_t aDstCount, std::vector<tType> const& aSrc, std::size_t aSrcCount )
+	{
+		if( aDst.empty() && aSrc.empty() )
+			return;
+
+		aDst.resize( aDstCount, tType{} );
+		if( aSrc.empty() )
+			aDst.resize( aDstCount + aSrcCount, tType{} );
+		else
+			aDst.insert( aDst.end(), aSrc.begin(), aSrc.end() );
+	}
+
+	// Append sequential indices for the vertices [aFirst, aFirst+aCount)
+	void append_soup_indices_( std::vector<GLuint>& aIndices, std::size_t aFirst, std::size_t aCount )
+	{
+		auto const base = aIndices.size();
+		aIndices.resize( base + aCount );
+		std::iota( aIndices.begin() + base, aIndices.end(), GLuint(aFirst) );
+	}
+
+	// Attributes of a single vertex, used as the key when merging vertices.
+	// Missing attributes are left zero.
+	struct VertexKey_
+	{
+		Vec3f position;
+		Vec3f color;
+		Vec3f normal;
+		Vec2f texcoord;
+
+		bool operator== (VertexKey_ const& aOther) const noexcept
+		{
+			return 0 == std::memcmp( this, &aOther, sizeof(VertexKey_) );
+		}
+	};
+
+	static_assert( sizeof(VertexKey_) == 11*sizeof(float) );
+
+	struct VertexKeyHash_
+	{
+		std::size_t operator() (VertexKey_ const& aKey) const noexcept
+		{
+			// FNV-1a over the bit patterns of the attributes
+			float vals[11];
+			std::memcpy( vals, &aKey, sizeof(vals) );
+
+			std::uint64_t hash = 14695981039346656037ull;
+			for( float const v : vals )
+			{
+				hash ^= std::bit_cast<std::uint32_t>( v );
+				hash *= 1099511628211ull;
+			}
+			return std::size_t(hash);
+		}
+	};
+}
+
 SimpleMeshData concatenate( SimpleMeshData aM, SimpleMeshData const& aN )
 {
+	assert( aM.lods.empty() && aN.lods.empty() );
+	assert( aM.tiles.empty() && aN.tiles.empty() );
+
+	auto const baseVertex = aM.positions.size();
+
+	// If either mesh is indexed, the result is indexed too.
+	if( !aM.indices.empty() || !aN.indices.empty() )
+	{
+		if( aM.indices.empty() )
+			append_soup_indices_( aM.indices, 0, aM.positions.size() );
+
+		if( aN.indices.empty() )
+			append_soup_indices_( aM.indices, baseVertex, aN.positions.size() );
+		else
+		{
+			aM.indices.reserve( aM.indices.size() + aN.indices.size() );
+			for( auto const idx : aN.indices )
+				aM.indices.emplace_back( GLuint(baseVertex + idx) );
+		}
+	}
+
+	auto const addedVertex = aN.positions.size();
+	append_attribute_( aM.colors, baseVertex, aN.colors, addedVertex );
+	append_attribute_( aM.normals, baseVertex, aN.normals, addedVertex );
+	append_attribute_( aM.texcoords, baseVertex, aN.texcoords, addedVertex );
 	aM.positions.insert( aM.positions.end(), aN.positions.begin(), aN.positions.end() );
-	aM.colors.insert( aM.colors.end(), aN.colors.begin(), aN.colors.end() );
-    aM.normals.insert( aM.normals.end(), aN.normals.begin(), aN.normals.end() );
 	return aM;
 }
 
-GLuint create_vao(SimpleMeshData const& aMeshData)
+SimpleMeshData make_indexed( SimpleMeshData const& aMeshData )
+{
+	if( !aMeshData.indices.empty() )
+		return aMeshData;
+
+	auto const count = aMeshData.positions.size();
+	bool const hasColors = !aMeshData.colors.empty();
+	bool const hasNormals = !aMeshData.normals.empty();
+	bool const hasTexcoords = !aMeshData.texcoords.empty();
+
+	SimpleMeshData ret;
+	ret.indices.reserve( count );
+
+	std::unordered_map<VertexKey_, GLuint, VertexKeyHash_> unique;
+	unique.reserve( count );
+
+	for( std::size_t i = 0; i < count; ++i )
+	{
+		VertexKey_ key{};
+		key.position = aMeshData.positions[i];
+		if( hasColors ) key.color = aMeshData.colors[i];
+		if( hasNormals ) key.normal = aMeshData.normals[i];
+		if( hasTexcoords ) key.texcoord = aMeshData.texcoords[i];
+
+		auto const [it, inserted] = unique.emplace( key, GLuint(ret.positions.size()) );
+		if( inserted )
+		{
+			ret.positions.emplace_back( key.position );
+			if( hasColors ) ret.colors.emplace_back( key.color );
+			if( hasNormals ) ret.normals.emplace_back( key.normal );
+			if( hasTexcoords ) ret.texcoords.emplace_back( key.texcoord );
+		}
+
+		ret.indices.emplace_back( it->second );
+	}
+
+	return ret;
+}
+
+SimpleMeshView view_of( SimpleMeshData const& aMeshData ) noexcept
+{
+	return SimpleMeshView{
+		aMeshData.positions,
+		aMeshData.colors,
+		aMeshData.normals,
+		aMeshData.texcoords,
+		aMeshData.indices,
+		aMeshData.lods,
+		aMeshData.tiles
+	};
+}
+
+VertexLayout make_vertex_layout( SimpleMeshView const& aMeshData, bool aInterleaved, GLsizei aStride )
+{
+	VertexLayout ret{};
+	ret.interleaved = aInterleaved;
+
+	std::size_t const sizes[VertexLayout::eAttributeCount] = {
+		aMeshData.positions.size_bytes(),
+		aMeshData.colors.size_bytes(),
+		aMeshData.normals.size_bytes(),
+		aMeshData.texcoords.size_bytes()
+	};
+
+	GLsizei offset = 0;
+	for( std::size_t i = 0; i < VertexLayout::eAttributeCount; ++i )
+	{
+		ret.enabled[i] = 0 != sizes[i];
+		if( !ret.enabled[i] )
+			continue;
+
+		ret.offset[i] = offset;
+		offset += kAttributeComponents_[i] * GLsizei(sizeof(float));
+	}
+
+	if( 0 != aStride && aStride < offset )
+		throw Error( "make_vertex_layout(): stride %d is smaller than the vertex size (%d bytes)", int(aStride), int(offset) );
+
+	ret.stride = 0 != aStride ? aStride : offset;
+	return ret;
+}
+
+AABB mesh_bounds( SimpleMeshView const& aMeshData )
+{
+	if( aMeshData.tiles.empty() )
+		return make_aabb( aMeshData.positions );
+
+	AABB ret = kEmptyAABB;
+	for( auto const& tile : aMeshData.tiles )
+		ret = merge( ret, tile.bounds );
+	return ret;
+}
+
+GpuMesh::GpuMesh() noexcept
+	: mVao( 0 )
+	, mBuffers{}
+	, mBufferCount( 0 )
+	, mCount( 0 )
+	, mIndexed( false )
+	, mBounds( kEmptyAABB )
+{}
+
+GpuMesh::~GpuMesh()
+{
+	if( 0 != mVao )
+		glDeleteVertexArrays( 1, &mVao );
+	if( 0 != mBufferCount )
+		glDeleteBuffers( mBufferCount, mBuffers );
+}
+
+GpuMesh::GpuMesh( GpuMesh&& aOther ) noexcept
+	: mVao( std::exchange( aOther.mVao, 0 ) )
+	, mBufferCount( std::exchange( aOther.mBufferCount, 0 ) )
+	, mCount( std::exchange( aOther.mCount, 0 ) )
+	, mIndexed( std::exchange( aOther.mIndexed, false ) )
+	, mLods( std::move(aOther.mLods) )
+	, mTiles( std::move(aOther.mTiles) )
+	, mBounds( std::exchange( aOther.mBounds, kEmptyAABB ) )
+{
+	std::copy( std::begin(aOther.mBuffers), std::end(aOther.mBuffers), mBuffers );
+}
+GpuMesh& GpuMesh::operator= (GpuMesh&& aOther) noexcept
+{
+	std::swap( mVao, aOther.mVao );
+	std::swap( mBuffers, aOther.mBuffers );
+	std::swap( mBufferCount, aOther.mBufferCount );
+	std::swap( mCount, aOther.mCount );
+	std::swap( mIndexed, aOther.mIndexed );
+	std::swap( mLods, aOther.mLods );
+	std::swap( mTiles, aOther.mTiles );
+	std::swap( mBounds, aOther.mBounds );
+	return *this;
+}
+
+GLuint GpuMesh::vao() const noexcept
+{
+	return mVao;
+}
+GLsizei GpuMesh::count() const noexcept
+{
+	return mCount;
+}
+bool GpuMesh::indexed() const noexcept
+{
+	return mIndexed;
+}
+std::span<MeshLod const> GpuMesh::lods() const noexcept
+{
+	return mLods;
+}
+std::span<MeshTile const> GpuMesh::tiles() const noexcept
+{
+	return mTiles;
+}
+AABB const& GpuMesh::bounds() const noexcept
+{
+	return mBounds;
+}
+
+GpuMesh create_gpu_mesh( SimpleMeshView const& aMeshData, VertexLayout const& aLayout )
 {
-	GLuint vao, posVBO, colVBO, normVBO, texVBO;
+	std::span<std::byte const> const attribs[VertexLayout::eAttributeCount] = {
+		std::as_bytes( aMeshData.positions ),
+		std::as_bytes( aMeshData.colors ),
+		std::as_bytes( aMeshData.normals ),
+		std::as_bytes( aMeshData.texcoords )
+	};
+
+	auto const vertexCount = aMeshData.positions.size();
+
+	// Each enabled attribute must have one value per vertex
+	for( std::size_t i = 0; i < VertexLayout::eAttributeCount; ++i )
+	{
+		auto const attribSize = std::size_t(kAttributeComponents_[i]) * sizeof(float);
+		if( aLayout.enabled[i] && attribs[i].size() != vertexCount * attribSize )
+			throw Error( "create_gpu_mesh(): attribute %zu has %zu bytes, expected %zu (%zu vertices)", i, attribs[i].size(), vertexCount * attribSize, vertexCount );
+	}
+
+	GpuMesh ret;
+	ret.mCount = GLsizei(draw_count( aMeshData ));
+	ret.mIndexed = !aMeshData.indices.empty();
+
+	if( aMeshData.lods.empty() )
+		ret.mLods.emplace_back( MeshLod{ 0, GLuint(ret.mCount), 0.f } );
+	else
+		ret.mLods.assign( aMeshData.lods.begin(), aMeshData.lods.end() );
+
+	ret.mTiles.assign( aMeshData.tiles.begin(), aMeshData.tiles.end() );
+
+	ret.mBounds = mesh_bounds( aMeshData );
 
 	// Create and bind a Vertex Array Object
-	glGenVertexArrays(1, &vao);
-	glBindVertexArray(vao);
-
-	// Create and bind a VBO for positions
-	glGenBuffers(1, &posVBO);
-	glBindBuffer(GL_ARRAY_BUFFER, posVBO);
-	glBufferData(GL_ARRAY_BUFFER, aMeshData.positions.size() * sizeof(Vec3f),
-		aMeshData.positions.data(), GL_STATIC_DRAW);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vec3f), (void*)0);
-
-	// Create and bind a VBO for colors
-	glGenBuffers(1, &colVBO);
-	glBindBuffer(GL_ARRAY_BUFFER, colVBO);
-	glBufferData(GL_ARRAY_BUFFER, aMeshData.colors.size() * sizeof(Vec3f),
-		aMeshData.colors.data(), GL_STATIC_DRAW);
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vec3f), (void*)0);
-
-	// Create and bind a VBO for normals
-	glGenBuffers(1, &normVBO);
-	glBindBuffer(GL_ARRAY_BUFFER, normVBO);
-	glBufferData(GL_ARRAY_BUFFER, aMeshData.normals.size() * sizeof(Vec3f),
-		aMeshData.normals.data(), GL_STATIC_DRAW);
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vec3f), (void*)0);
-
-	// Create and bind a VBO for texture
-	glGenBuffers(1, &texVBO);
-	glBindBuffer(GL_ARRAY_BUFFER, texVBO);
-	glBufferData(GL_ARRAY_BUFFER, aMeshData.texcoords.size() * sizeof(Vec2f),
-				 aMeshData.texcoords.data(), GL_STATIC_DRAW);
-
-	glEnableVertexAttribArray(3);
-	glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+	glGenVertexArrays(1, &ret.mVao);
+	glBindVertexArray(ret.mVao);
+
+	if (aLayout.interleaved)
+	{
+		// Pack the enabled attributes of each vertex into a single buffer
+		std::vector<std::byte> packed(vertexCount * aLayout.stride);
+		for (std::size_t i = 0; i < VertexLayout::eAttributeCount; ++i)
+		{
+			if (!aLayout.enabled[i])
+				continue;
+
+			auto const attribSize = std::size_t(kAttributeComponents_[i]) * sizeof(float);
+			std::byte* dst = packed.data() + aLayout.offset[i];
+			std::byte const* src = attribs[i].data();
+			for (std::size_t v = 0; v < vertexCount; ++v, dst += aLayout.stride, src += attribSize)
+				std::memcpy(dst, src, attribSize);
+		}
+
+		GLuint vbo;
+		glGenBuffers(1, &vbo);
+		ret.mBuffers[ret.mBufferCount++] = vbo;
+
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		glBufferData(GL_ARRAY_BUFFER, packed.size(), packed.data(), GL_STATIC_DRAW);
+
+		for (std::size_t i = 0; i < VertexLayout::eAttributeCount; ++i)
+		{
+			if (!aLayout.enabled[i])
+				continue;
+
+			glEnableVertexAttribArray(GLuint(i));
+			glVertexAttribPointer(GLuint(i), kAttributeComponents_[i], GL_FLOAT, GL_FALSE, aLayout.stride,
+				reinterpret_cast<void const*>(std::uintptr_t(aLayout.offset[i])));
+		}
+	}
+	else
+	{
+		// Create one tightly packed VBO per enabled attribute
+		for (std::size_t i = 0; i < VertexLayout::eAttributeCount; ++i)
+		{
+			if (!aLayout.enabled[i])
+				continue;
+
+			GLuint vbo;
+			glGenBuffers(1, &vbo);
+			ret.mBuffers[ret.mBufferCount++] = vbo;
+
+			glBindBuffer(GL_ARRAY_BUFFER, vbo);
+			glBufferData(GL_ARRAY_BUFFER, attribs[i].size(), attribs[i].data(), GL_STATIC_DRAW);
+
+			glEnableVertexAttribArray(GLuint(i));
+			glVertexAttribPointer(GLuint(i), kAttributeComponents_[i], GL_FLOAT, GL_FALSE, 0, nullptr);
+		}
+	}
+
+	// Create and bind an element buffer for indexed meshes. The binding is
+	// recorded in the VAO, so it must happen while the VAO is bound.
+	if (ret.mIndexed)
+	{
+		GLuint indexBO;
+		glGenBuffers(1, &indexBO);
+		ret.mBuffers[ret.mBufferCount++] = indexBO;
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, aMeshData.indices.size_bytes(),
+					 aMeshData.indices.data(), GL_STATIC_DRAW);
+	}
 
     // Reset state
     glBindVertexArray (0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	return vao;
+	return ret;
+}
+
+GpuMesh create_gpu_mesh( SimpleMeshView const& aMeshData )
+{
+	return create_gpu_mesh( aMeshData, make_vertex_layout( aMeshData ) );
+}
+GpuMesh create_gpu_mesh( SimpleMeshData const& aMeshData )
+{
+	return create_gpu_mesh( view_of( aMeshData ) );
 }
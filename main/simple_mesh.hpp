@@ -3,10 +3,46 @@
 
 #include <glad/glad.h>
 
+#include <span>
 #include <vector>
 
 #include "../vmlib/vec3.hpp"
 #include "../vmlib/vec2.hpp"
+#include "../vmlib/aabb.hpp"
+
+// Mesh data on the CPU side. The per-vertex attribute arrays have the same
+// length (or are empty if the mesh does not have that attribute).
+//
+// If indices is empty, the mesh is a triangle soup: every three consecutive
+// vertices form a triangle. Otherwise, every three consecutive indices form a
+// triangle, and vertices may be shared between triangles.
+//
+// Indexed meshes may have levels of detail (see mesh_simplify.hpp). Each
+// level is a range of the index array; all levels share the vertices. If lods
+// is non-empty, lods[0] is the full-detail mesh. Tiled meshes additionally
+// have per-tile levels (see MeshTile).
+struct MeshLod
+	{
+		GLuint firstIndex;
+		GLuint indexCount;
+
+		// Geometric error of this level relative to the full-detail mesh, in
+		// model units. Zero for level 0.
+		float error;
+	};
+
+// Spatial tile of a mesh (see mesh_tiles.hpp). Each of the tile's levels of
+// detail is a range of the mesh's index array; lods[0] is the full-detail
+// level.
+inline constexpr std::size_t kMaxTileLods = 8;
+
+struct MeshTile
+	{
+		AABB bounds;
+
+		GLuint lodCount;
+		MeshLod lods[kMaxTileLods];
+	};
 
 struct SimpleMeshData
 	{
@@ -14,10 +50,140 @@ struct SimpleMeshData
 		std::vector<Vec3f> colors;
 		std::vector<Vec3f> normals;
         std::vector<Vec2f> texcoords;
+
+		std::vector<GLuint> indices;
+		std::vector<MeshLod> lods;
+		std::vector<MeshTile> tiles;
 	};
 
+// Neither mesh may have levels of detail.
 SimpleMeshData concatenate( SimpleMeshData, SimpleMeshData const& );
 
-GLuint create_vao( SimpleMeshData const& );
+// Convert a triangle soup into an indexed mesh by merging vertices whose
+// attributes are bit-identical. Already indexed meshes are returned as-is.
+SimpleMeshData make_indexed( SimpleMeshData const& );
+
+// Non-owning view of mesh data, e.g. pointing into a memory-mapped mesh
+// cache (see mesh_cache.hpp). Same layout rules as SimpleMeshData.
+struct SimpleMeshView
+	{
+		std::span<Vec3f const> positions;
+		std::span<Vec3f const> colors;
+		std::span<Vec3f const> normals;
+		std::span<Vec2f const> texcoords;
+
+		std::span<GLuint const> indices;
+		std::span<MeshLod const> lods;
+		std::span<MeshTile const> tiles;
+	};
+
+SimpleMeshView view_of( SimpleMeshData const& ) noexcept;
+
+// Number of indices to draw (indexed meshes; full detail) or vertices
+// (triangle soups).
+inline
+std::size_t draw_count( SimpleMeshView const& aMeshData )
+{
+	if( !aMeshData.lods.empty() )
+		return aMeshData.lods[0].indexCount;
+	return aMeshData.indices.empty() ? aMeshData.positions.size() : aMeshData.indices.size();
+}
+inline
+std::size_t draw_count( SimpleMeshData const& aMeshData )
+{
+	return draw_count( view_of( aMeshData ) );
+}
+
+// Bounding box of the mesh in model space. Tiled meshes use the tiles' boxes,
+// which avoids a pass over the vertices.
+AABB mesh_bounds( SimpleMeshView const& );
+
+// Describes how vertex attributes are laid out in GPU buffers.
+//
+// With an interleaved layout, all attributes of a vertex are packed next to
+// each other in a single buffer (array-of-structures), so that a vertex fetch
+// touches a single stream. The stride may be padded beyond the packed vertex
+// size. Otherwise, each attribute lives in its own tightly packed buffer.
+//
+// Attributes that are not enabled are not uploaded; the shader then sees the
+// constant generic attribute value (0,0,0,1) at that location.
+struct VertexLayout
+	{
+		enum EAttribute : std::size_t
+		{
+			ePosition,  // location 0, vec3
+			eColor,     // location 1, vec3
+			eNormal,    // location 2, vec3
+			eTexcoord,  // location 3, vec2
+
+			eAttributeCount
+		};
+
+		bool enabled[eAttributeCount];
+		GLsizei offset[eAttributeCount]; // bytes from start of vertex (interleaved only)
+
+		bool interleaved;
+		GLsizei stride; // bytes per vertex (interleaved only)
+	};
+
+// Build a layout that includes exactly the attributes that the mesh has.
+// aStride = 0 selects the packed vertex size; a larger value pads each vertex.
+// Throws Error if aStride is non-zero but smaller than the packed size.
+VertexLayout make_vertex_layout( SimpleMeshView const&, bool aInterleaved = true, GLsizei aStride = 0 );
+
+// Owns the VAO and buffers of a mesh uploaded to the GPU. Move-only.
+class GpuMesh final
+{
+	public:
+		GpuMesh() noexcept;
+		~GpuMesh();
+
+		GpuMesh( GpuMesh const& ) = delete;
+		GpuMesh& operator= (GpuMesh const&) = delete;
+
+		GpuMesh( GpuMesh&& ) noexcept;
+		GpuMesh& operator= (GpuMesh&&) noexcept;
+
+	public:
+		GLuint vao() const noexcept;
+
+		// Number of indices (indexed) or vertices (non-indexed) to draw
+		GLsizei count() const noexcept;
+		bool indexed() const noexcept;
+
+		// Levels of detail. Always contains at least level 0.
+		std::span<MeshLod const> lods() const noexcept;
+
+		// Tiles; empty if the mesh isn't tiled.
+		std::span<MeshTile const> tiles() const noexcept;
+
+		// Model-space bounds (see mesh_bounds())
+		AABB const& bounds() const noexcept;
+
+	private:
+		friend GpuMesh create_gpu_mesh( SimpleMeshView const&, VertexLayout const& );
+
+		static constexpr std::size_t kMaxBuffers_ = VertexLayout::eAttributeCount + 1;
+
+		GLuint mVao;
+		GLuint mBuffers[kMaxBuffers_];
+		GLsizei mBufferCount;
+
+		GLsizei mCount;
+		bool mIndexed;
+
+		std::vector<MeshLod> mLods;
+		std::vector<MeshTile> mTiles;
+
+		AABB mBounds;
+};
+
+// Throws Error if the layout enables an attribute that the mesh doesn't have
+// for every vertex.
+GpuMesh create_gpu_mesh( SimpleMeshView const&, VertexLayout const& );
+
+// Upload with the default layout (interleaved, attributes present in the mesh)
+GpuMesh create_gpu_mesh( SimpleMeshView const& );
+GpuMesh create_gpu_mesh( SimpleMeshData const& );
 
 #endif // SIMPLE_MESH_HPP_C6B749D6_C83B_434C_9E58_F05FC27FEFC9
@@ -0,0 +1,160 @@
+#include "stream_buffer.hpp"
+
+#include <utility>
+
+#include <cassert>
+
+#include "../support/error.hpp"
+#include "../support/gl_stats.hpp"
+
+namespace
+{
+	// Regions start at multiples of this, which covers the alignment of any
+	// buffer binding (uniform buffers typically require 256 bytes).
+	constexpr std::size_t kRegionAlignment_ = 256;
+
+	void wait_fence_( GLsync aFence )
+	{
+		// Flush on the first attempt only, so that the fence is guaranteed to
+		// signal eventually.
+		GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		for( ;; )
+		{
+			auto const res = glClientWaitSync( aFence, flags, 1000000 /*ns*/ );
+			if( GL_ALREADY_SIGNALED == res || GL_CONDITION_SATISFIED == res )
+				return;
+			if( GL_WAIT_FAILED == res )
+				throw Error( "glClientWaitSync() failed" );
+
+			flags = 0;
+		}
+	}
+}
+
+StreamBuffer::StreamBuffer() noexcept
+	: mBuffer( 0 )
+	, mMapped( nullptr )
+	, mRegionSize( 0 )
+	, mRegion( 0 )
+	, mUsed( 0 )
+	, mFences{}
+{}
+
+StreamBuffer::~StreamBuffer()
+{
+	for( auto fence : mFences )
+	{
+		if( fence )
+			glDeleteSync( fence );
+	}
+
+	// Deleting the buffer also unmaps it
+	if( 0 != mBuffer )
+		glDeleteBuffers( 1, &mBuffer );
+}
+
+StreamBuffer::StreamBuffer( StreamBuffer&& aOther ) noexcept
+	: mBuffer( std::exchange( aOther.mBuffer, 0 ) )
+	, mMapped( std::exchange( aOther.mMapped, nullptr ) )
+	, mRegionSize( std::exchange( aOther.mRegionSize, 0 ) )
+	, mRegion( std::exchange( aOther.mRegion, 0 ) )
+	, mUsed( std::exchange( aOther.mUsed, 0 ) )
+	, mFences( std::exchange( aOther.mFences, {} ) )
+{}
+StreamBuffer& StreamBuffer::operator= (StreamBuffer&& aOther) noexcept
+{
+	std::swap( mBuffer, aOther.mBuffer );
+	std::swap( mMapped, aOther.mMapped );
+	std::swap( mRegionSize, aOther.mRegionSize );
+	std::swap( mRegion, aOther.mRegion );
+	std::swap( mUsed, aOther.mUsed );
+	std::swap( mFences, aOther.mFences );
+	return *this;
+}
+
+GLuint StreamBuffer::buffer() const noexcept
+{
+	return mBuffer;
+}
+std::size_t StreamBuffer::region_size() const noexcept
+{
+	return mRegionSize;
+}
+
+void StreamBuffer::begin_frame()
+{
+	assert( mMapped );
+
+	mRegion = (mRegion + 1) % kStreamRegions;
+	mUsed = 0;
+
+	if( auto& fence = mFences[mRegion] )
+	{
+		wait_fence_( fence );
+		glDeleteSync( fence );
+		fence = nullptr;
+	}
+}
+
+StreamBuffer::Allocation StreamBuffer::allocate( std::size_t aBytes, std::size_t aAlignment )
+{
+	assert( mMapped );
+	assert( aAlignment > 0 && 0 == (aAlignment & (aAlignment-1)) );
+
+	// Regions are aligned to kRegionAlignment_, so aligning within the region
+	// aligns the offset into the buffer as well.
+	assert( aAlignment <= kRegionAlignment_ );
+	auto const start = (mUsed + aAlignment-1) & ~(aAlignment-1);
+
+	if( start + aBytes > mRegionSize )
+		throw Error( "Stream buffer region full: %zu of %zu bytes used, %zu more requested", mUsed, mRegionSize, aBytes );
+
+	mUsed = start + aBytes;
+	count_gl_mapped_write( aBytes );
+
+	auto const offset = mRegion * mRegionSize + start;
+	return Allocation{ mMapped + offset, GLintptr(offset), GLsizeiptr(aBytes) };
+}
+
+void StreamBuffer::end_frame()
+{
+	assert( !mFences[mRegion] );
+	mFences[mRegion] = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+}
+
+void StreamBuffer::bind_range( GLenum aTarget, GLuint aIndex, Allocation const& aAlloc ) const
+{
+	glBindBufferRange( aTarget, aIndex, mBuffer, aAlloc.offset, aAlloc.size );
+}
+void StreamBuffer::bind_vertex_buffer( GLuint aBindingIndex, Allocation const& aAlloc, GLsizei aStride ) const
+{
+	glBindVertexBuffer( aBindingIndex, mBuffer, aAlloc.offset, aStride );
+}
+
+StreamBuffer create_stream_buffer( std::size_t aRegionBytes )
+{
+	if( !GLAD_GL_VERSION_4_4 )
+		throw Error( "Stream buffers require OpenGL 4.4 (glBufferStorage)" );
+
+	StreamBuffer ret;
+	ret.mRegionSize = (aRegionBytes + kRegionAlignment_-1) & ~(kRegionAlignment_-1);
+
+	// Start at the last region, so that the first begin_frame() moves to the
+	// first one.
+	ret.mRegion = kStreamRegions-1;
+
+	GLbitfield const flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	auto const bytes = GLsizeiptr(ret.mRegionSize * kStreamRegions);
+
+	glGenBuffers( 1, &ret.mBuffer );
+	glBindBuffer( GL_COPY_WRITE_BUFFER, ret.mBuffer );
+	glBufferStorage( GL_COPY_WRITE_BUFFER, bytes, nullptr, flags );
+
+	ret.mMapped = static_cast<std::byte*>(glMapBufferRange( GL_COPY_WRITE_BUFFER, 0, bytes, flags ));
+	glBindBuffer( GL_COPY_WRITE_BUFFER, 0 );
+
+	if( !ret.mMapped )
+		throw Error( "glMapBufferRange() failed for a %zu byte stream buffer", std::size_t(bytes) );
+
+	return ret;
+}
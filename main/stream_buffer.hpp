@@ -0,0 +1,90 @@
+#ifndef STREAM_BUFFER_HPP_A1F2FEDA_926C_4EC5_8E5D_F57162A21D5E
+#define STREAM_BUFFER_HPP_A1F2FEDA_926C_4EC5_8E5D_F57162A21D5E
+
+#include <glad/glad.h>
+
+#include <array>
+
+#include <cstddef>
+
+/* Persistently mapped stream buffer
+ *
+ * A ring buffer for data that the CPU rewrites every frame (uniforms, streamed
+ * geometry). The buffer is created with glBufferStorage() and stays mapped
+ * (GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT), so data is written straight
+ * into it without any glBufferData()/glBufferSubData() calls.
+ *
+ * The buffer is split into kStreamRegions regions, one per frame in flight.
+ * Each frame allocates from its own region; begin_frame() waits for the fence
+ * that end_frame() placed the last time the region was used, so the CPU never
+ * overwrites data that the GPU may still read.
+ *
+ * Requires OpenGL 4.4 for glBufferStorage().
+ */
+inline constexpr std::size_t kStreamRegions = 3;
+
+class StreamBuffer final
+{
+	public:
+		// Part of the current region. offset is relative to the start of the
+		// buffer, as expected by glBindBufferRange() and friends.
+		struct Allocation
+		{
+			std::byte* data;
+			GLintptr offset;
+			GLsizeiptr size;
+		};
+
+	public:
+		StreamBuffer() noexcept;
+		~StreamBuffer();
+
+		StreamBuffer( StreamBuffer const& ) = delete;
+		StreamBuffer& operator= (StreamBuffer const&) = delete;
+
+		StreamBuffer( StreamBuffer&& ) noexcept;
+		StreamBuffer& operator= (StreamBuffer&&) noexcept;
+
+	public:
+		GLuint buffer() const noexcept;
+		std::size_t region_size() const noexcept;
+
+		// Moves on to the next region. Blocks until the GPU is done with the
+		// commands submitted before that region's last end_frame().
+		void begin_frame();
+
+		// Allocates aBytes from the current region. aAlignment must be a power
+		// of two. Throws if the region is full. The bytes count as uploaded
+		// (see gl_stats.hpp).
+		Allocation allocate( std::size_t aBytes, std::size_t aAlignment = 16 );
+
+		// Fences the current region. Call after the last command that reads
+		// from it has been submitted.
+		void end_frame();
+
+		// Binds an allocation to an indexed target (e.g. GL_UNIFORM_BUFFER)
+		void bind_range( GLenum aTarget, GLuint aIndex, Allocation const& ) const;
+
+		// Binds an allocation as the source of vertex buffer binding point
+		// aBindingIndex of the current VAO. Attributes must use the separate
+		// format API (glVertexAttribFormat() and glVertexAttribBinding()).
+		void bind_vertex_buffer( GLuint aBindingIndex, Allocation const&, GLsizei aStride ) const;
+
+	private:
+		friend StreamBuffer create_stream_buffer( std::size_t );
+
+		GLuint mBuffer;
+		std::byte* mMapped;
+
+		std::size_t mRegionSize;
+		std::size_t mRegion;
+		std::size_t mUsed;
+
+		std::array<GLsync, kStreamRegions> mFences;
+};
+
+// Creates a buffer with kStreamRegions regions of (at least) aRegionBytes
+// each. Requires a current OpenGL 4.4 context.
+StreamBuffer create_stream_buffer( std::size_t aRegionBytes );
+
+#endif // STREAM_BUFFER_HPP_A1F2FEDA_926C_4EC5_8E5D_F57162A21D5E
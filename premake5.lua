@@ -128,6 +128,24 @@ project "vmlib-test"
 
 	links "x-catch2"
 
+project "vmlib-bench"
+	local sources = { 
+		"vmlib-bench/**.cpp",
+		"vmlib-bench/**.hpp",
+		"vmlib-bench/**.hxx",
+		"vmlib-bench/**.inl"
+	}
+
+	kind "ConsoleApp"
+	location "vmlib-bench"
+
+	files( sources )
+
+	links "vmlib"
+	links "support"
+
+	links "x-catch2"
+
 project "support"
 	local sources = { 
 		"support/**.cpp",
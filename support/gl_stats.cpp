@@ -0,0 +1,184 @@
+#include "gl_stats.hpp"
+
+#include <glad/glad.h>
+
+#include <cassert>
+
+namespace
+{
+	GlFrameStats sFrame{};
+	bool sInstalled = false;
+
+	// Bytes per pixel of client image data. Row padding (GL_UNPACK_*) is
+	// ignored; the counters are estimates of the traffic anyway.
+	std::uint64_t pixel_bytes_( GLenum aFormat, GLenum aType ) noexcept
+	{
+		switch( aType )
+		{
+			// Packed: one value per pixel
+			case GL_UNSIGNED_INT_8_8_8_8:
+			case GL_UNSIGNED_INT_8_8_8_8_REV:
+			case GL_UNSIGNED_INT_2_10_10_10_REV:
+			case GL_UNSIGNED_INT_10F_11F_11F_REV:
+				return 4;
+			case GL_UNSIGNED_SHORT_5_6_5:
+			case GL_UNSIGNED_SHORT_4_4_4_4:
+			case GL_UNSIGNED_SHORT_5_5_5_1:
+				return 2;
+			default:
+				break;
+		}
+
+		std::uint64_t components = 4;
+		switch( aFormat )
+		{
+			case GL_RED: case GL_RED_INTEGER: case GL_DEPTH_COMPONENT: components = 1; break;
+			case GL_RG: case GL_RG_INTEGER: components = 2; break;
+			case GL_RGB: case GL_BGR: case GL_RGB_INTEGER: components = 3; break;
+			default: break;
+		}
+
+		switch( aType )
+		{
+			case GL_BYTE: case GL_UNSIGNED_BYTE: return components;
+			case GL_SHORT: case GL_UNSIGNED_SHORT: case GL_HALF_FLOAT: return 2 * components;
+			default: return 4 * components;
+		}
+	}
+}
+
+// Each hooked entry point gets the driver's function, sName_, and a
+// wrapper, counted_Name_, that updates the counters and forwards the call.
+// The arguments are named a0, a1, ... in order.
+#define GL_STATS_HOOK_( name, params, args, count ) \
+	namespace { \
+		decltype(glad_gl##name) s##name##_ = nullptr; \
+		void APIENTRY counted_##name##_ params \
+		{ \
+			count; \
+			s##name##_ args; \
+		} \
+	} \
+	/*ENDM*/
+
+GL_STATS_HOOK_( DrawArrays, (GLenum a0, GLint a1, GLsizei a2), (a0, a1, a2), ++sFrame.drawCalls )
+GL_STATS_HOOK_( DrawElements, (GLenum a0, GLsizei a1, GLenum a2, void const* a3), (a0, a1, a2, a3), ++sFrame.drawCalls )
+GL_STATS_HOOK_( DrawElementsBaseVertex, (GLenum a0, GLsizei a1, GLenum a2, void const* a3, GLint a4), (a0, a1, a2, a3, a4), ++sFrame.drawCalls )
+GL_STATS_HOOK_( DrawArraysInstanced, (GLenum a0, GLint a1, GLsizei a2, GLsizei a3), (a0, a1, a2, a3), ++sFrame.drawCalls )
+GL_STATS_HOOK_( DrawElementsInstanced, (GLenum a0, GLsizei a1, GLenum a2, void const* a3, GLsizei a4), (a0, a1, a2, a3, a4), ++sFrame.drawCalls )
+GL_STATS_HOOK_( DrawArraysInstancedBaseInstance, (GLenum a0, GLint a1, GLsizei a2, GLsizei a3, GLuint a4), (a0, a1, a2, a3, a4), ++sFrame.drawCalls )
+GL_STATS_HOOK_( DrawElementsInstancedBaseInstance, (GLenum a0, GLsizei a1, GLenum a2, void const* a3, GLsizei a4, GLuint a5), (a0, a1, a2, a3, a4, a5), ++sFrame.drawCalls )
+GL_STATS_HOOK_( DrawArraysIndirect, (GLenum a0, void const* a1), (a0, a1), ++sFrame.drawCalls )
+GL_STATS_HOOK_( DrawElementsIndirect, (GLenum a0, GLenum a1, void const* a2), (a0, a1, a2), ++sFrame.drawCalls )
+GL_STATS_HOOK_( MultiDrawArraysIndirect, (GLenum a0, void const* a1, GLsizei a2, GLsizei a3), (a0, a1, a2, a3), ++sFrame.drawCalls )
+GL_STATS_HOOK_( MultiDrawElementsIndirect, (GLenum a0, GLenum a1, void const* a2, GLsizei a3, GLsizei a4), (a0, a1, a2, a3, a4), ++sFrame.drawCalls )
+
+GL_STATS_HOOK_( DispatchCompute, (GLuint a0, GLuint a1, GLuint a2), (a0, a1, a2), ++sFrame.dispatches )
+GL_STATS_HOOK_( DispatchComputeIndirect, (GLintptr a0), (a0), ++sFrame.dispatches )
+
+GL_STATS_HOOK_( UseProgram, (GLuint a0), (a0), ++sFrame.programBinds )
+GL_STATS_HOOK_( BindTexture, (GLenum a0, GLuint a1), (a0, a1), ++sFrame.textureBinds )
+GL_STATS_HOOK_( BindVertexArray, (GLuint a0), (a0), ++sFrame.vaoBinds )
+GL_STATS_HOOK_( BindBufferBase, (GLenum a0, GLuint a1, GLuint a2), (a0, a1, a2), ++sFrame.bufferBinds )
+GL_STATS_HOOK_( BindBufferRange, (GLenum a0, GLuint a1, GLuint a2, GLintptr a3, GLsizeiptr a4), (a0, a1, a2, a3, a4), ++sFrame.bufferBinds )
+
+GL_STATS_HOOK_( Uniform1i, (GLint a0, GLint a1), (a0, a1), ++sFrame.uniformCalls )
+GL_STATS_HOOK_( Uniform1ui, (GLint a0, GLuint a1), (a0, a1), ++sFrame.uniformCalls )
+GL_STATS_HOOK_( Uniform2ui, (GLint a0, GLuint a1, GLuint a2), (a0, a1, a2), ++sFrame.uniformCalls )
+GL_STATS_HOOK_( Uniform1f, (GLint a0, GLfloat a1), (a0, a1), ++sFrame.uniformCalls )
+GL_STATS_HOOK_( Uniform2f, (GLint a0, GLfloat a1, GLfloat a2), (a0, a1, a2), ++sFrame.uniformCalls )
+GL_STATS_HOOK_( Uniform3f, (GLint a0, GLfloat a1, GLfloat a2, GLfloat a3), (a0, a1, a2, a3), ++sFrame.uniformCalls )
+GL_STATS_HOOK_( Uniform4f, (GLint a0, GLfloat a1, GLfloat a2, GLfloat a3, GLfloat a4), (a0, a1, a2, a3, a4), ++sFrame.uniformCalls )
+GL_STATS_HOOK_( Uniform3fv, (GLint a0, GLsizei a1, GLfloat const* a2), (a0, a1, a2), ++sFrame.uniformCalls )
+GL_STATS_HOOK_( UniformMatrix4fv, (GLint a0, GLsizei a1, GLboolean a2, GLfloat const* a3), (a0, a1, a2, a3), ++sFrame.uniformCalls )
+
+// Without client data, these only allocate (or copy from a bound pixel
+// unpack buffer, which this code doesn't use)
+GL_STATS_HOOK_( BufferData, (GLenum a0, GLsizeiptr a1, void const* a2, GLenum a3), (a0, a1, a2, a3),
+	if( a2 ) sFrame.uploadBytes += std::uint64_t(a1) )
+GL_STATS_HOOK_( BufferSubData, (GLenum a0, GLintptr a1, GLsizeiptr a2, void const* a3), (a0, a1, a2, a3),
+	sFrame.uploadBytes += std::uint64_t(a2) )
+GL_STATS_HOOK_( BufferStorage, (GLenum a0, GLsizeiptr a1, void const* a2, GLbitfield a3), (a0, a1, a2, a3),
+	if( a2 ) sFrame.uploadBytes += std::uint64_t(a1) )
+GL_STATS_HOOK_( TexImage2D, (GLenum a0, GLint a1, GLint a2, GLsizei a3, GLsizei a4, GLint a5, GLenum a6, GLenum a7, void const* a8), (a0, a1, a2, a3, a4, a5, a6, a7, a8),
+	if( a8 ) sFrame.uploadBytes += std::uint64_t(a3) * std::uint64_t(a4) * pixel_bytes_( a6, a7 ) )
+GL_STATS_HOOK_( TexSubImage2D, (GLenum a0, GLint a1, GLint a2, GLint a3, GLsizei a4, GLsizei a5, GLenum a6, GLenum a7, void const* a8), (a0, a1, a2, a3, a4, a5, a6, a7, a8),
+	if( a8 ) sFrame.uploadBytes += std::uint64_t(a4) * std::uint64_t(a5) * pixel_bytes_( a6, a7 ) )
+
+#undef GL_STATS_HOOK_
+
+std::uint32_t state_changes( GlFrameStats const& aStats ) noexcept
+{
+	return aStats.programBinds + aStats.textureBinds + aStats.vaoBinds + aStats.bufferBinds;
+}
+
+void install_gl_stats()
+{
+	// Hooking twice would make the wrappers call themselves
+	assert( !sInstalled );
+	if( sInstalled )
+		return;
+	sInstalled = true;
+
+	// Entry points that the context doesn't provide stay null
+#	define GL_STATS_INSTALL_( name ) \
+		if( glad_gl##name ) \
+		{ \
+			s##name##_ = glad_gl##name; \
+			glad_gl##name = &counted_##name##_; \
+		} \
+		/*ENDM*/
+
+	GL_STATS_INSTALL_( DrawArrays )
+	GL_STATS_INSTALL_( DrawElements )
+	GL_STATS_INSTALL_( DrawElementsBaseVertex )
+	GL_STATS_INSTALL_( DrawArraysInstanced )
+	GL_STATS_INSTALL_( DrawElementsInstanced )
+	GL_STATS_INSTALL_( DrawArraysInstancedBaseInstance )
+	GL_STATS_INSTALL_( DrawElementsInstancedBaseInstance )
+	GL_STATS_INSTALL_( DrawArraysIndirect )
+	GL_STATS_INSTALL_( DrawElementsIndirect )
+	GL_STATS_INSTALL_( MultiDrawArraysIndirect )
+	GL_STATS_INSTALL_( MultiDrawElementsIndirect )
+
+	GL_STATS_INSTALL_( DispatchCompute )
+	GL_STATS_INSTALL_( DispatchComputeIndirect )
+
+	GL_STATS_INSTALL_( UseProgram )
+	GL_STATS_INSTALL_( BindTexture )
+	GL_STATS_INSTALL_( BindVertexArray )
+	GL_STATS_INSTALL_( BindBufferBase )
+	GL_STATS_INSTALL_( BindBufferRange )
+
+	GL_STATS_INSTALL_( Uniform1i )
+	GL_STATS_INSTALL_( Uniform1ui )
+	GL_STATS_INSTALL_( Uniform2ui )
+	GL_STATS_INSTALL_( Uniform1f )
+	GL_STATS_INSTALL_( Uniform2f )
+	GL_STATS_INSTALL_( Uniform3f )
+	GL_STATS_INSTALL_( Uniform4f )
+	GL_STATS_INSTALL_( Uniform3fv )
+	GL_STATS_INSTALL_( UniformMatrix4fv )
+
+	GL_STATS_INSTALL_( BufferData )
+	GL_STATS_INSTALL_( BufferSubData )
+	GL_STATS_INSTALL_( BufferStorage )
+	GL_STATS_INSTALL_( TexImage2D )
+	GL_STATS_INSTALL_( TexSubImage2D )
+
+#	undef GL_STATS_INSTALL_
+
+	sFrame = GlFrameStats{};
+}
+
+void count_gl_mapped_write( std::size_t aBytes ) noexcept
+{
+	sFrame.uploadBytes += aBytes;
+}
+
+GlFrameStats end_gl_stats_frame() noexcept
+{
+	GlFrameStats const ret = sFrame;
+	sFrame = GlFrameStats{};
+	return ret;
+}
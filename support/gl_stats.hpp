@@ -0,0 +1,49 @@
+#ifndef GL_STATS_HPP_E61B0C47_2A9D_4F83_8C15_7D4A93F2B6E0
+#define GL_STATS_HPP_E61B0C47_2A9D_4F83_8C15_7D4A93F2B6E0
+
+#include <cstddef>
+#include <cstdint>
+
+/* GL call counters
+ *
+ * install_gl_stats() replaces glad's pointers to the draw, dispatch, binding,
+ * uniform and upload entry points with wrappers that count the call and
+ * then forward it to the driver. Everything that calls GL through glad is
+ * counted without changes at the call sites. A counted call costs one more
+ * indirect call and an increment.
+ *
+ * Writes to persistently mapped buffers don't go through GL; the code that
+ * makes them reports them with count_gl_mapped_write().
+ *
+ * The counters aren't atomic: GL is only called from the thread that owns
+ * the context.
+ */
+struct GlFrameStats
+{
+	std::uint32_t drawCalls;    // glDraw*() and glMultiDraw*(), once per call
+	std::uint32_t dispatches;   // glDispatchCompute*()
+
+	std::uint32_t programBinds; // glUseProgram()
+	std::uint32_t textureBinds; // glBindTexture()
+	std::uint32_t vaoBinds;     // glBindVertexArray()
+	std::uint32_t bufferBinds;  // glBindBufferBase() and glBindBufferRange()
+	std::uint32_t uniformCalls; // glUniform*()
+
+	// glBuffer{Data,SubData,Storage}() and glTex{Image,SubImage}2D() with
+	// client data, and writes to mapped buffers
+	std::uint64_t uploadBytes;
+};
+
+// Programs, textures, VAOs and indexed buffers bound
+std::uint32_t state_changes( GlFrameStats const& ) noexcept;
+
+// Call once, right after glad has loaded the GL functions.
+void install_gl_stats();
+
+void count_gl_mapped_write( std::size_t aBytes ) noexcept;
+
+// Counters since the previous call (or since install_gl_stats()); resets
+// them. Call once per frame.
+GlFrameStats end_gl_stats_frame() noexcept;
+
+#endif // GL_STATS_HPP_E61B0C47_2A9D_4F83_8C15_7D4A93F2B6E0
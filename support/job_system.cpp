@@ -0,0 +1,98 @@
+#include "job_system.hpp"
+
+#include <algorithm>
+
+#include <cassert>
+
+JobSystem::JobSystem()
+	: JobSystem( std::max( std::thread::hardware_concurrency(), 1u ) - 1 )
+{}
+
+JobSystem::JobSystem( std::size_t aWorkers )
+	: mJob( nullptr )
+	, mCount( 0 )
+	, mNext( 0 )
+	, mBusy( 0 )
+	, mGeneration( 0 )
+	, mQuit( false )
+{
+	mWorkers.reserve( aWorkers );
+	for( std::size_t i = 0; i < aWorkers; ++i )
+		mWorkers.emplace_back( [this] { worker_(); } );
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard lock( mMutex );
+		mQuit = true;
+	}
+	mWake.notify_all();
+
+	for( auto& worker : mWorkers )
+		worker.join();
+}
+
+std::size_t JobSystem::thread_count() const noexcept
+{
+	return mWorkers.size() + 1;
+}
+
+void JobSystem::parallel_for( std::size_t aCount, std::function<void(std::size_t)> const& aJob )
+{
+	// Not worth waking anybody up
+	if( mWorkers.empty() || aCount <= 1 )
+	{
+		for( std::size_t i = 0; i < aCount; ++i )
+			aJob( i );
+		return;
+	}
+
+	{
+		std::lock_guard lock( mMutex );
+		assert( 0 == mBusy );
+
+		mJob = &aJob;
+		mCount = aCount;
+		mNext.store( 0, std::memory_order_relaxed );
+		mBusy = mWorkers.size();
+		++mGeneration;
+	}
+	mWake.notify_all();
+
+	run_();
+
+	// Every worker checks in, even if there was nothing left for it, so no
+	// worker can still be looking at this loop once we return.
+	std::unique_lock lock( mMutex );
+	mDone.wait( lock, [this] { return 0 == mBusy; } );
+	mJob = nullptr;
+}
+
+void JobSystem::worker_()
+{
+	std::uint64_t seen = 0;
+	for( ;; )
+	{
+		{
+			std::unique_lock lock( mMutex );
+			mWake.wait( lock, [&] { return mQuit || mGeneration != seen; } );
+			if( mQuit )
+				return;
+
+			seen = mGeneration;
+		}
+
+		run_();
+
+		std::lock_guard lock( mMutex );
+		if( 0 == --mBusy )
+			mDone.notify_one();
+	}
+}
+
+void JobSystem::run_()
+{
+	for( auto i = mNext.fetch_add( 1, std::memory_order_relaxed ); i < mCount; i = mNext.fetch_add( 1, std::memory_order_relaxed ) )
+		(*mJob)( i );
+}
@@ -0,0 +1,65 @@
+#ifndef JOB_SYSTEM_HPP_8D2F6B31_4C7A_4E95_A0B3_5E19C7D24F68
+#define JOB_SYSTEM_HPP_8D2F6B31_4C7A_4E95_A0B3_5E19C7D24F68
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+#include <cstddef>
+#include <cstdint>
+
+// Fixed pool of worker threads that run parallel loops. The calling thread
+// takes part in each loop, so a JobSystem with zero workers runs everything
+// on the caller.
+//
+// Example:
+//
+//	JobSystem jobs;
+//	jobs.parallel_for( chunks, [&] (std::size_t aChunk) { ... } );
+//
+class JobSystem final
+{
+	public:
+		// One worker per hardware thread, besides the caller
+		JobSystem();
+		explicit JobSystem( std::size_t aWorkers );
+
+		~JobSystem();
+
+		JobSystem( JobSystem const& ) = delete;
+		JobSystem& operator= (JobSystem const&) = delete;
+
+	public:
+		// Workers plus the calling thread
+		std::size_t thread_count() const noexcept;
+
+		// Calls aJob( i ) for every i in [0, aCount) and returns when all calls
+		// have finished. The calls are spread dynamically over the threads, in
+		// no particular order. aJob must not throw. Not reentrant: only one
+		// thread may call parallel_for() at a time.
+		void parallel_for( std::size_t aCount, std::function<void(std::size_t)> const& aJob );
+
+	private:
+		void worker_();
+		void run_();
+
+		std::vector<std::thread> mWorkers;
+
+		std::mutex mMutex;
+		std::condition_variable mWake;
+		std::condition_variable mDone;
+
+		// Current loop; written under mMutex before mGeneration is bumped
+		std::function<void(std::size_t)> const* mJob;
+		std::size_t mCount;
+		std::atomic<std::size_t> mNext;
+
+		std::size_t mBusy; // workers that haven't finished the current loop
+		std::uint64_t mGeneration;
+		bool mQuit;
+};
+
+#endif // JOB_SYSTEM_HPP_8D2F6B31_4C7A_4E95_A0B3_5E19C7D24F68
@@ -0,0 +1,160 @@
+#include "mapped_file.hpp"
+
+#include <utility>
+
+#include "error.hpp"
+
+#if defined(_WIN32)
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <cerrno>
+#	include <cstring>
+#endif
+
+MappedFile::MappedFile() noexcept
+	: mData( nullptr )
+	, mSize( 0 )
+#	if defined(_WIN32)
+	, mFile( nullptr )
+	, mMapping( nullptr )
+#	endif
+{}
+
+#if defined(_WIN32)
+// Note: the constructor delegates to the default constructor, so the
+// destructor runs and releases any handles if we throw part way through.
+MappedFile::MappedFile( char const* aPath )
+	: MappedFile()
+{
+	HANDLE file = CreateFileA( aPath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+	if( INVALID_HANDLE_VALUE == file )
+		throw Error( "MappedFile: unable to open '%s': error %lu", aPath, GetLastError() );
+
+	mFile = file;
+
+	LARGE_INTEGER size;
+	if( !GetFileSizeEx( file, &size ) )
+	{
+		auto const err = GetLastError();
+		throw Error( "MappedFile: unable to query size of '%s': error %lu", aPath, err );
+	}
+
+	mSize = std::size_t(size.QuadPart);
+	if( 0 == mSize )
+		return;
+
+	mMapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+	if( !mMapping )
+	{
+		auto const err = GetLastError();
+		throw Error( "MappedFile: unable to map '%s': error %lu", aPath, err );
+	}
+
+	mData = MapViewOfFile( mMapping, FILE_MAP_READ, 0, 0, 0 );
+	if( !mData )
+	{
+		auto const err = GetLastError();
+		throw Error( "MappedFile: unable to map view of '%s': error %lu", aPath, err );
+	}
+}
+
+MappedFile::~MappedFile()
+{
+	if( mData )
+		UnmapViewOfFile( mData );
+	if( mMapping )
+		CloseHandle( mMapping );
+	if( mFile )
+		CloseHandle( mFile );
+}
+
+MappedFile::MappedFile( MappedFile&& aOther ) noexcept
+	: mData( std::exchange( aOther.mData, nullptr ) )
+	, mSize( std::exchange( aOther.mSize, 0 ) )
+	, mFile( std::exchange( aOther.mFile, nullptr ) )
+	, mMapping( std::exchange( aOther.mMapping, nullptr ) )
+{}
+MappedFile& MappedFile::operator= (MappedFile&& aOther) noexcept
+{
+	std::swap( mData, aOther.mData );
+	std::swap( mSize, aOther.mSize );
+	std::swap( mFile, aOther.mFile );
+	std::swap( mMapping, aOther.mMapping );
+	return *this;
+}
+
+#else // POSIX
+MappedFile::MappedFile( char const* aPath )
+	: MappedFile()
+{
+	int const fd = ::open( aPath, O_RDONLY | O_CLOEXEC );
+	if( -1 == fd )
+		throw Error( "MappedFile: unable to open '%s': %s", aPath, std::strerror(errno) );
+
+	struct stat st;
+	if( -1 == ::fstat( fd, &st ) )
+	{
+		auto const err = errno;
+		::close( fd );
+		throw Error( "MappedFile: unable to stat '%s': %s", aPath, std::strerror(err) );
+	}
+
+	mSize = std::size_t(st.st_size);
+	if( 0 == mSize )
+	{
+		::close( fd );
+		return;
+	}
+
+	void* data = ::mmap( nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0 );
+	auto const err = errno;
+
+	// The mapping stays valid after the descriptor is closed.
+	::close( fd );
+
+	if( MAP_FAILED == data )
+	{
+		mSize = 0;
+		throw Error( "MappedFile: unable to map '%s': %s", aPath, std::strerror(err) );
+	}
+
+	mData = data;
+}
+
+MappedFile::~MappedFile()
+{
+	if( mData )
+		::munmap( mData, mSize );
+}
+
+MappedFile::MappedFile( MappedFile&& aOther ) noexcept
+	: mData( std::exchange( aOther.mData, nullptr ) )
+	, mSize( std::exchange( aOther.mSize, 0 ) )
+{}
+MappedFile& MappedFile::operator= (MappedFile&& aOther) noexcept
+{
+	std::swap( mData, aOther.mData );
+	std::swap( mSize, aOther.mSize );
+	return *this;
+}
+#endif // ~ _WIN32
+
+std::span<std::byte const> MappedFile::bytes() const noexcept
+{
+	return { data(), mSize };
+}
+
+std::byte const* MappedFile::data() const noexcept
+{
+	return static_cast<std::byte const*>(mData);
+}
+std::size_t MappedFile::size() const noexcept
+{
+	return mSize;
+}
@@ -0,0 +1,42 @@
+#ifndef MAPPED_FILE_HPP_CE64DC92_98B4_443B_86A4_2BC2B352AA5C
+#define MAPPED_FILE_HPP_CE64DC92_98B4_443B_86A4_2BC2B352AA5C
+
+#include <span>
+
+#include <cstddef>
+
+// Read-only memory mapping of a whole file. The mapping is released when the
+// object is destroyed. Throws Error if the file cannot be opened or mapped.
+//
+// Empty files are allowed; bytes() returns an empty span for them.
+class MappedFile final
+{
+	public:
+		MappedFile() noexcept;
+		explicit MappedFile( char const* aPath );
+
+		~MappedFile();
+
+		MappedFile( MappedFile const& ) = delete;
+		MappedFile& operator= (MappedFile const&) = delete;
+
+		MappedFile( MappedFile&& ) noexcept;
+		MappedFile& operator= (MappedFile&&) noexcept;
+
+	public:
+		std::span<std::byte const> bytes() const noexcept;
+
+		std::byte const* data() const noexcept;
+		std::size_t size() const noexcept;
+
+	private:
+		void* mData;
+		std::size_t mSize;
+
+#		if defined(_WIN32)
+		void* mFile;
+		void* mMapping;
+#		endif
+};
+
+#endif // MAPPED_FILE_HPP_CE64DC92_98B4_443B_86A4_2BC2B352AA5C
@@ -0,0 +1,483 @@
+#include "profiler.hpp"
+
+#include <cmath>
+#include <utility>
+#include <algorithm>
+
+#include <cassert>
+
+#include "error.hpp"
+
+namespace
+{
+	Profiler* sCurrent = nullptr;
+
+	// Nearest rank; aSorted must not be empty
+	double percentile_( std::vector<float> const& aSorted, double aFraction ) noexcept
+	{
+		auto const rank = std::size_t(std::ceil( aFraction * double(aSorted.size()) ));
+		return aSorted[std::max( rank, std::size_t(1) ) - 1];
+	}
+
+	// Zone names are string literals; only quotes and backslashes need
+	// escaping
+	void write_json_string_( std::FILE* aOut, char const* aString )
+	{
+		std::fputc( '"', aOut );
+		for( ; *aString; ++aString )
+		{
+			if( '"' == *aString || '\\' == *aString )
+				std::fputc( '\\', aOut );
+			std::fputc( *aString, aOut );
+		}
+		std::fputc( '"', aOut );
+	}
+
+	// Trace event of a complete span; times in nanoseconds, written in
+	// microseconds
+	void write_trace_span_( std::FILE* aOut, char const* aName, char const* aCategory, int aPid, std::size_t aTid, std::int64_t aBegin, std::int64_t aEnd )
+	{
+		std::fprintf( aOut, ",\n{\"ph\": \"X\", \"name\": " );
+		write_json_string_( aOut, aName );
+		std::fprintf( aOut, ", \"cat\": \"%s\", \"pid\": %d, \"tid\": %zu, \"ts\": %.3f, \"dur\": %.3f}",
+			aCategory, aPid, aTid, double(aBegin) * 1e-3, double(aEnd - aBegin) * 1e-3
+		);
+	}
+
+	// Trace process ids
+	constexpr int kTraceCpuPid_ = 1;
+	constexpr int kTraceGpuPid_ = 2;
+}
+
+ProfileSummary summarize_samples( std::span<float const> aSamples )
+{
+	if( aSamples.empty() )
+		return ProfileSummary{};
+
+	std::vector<float> sorted( aSamples.begin(), aSamples.end() );
+	std::sort( sorted.begin(), sorted.end() );
+
+	double sum = 0.0;
+	for( auto const sample : sorted )
+		sum += sample;
+
+	return ProfileSummary{
+		sorted.size(),
+		sorted.front(),
+		sum / double(sorted.size()),
+		percentile_( sorted, 0.50 ),
+		percentile_( sorted, 0.95 ),
+		percentile_( sorted, 0.99 )
+	};
+}
+
+Profiler::Profiler() noexcept
+	: mFrame( 0 )
+	, mDroppedFrames( 0 )
+	, mEnabled( false )
+	, mEnabledNext( false )
+	, mRecording( false )
+	, mRecordingNext( false )
+	, mTracingNext( false )
+	, mInFrame( false )
+	, mTraceGpuEpoch( 0 )
+	, mTracing( false )
+{}
+
+Profiler::~Profiler()
+{
+	if( this == sCurrent )
+		sCurrent = nullptr;
+
+	for( auto& frame : mGpuFrames )
+	{
+		if( !frame.queries.empty() )
+			glDeleteQueries( GLsizei(frame.queries.size()), frame.queries.data() );
+	}
+}
+
+Profiler::Profiler( Profiler&& aOther ) noexcept
+	: mZones( std::move(aOther.mZones) )
+	, mStack( std::move(aOther.mStack) )
+	, mGpuFrames( std::move(aOther.mGpuFrames) )
+	, mFrame( aOther.mFrame )
+	, mDroppedFrames( aOther.mDroppedFrames )
+	, mEnabled( aOther.mEnabled )
+	, mEnabledNext( aOther.mEnabledNext )
+	, mRecording( aOther.mRecording )
+	, mRecordingNext( aOther.mRecordingNext )
+	, mTracingNext( aOther.mTracingNext )
+	, mInFrame( aOther.mInFrame )
+	, mTraceEpoch( aOther.mTraceEpoch )
+	, mTraceGpuEpoch( aOther.mTraceGpuEpoch )
+	, mTraceCpu( std::move(aOther.mTraceCpu) )
+	, mTraceGpu( std::move(aOther.mTraceGpu) )
+	, mTraceSpans( std::move(aOther.mTraceSpans) )
+	, mTraceThreads( std::move(aOther.mTraceThreads) )
+	, mTracing( aOther.mTracing )
+{
+	for( auto& frame : aOther.mGpuFrames )
+		frame = GpuFrame_{};
+}
+Profiler& Profiler::operator= (Profiler&& aOther) noexcept
+{
+	std::swap( mZones, aOther.mZones );
+	std::swap( mStack, aOther.mStack );
+	std::swap( mGpuFrames, aOther.mGpuFrames );
+	std::swap( mFrame, aOther.mFrame );
+	std::swap( mDroppedFrames, aOther.mDroppedFrames );
+	std::swap( mEnabled, aOther.mEnabled );
+	std::swap( mEnabledNext, aOther.mEnabledNext );
+	std::swap( mRecording, aOther.mRecording );
+	std::swap( mRecordingNext, aOther.mRecordingNext );
+	std::swap( mTracingNext, aOther.mTracingNext );
+	std::swap( mInFrame, aOther.mInFrame );
+	std::swap( mTraceEpoch, aOther.mTraceEpoch );
+	std::swap( mTraceGpuEpoch, aOther.mTraceGpuEpoch );
+	std::swap( mTraceCpu, aOther.mTraceCpu );
+	std::swap( mTraceGpu, aOther.mTraceGpu );
+	std::swap( mTraceSpans, aOther.mTraceSpans );
+	std::swap( mTraceThreads, aOther.mTraceThreads );
+	std::swap( mTracing, aOther.mTracing );
+	return *this;
+}
+
+void Profiler::make_current() noexcept
+{
+	sCurrent = this;
+}
+Profiler* Profiler::current() noexcept
+{
+	return sCurrent;
+}
+
+void Profiler::set_enabled( bool aEnabled ) noexcept
+{
+	mEnabledNext = aEnabled;
+}
+bool Profiler::enabled() const noexcept
+{
+	return mEnabledNext;
+}
+
+void Profiler::set_recording( bool aRecording )
+{
+	if( aRecording && !mRecordingNext )
+	{
+		for( auto& zone : mZones )
+			zone.recorded.clear();
+	}
+
+	mRecordingNext = aRecording;
+}
+
+void Profiler::begin_frame()
+{
+	assert( !mInFrame && mStack.empty() );
+
+	mEnabled = mEnabledNext;
+	mRecording = mRecordingNext;
+	mInFrame = true;
+
+	if( mTracingNext != mTracing )
+	{
+		std::lock_guard lock( mTraceMutex );
+		if( mTracingNext )
+		{
+			mTraceCpu.clear();
+			mTraceGpu.clear();
+			mTraceSpans.clear();
+			mTraceThreads.assign( 1, std::this_thread::get_id() );
+
+			// Frames still in flight belong to the previous trace
+			for( auto& frame : mGpuFrames )
+				frame.tracing = false;
+
+			mTraceEpoch = Clock::now();
+			glGetInteger64v( GL_TIMESTAMP, &mTraceGpuEpoch );
+		}
+
+		mTracing = mTracingNext;
+	}
+
+	// The slot was last used kProfilerFrames frames ago. Its results are
+	// collected even if profiling was just disabled.
+	++mFrame;
+
+	auto& frame = mGpuFrames[mFrame % kProfilerFrames];
+	resolve_( frame );
+	frame.recording = mRecording;
+	frame.tracing = mTracing;
+}
+
+void Profiler::end_frame()
+{
+	assert( mInFrame && mStack.empty() );
+	mInFrame = false;
+}
+
+std::vector<ProfileZoneStats> Profiler::stats() const
+{
+	std::vector<ProfileZoneStats> ret;
+	ret.reserve( mZones.size() );
+
+	for( auto const& zone : mZones )
+	{
+		if( 0 != zone.count )
+			ret.emplace_back( ProfileZoneStats{ zone.name, zone.clock, zone.depth, summarize_samples( std::span( zone.history.data(), zone.count ) ) } );
+	}
+
+	return ret;
+}
+
+std::vector<ProfileZoneStats> Profiler::recorded_stats() const
+{
+	std::vector<ProfileZoneStats> ret;
+	ret.reserve( mZones.size() );
+
+	for( auto const& zone : mZones )
+	{
+		if( !zone.recorded.empty() )
+			ret.emplace_back( ProfileZoneStats{ zone.name, zone.clock, zone.depth, summarize_samples( zone.recorded ) } );
+	}
+
+	return ret;
+}
+
+double Profiler::latest_ms( char const* aName, EProfileClock aClock ) const noexcept
+{
+	for( auto const& zone : mZones )
+	{
+		if( zone.clock == aClock && zone.name == aName )
+			return 0 != zone.count ? zone.history[(zone.next + kProfilerHistory-1) % kProfilerHistory] : -1.0;
+	}
+
+	return -1.0;
+}
+
+void Profiler::print_report( std::FILE* aOut ) const
+{
+	std::fprintf( aOut, "%-32s %5s %9s %9s %9s %8s\n", "zone", "clock", "min ms", "avg ms", "p99 ms", "samples" );
+	for( auto const& zone : stats() )
+	{
+		int const indent = int(2 * zone.depth);
+		std::fprintf( aOut, "%*s%-*s %5s %9.3f %9.3f %9.3f %8zu\n",
+			indent, "", 32 - indent, zone.name.c_str(),
+			EProfileClock::gpu == zone.clock ? "GPU" : "CPU",
+			zone.ms.minMs, zone.ms.avgMs, zone.ms.p99Ms, zone.ms.samples
+		);
+	}
+
+	if( mDroppedFrames )
+		std::fprintf( aOut, "(%zu frames of GPU results dropped)\n", mDroppedFrames );
+}
+
+std::size_t Profiler::dropped_frames() const noexcept
+{
+	return mDroppedFrames;
+}
+
+void Profiler::start_trace()
+{
+	mTracingNext = true;
+}
+void Profiler::stop_trace()
+{
+	mTracingNext = false;
+}
+bool Profiler::tracing() const noexcept
+{
+	return mTracingNext;
+}
+
+bool Profiler::trace_complete() const noexcept
+{
+	if( mTracing || mTracingNext )
+		return false;
+
+	for( auto const& frame : mGpuFrames )
+	{
+		if( frame.tracing )
+			return false;
+	}
+
+	return true;
+}
+
+void Profiler::write_trace( char const* aPath ) const
+{
+	std::FILE* fout = std::fopen( aPath, "w" );
+	if( !fout )
+		throw Error( "Unable to open '%s' for writing", aPath );
+
+	std::lock_guard lock( mTraceMutex );
+
+	// Track names. The first event has no leading comma.
+	std::fprintf( fout, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n" );
+	std::fprintf( fout, "{\"ph\": \"M\", \"name\": \"process_name\", \"pid\": %d, \"args\": {\"name\": \"CPU\"}}", kTraceCpuPid_ );
+	for( std::size_t i = 0; i < mTraceThreads.size(); ++i )
+	{
+		char name[32];
+		if( 0 == i )
+			std::snprintf( name, sizeof(name), "frame thread" );
+		else
+			std::snprintf( name, sizeof(name), "worker %zu", i );
+
+		std::fprintf( fout, ",\n{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": %d, \"tid\": %zu, \"args\": {\"name\": \"%s\"}}", kTraceCpuPid_, i, name );
+	}
+	std::fprintf( fout, ",\n{\"ph\": \"M\", \"name\": \"process_name\", \"pid\": %d, \"args\": {\"name\": \"GPU\"}}", kTraceGpuPid_ );
+	std::fprintf( fout, ",\n{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": %d, \"tid\": 0, \"args\": {\"name\": \"GL queue\"}}", kTraceGpuPid_ );
+
+	for( auto const& zone : mTraceCpu )
+		write_trace_span_( fout, mZones[zone.zone].name.c_str(), "zone", kTraceCpuPid_, 0, zone.begin, zone.end );
+	for( auto const& span : mTraceSpans )
+		write_trace_span_( fout, span.name, "job", kTraceCpuPid_, span.track, span.begin, span.end );
+	for( auto const& zone : mTraceGpu )
+		write_trace_span_( fout, mZones[zone.zone].name.c_str(), "gpu", kTraceGpuPid_, 0, zone.begin, zone.end );
+
+	std::fprintf( fout, "\n]}\n" );
+
+	if( 0 != std::fclose( fout ) )
+		throw Error( "Unable to write '%s'", aPath );
+}
+
+std::size_t Profiler::begin_zone( char const* aName, EProfileClock aClock )
+{
+	if( !(mEnabled || mTracing) || !mInFrame )
+		return kNoZone;
+
+	auto const zone = find_zone_( aName, aClock );
+
+	Open_ open{ zone, {}, 0 };
+	if( EProfileClock::gpu == aClock )
+		open.beginQuery = timestamp_();
+	else
+		open.begin = Clock::now();
+
+	mStack.emplace_back( open );
+	return zone;
+}
+
+void Profiler::end_zone( std::size_t aZone )
+{
+	assert( !mStack.empty() && aZone == mStack.back().zone );
+	auto const open = mStack.back();
+	mStack.pop_back();
+
+	if( EProfileClock::gpu == mZones[aZone].clock )
+	{
+		auto const end = timestamp_();
+		mGpuFrames[mFrame % kProfilerFrames].zones.emplace_back( GpuZone_{ aZone, open.beginQuery, end } );
+	}
+	else
+	{
+		auto const now = Clock::now();
+		std::chrono::duration<double, std::milli> const elapsed = now - open.begin;
+		add_sample_( aZone, elapsed.count(), mRecording );
+
+		if( mTracing )
+			mTraceCpu.emplace_back( TraceZone_{ aZone, trace_time_( open.begin ), trace_time_( now ) } );
+	}
+}
+
+void Profiler::add_trace_span( char const* aName, Clock::time_point aBegin, Clock::time_point aEnd )
+{
+	std::lock_guard lock( mTraceMutex );
+	if( !mTracing )
+		return;
+
+	// There are only a handful of threads
+	auto const id = std::this_thread::get_id();
+	auto const thread = std::find( mTraceThreads.begin(), mTraceThreads.end(), id );
+	auto const track = std::size_t(thread - mTraceThreads.begin());
+	if( mTraceThreads.end() == thread )
+		mTraceThreads.emplace_back( id );
+
+	mTraceSpans.emplace_back( TraceSpan_{ aName, track, trace_time_( aBegin ), trace_time_( aEnd ) } );
+}
+
+std::size_t Profiler::find_zone_( char const* aName, EProfileClock aClock )
+{
+	auto const parent = mStack.empty() ? kNoZone : mStack.back().zone;
+
+	// There are only a handful of zones
+	for( std::size_t i = 0; i < mZones.size(); ++i )
+	{
+		auto const& zone = mZones[i];
+		if( zone.parent == parent && zone.clock == aClock && zone.name == aName )
+			return i;
+	}
+
+	Zone_ zone{};
+	zone.name = aName;
+	zone.parent = parent;
+	zone.clock = aClock;
+	zone.depth = unsigned(mStack.size());
+	mZones.emplace_back( std::move(zone) );
+	return mZones.size() - 1;
+}
+
+void Profiler::add_sample_( std::size_t aZone, double aMs, bool aRecord )
+{
+	auto& zone = mZones[aZone];
+	zone.history[zone.next] = float(aMs);
+	zone.next = (zone.next + 1) % kProfilerHistory;
+	zone.count = std::min( zone.count + 1, kProfilerHistory );
+
+	if( aRecord )
+		zone.recorded.emplace_back( float(aMs) );
+}
+
+std::int64_t Profiler::trace_time_( Clock::time_point aTime ) const noexcept
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>( aTime - mTraceEpoch ).count();
+}
+
+std::size_t Profiler::timestamp_()
+{
+	auto& frame = mGpuFrames[mFrame % kProfilerFrames];
+	if( frame.used == frame.queries.size() )
+	{
+		// Grow by the same amount again; zones are opened in the same
+		// numbers every frame, so this settles quickly
+		auto const count = std::max( frame.queries.size(), std::size_t(16) );
+		frame.queries.resize( frame.queries.size() + count );
+		glGenQueries( GLsizei(count), frame.queries.data() + frame.used );
+	}
+
+	auto const index = frame.used++;
+	glQueryCounter( frame.queries[index], GL_TIMESTAMP );
+	return index;
+}
+
+void Profiler::resolve_( GpuFrame_& aFrame )
+{
+	// Never wait: if any query is still pending, the whole frame is dropped
+	bool available = true;
+	for( std::size_t i = 0; i < aFrame.used && available; ++i )
+	{
+		GLint ready = GL_FALSE;
+		glGetQueryObjectiv( aFrame.queries[i], GL_QUERY_RESULT_AVAILABLE, &ready );
+		available = GL_FALSE != ready;
+	}
+
+	if( !available )
+		++mDroppedFrames;
+	else
+	{
+		for( auto const& zone : aFrame.zones )
+		{
+			GLuint64 begin = 0, end = 0;
+			glGetQueryObjectui64v( aFrame.queries[zone.beginQuery], GL_QUERY_RESULT, &begin );
+			glGetQueryObjectui64v( aFrame.queries[zone.endQuery], GL_QUERY_RESULT, &end );
+			add_sample_( zone.zone, double(end - begin) * 1e-6, aFrame.recording );
+
+			if( aFrame.tracing )
+				mTraceGpu.emplace_back( TraceZone_{ zone.zone, std::int64_t(begin) - mTraceGpuEpoch, std::int64_t(end) - mTraceGpuEpoch } );
+		}
+	}
+
+	aFrame.used = 0;
+	aFrame.zones.clear();
+	aFrame.tracing = false;
+}
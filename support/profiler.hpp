@@ -0,0 +1,320 @@
+#ifndef PROFILER_HPP_5A1C7E92_3B60_4D8F_9E24_B7F0C3A68D15
+#define PROFILER_HPP_5A1C7E92_3B60_4D8F_9E24_B7F0C3A68D15
+
+#include <glad/glad.h>
+
+#include <span>
+#include <array>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+
+/* Runtime CPU/GPU profiler
+ *
+ * Code is timed by scoped zones:
+ *
+ *	{
+ *		PROFILE_GPU( "terrain" );
+ *		... draw calls ...
+ *	}
+ *
+ * PROFILE_CPU() zones measure the wall-clock time on the calling thread;
+ * PROFILE_GPU() zones place GL_TIMESTAMP queries before and after the
+ * commands issued in the scope. Zones nest; a zone is identified by its name
+ * and its parent zone, so the same name under different parents is reported
+ * separately.
+ *
+ * GPU results are read kProfilerFrames frames later, once the queries are
+ * known to be available (GL_QUERY_RESULT_AVAILABLE), so that reading them
+ * never stalls the pipeline. A frame whose queries still aren't available by
+ * then is dropped rather than waited for.
+ *
+ * Each zone keeps its last kProfilerHistory samples, over which the rolling
+ * min, average and 99th percentile are reported. While recording (see
+ * set_recording()), all samples are kept as well, e.g. for a benchmark run.
+ *
+ * Between start_trace() and stop_trace(), every zone is also kept as a span
+ * on a timeline, which write_trace() saves in the Chrome trace event format
+ * (chrome://tracing, https://ui.perfetto.dev). The thread that runs the
+ * frames, each worker thread and the GPU get a track each. GPU timestamps
+ * are moved onto the CPU clock with a single GL_TIMESTAMP reading taken
+ * when the trace starts.
+ *
+ * Profiling is toggled at runtime with set_enabled(); the change takes effect
+ * at the next begin_frame(). While neither profiling nor tracing, zones cost
+ * a branch. Zones refer to the current profiler (see make_current()) and are
+ * only allowed on the thread that calls begin_frame() and end_frame(). Other
+ * threads mark their work with PROFILE_TRACE(), which only goes into the
+ * trace.
+ */
+inline constexpr std::size_t kProfilerFrames = 4;
+inline constexpr std::size_t kProfilerHistory = 256;
+
+enum class EProfileClock
+{
+	cpu,
+	gpu
+};
+
+// Statistics of a set of timings, in milliseconds. Percentiles are
+// nearest-rank.
+struct ProfileSummary
+{
+	std::size_t samples;
+	double minMs;
+	double avgMs;
+	double p50Ms;
+	double p95Ms;
+	double p99Ms;
+};
+
+// All zeros if aSamples is empty
+ProfileSummary summarize_samples( std::span<float const> aSamples );
+
+struct ProfileZoneStats
+{
+	std::string name;
+	EProfileClock clock;
+	unsigned depth; // 0 for top-level zones
+
+	ProfileSummary ms;
+};
+
+// Owns the GPU timer queries. Move-only.
+class Profiler final
+{
+	public:
+		Profiler() noexcept;
+		~Profiler();
+
+		Profiler( Profiler const& ) = delete;
+		Profiler& operator= (Profiler const&) = delete;
+
+		Profiler( Profiler&& ) noexcept;
+		Profiler& operator= (Profiler&&) noexcept;
+
+	public:
+		// Zones opened by PROFILE_CPU() and PROFILE_GPU() go to this profiler.
+		// The profiler must stay at the same address while it is current.
+		void make_current() noexcept;
+
+		void set_enabled( bool ) noexcept;
+		bool enabled() const noexcept;
+
+		// Collects the GPU results of frames that have completed and starts
+		// a new frame. All zones must be closed.
+		void begin_frame();
+		void end_frame();
+
+		// Keeps every sample from the next begin_frame() on, until recording
+		// is turned off. GPU samples count towards the frame that issued
+		// them. Turning recording on discards earlier recorded samples.
+		void set_recording( bool );
+
+		// Rolling statistics. In the order in which the zones were first
+		// opened, so that each zone follows its parent.
+		std::vector<ProfileZoneStats> stats() const;
+
+		// Statistics of the recorded samples, in the same order
+		std::vector<ProfileZoneStats> recorded_stats() const;
+
+		// Latest sample of the first zone called aName on that clock, or a
+		// negative value if there is none
+		double latest_ms( char const* aName, EProfileClock ) const noexcept;
+
+		// Prints stats() as a table, indenting nested zones.
+		void print_report( std::FILE* ) const;
+
+		// Frames whose GPU results were dropped since they weren't available
+		// in time
+		std::size_t dropped_frames() const noexcept;
+
+		// Traces from the next begin_frame() on, until stop_trace(). Starting
+		// a trace discards the previous one. Zones are opened while tracing
+		// even if profiling is disabled.
+		void start_trace();
+		void stop_trace();
+		bool tracing() const noexcept;
+
+		// True once the trace has stopped and the GPU results of all its
+		// frames have been collected (or dropped)
+		bool trace_complete() const noexcept;
+
+		// Throws Error if the file can't be written.
+		void write_trace( char const* aPath ) const;
+
+	public:
+		// Used by ProfileScope; returns the zone's index, or kNoZone if the
+		// profiler is disabled.
+		static constexpr std::size_t kNoZone = ~std::size_t(0);
+
+		std::size_t begin_zone( char const* aName, EProfileClock );
+		void end_zone( std::size_t aZone );
+
+		// Used by TraceScope. Thread-safe; ignored unless tracing. aName must
+		// outlive the trace (a string literal).
+		using Clock = std::chrono::steady_clock;
+
+		void add_trace_span( char const* aName, Clock::time_point aBegin, Clock::time_point aEnd );
+
+		static Profiler* current() noexcept;
+
+	private:
+
+		struct Zone_
+		{
+			std::string name;
+			std::size_t parent;
+			EProfileClock clock;
+			unsigned depth;
+
+			std::array<float, kProfilerHistory> history;
+			std::size_t count; // samples taken, saturating at kProfilerHistory
+			std::size_t next;
+
+			std::vector<float> recorded;
+		};
+
+		struct Open_
+		{
+			std::size_t zone;
+			Clock::time_point begin; // CPU zones
+			std::size_t beginQuery;   // GPU zones
+		};
+
+		struct GpuZone_
+		{
+			std::size_t zone;
+			std::size_t beginQuery, endQuery;
+		};
+
+		// GPU zones of one frame. Queries are reused from frame to frame.
+		struct GpuFrame_
+		{
+			std::vector<GLuint> queries;
+			std::size_t used = 0;
+
+			std::vector<GpuZone_> zones;
+			bool recording = false;
+			bool tracing = false;
+		};
+
+		// Zone on the frame thread's or the GPU's track; nanoseconds since
+		// mTraceEpoch
+		struct TraceZone_
+		{
+			std::size_t zone;
+			std::int64_t begin, end;
+		};
+
+		// PROFILE_TRACE() span
+		struct TraceSpan_
+		{
+			char const* name;
+			std::size_t track; // index into mTraceThreads
+			std::int64_t begin, end;
+		};
+
+		std::size_t find_zone_( char const*, EProfileClock );
+		void add_sample_( std::size_t aZone, double aMs, bool aRecord );
+		std::int64_t trace_time_( Clock::time_point ) const noexcept;
+		std::size_t timestamp_();
+		void resolve_( GpuFrame_& );
+
+		std::vector<Zone_> mZones;
+		std::vector<Open_> mStack;
+
+		std::array<GpuFrame_, kProfilerFrames> mGpuFrames;
+		std::size_t mFrame;
+		std::size_t mDroppedFrames;
+
+		bool mEnabled;
+		bool mEnabledNext;
+		bool mRecording;
+		bool mRecordingNext;
+		bool mTracingNext;
+		bool mInFrame;
+
+		// Trace. mTracing and the spans are shared with other threads, and
+		// guarded by mTraceMutex.
+		Clock::time_point mTraceEpoch;
+		GLint64 mTraceGpuEpoch; // GL_TIMESTAMP at mTraceEpoch
+
+		std::vector<TraceZone_> mTraceCpu;
+		std::vector<TraceZone_> mTraceGpu;
+
+		mutable std::mutex mTraceMutex;
+		std::vector<TraceSpan_> mTraceSpans;
+		std::vector<std::thread::id> mTraceThreads; // [0] is the frame thread
+		bool mTracing;
+};
+
+// Opens a zone in the current profiler for the duration of the scope
+class ProfileScope final
+{
+	public:
+		ProfileScope( char const* aName, EProfileClock aClock )
+			: mProfiler( Profiler::current() )
+			, mZone( mProfiler ? mProfiler->begin_zone( aName, aClock ) : Profiler::kNoZone )
+		{}
+
+		~ProfileScope()
+		{
+			if( Profiler::kNoZone != mZone )
+				mProfiler->end_zone( mZone );
+		}
+
+		ProfileScope( ProfileScope const& ) = delete;
+		ProfileScope& operator= (ProfileScope const&) = delete;
+
+	private:
+		Profiler* mProfiler;
+		std::size_t mZone;
+};
+
+// Marks the scope as a span on the calling thread's track, if the current
+// profiler is tracing. Allowed on any thread; not part of the statistics.
+class TraceScope final
+{
+	public:
+		explicit TraceScope( char const* aName )
+			: mProfiler( Profiler::current() )
+			, mName( aName )
+			, mBegin( Profiler::Clock::now() )
+		{}
+
+		~TraceScope()
+		{
+			if( mProfiler )
+				mProfiler->add_trace_span( mName, mBegin, Profiler::Clock::now() );
+		}
+
+		TraceScope( TraceScope const& ) = delete;
+		TraceScope& operator= (TraceScope const&) = delete;
+
+	private:
+		Profiler* mProfiler;
+		char const* mName;
+		Profiler::Clock::time_point mBegin;
+};
+
+#define PROFILE_CONCAT_IMPL_( a, b ) a##b
+#define PROFILE_CONCAT_( a, b ) PROFILE_CONCAT_IMPL_( a, b )
+
+#define PROFILE_CPU( name ) \
+	::ProfileScope const PROFILE_CONCAT_( profileScope_, __LINE__ )( name, ::EProfileClock::cpu ) \
+	/*ENDM*/
+#define PROFILE_GPU( name ) \
+	::ProfileScope const PROFILE_CONCAT_( profileScope_, __LINE__ )( name, ::EProfileClock::gpu ) \
+	/*ENDM*/
+#define PROFILE_TRACE( name ) \
+	::TraceScope const PROFILE_CONCAT_( traceScope_, __LINE__ )( name ) \
+	/*ENDM*/
+
+#endif // PROFILER_HPP_5A1C7E92_3B60_4D8F_9E24_B7F0C3A68D15
@@ -1,7 +1,10 @@
 #include "program.hpp"
 
+#include <string>
 #include <vector>
 #include <utility>
+#include <algorithm>
+#include <string_view>
 
 #include <cstdio>
 
@@ -14,7 +17,8 @@ namespace
 {
 	GLuint load_shader_( 
 		GLenum aShaderType, 
-		char const* aSourcePath
+		char const* aSourcePath,
+		std::vector<std::string> const& aDefines
 	);
 
 	// lightweight std::experimental::scope_exit alternative
@@ -80,7 +84,7 @@ void ShaderProgram::reload()
 
 	// Load shaders
 	for( auto const& source : mSources )
-		shaders.emplace_back( load_shader_( source.type, source.sourcePath.c_str() ) );
+		shaders.emplace_back( load_shader_( source.type, source.sourcePath.c_str(), source.defines ) );
 
 	// Create program object
 	OGL_CHECKPOINT_ALWAYS();
@@ -139,7 +143,7 @@ void ShaderProgram::reload()
 
 namespace
 {
-	GLuint load_shader_( GLenum aShaderType, char const* aSourcePath )
+	GLuint load_shader_( GLenum aShaderType, char const* aSourcePath, std::vector<std::string> const& aDefines )
 	{
 		// Load the shader source code from file
 		std::vector<GLchar> source;
@@ -180,12 +184,39 @@ namespace
 
 		GLuint shader = glCreateShader( aShaderType );
 
+		// Defines must follow the #version directive, which has to come first.
+		// The source is therefore split after the #version line (if any), and
+		// the defines are passed as a separate string in between. The #line
+		// directive keeps the line numbers in the compile log correct.
+		std::size_t versionEnd = 0;
+		std::size_t versionLines = 0;
+		if( !aDefines.empty() )
+		{
+			std::string_view const view( source.data(), source.size() );
+			if( auto const pos = view.find( "#version" ); std::string_view::npos != pos )
+			{
+				auto const eol = view.find( '\n', pos );
+				versionEnd = std::string_view::npos == eol ? view.size() : eol+1;
+				versionLines = 1 + std::size_t(std::count( view.begin(), view.begin() + pos, '\n' ));
+			}
+		}
+
+		std::string defines;
+		for( auto const& define : aDefines )
+			defines += "#define " + define + "\n";
+		if( !defines.empty() )
+			defines += "#line " + std::to_string( versionLines+1 ) + "\n";
+
 		// Compile shader
 		GLchar const* sources[] = {
-			source.data()
+			source.data(),
+			defines.data(),
+			source.data() + versionEnd
 		};
 		GLsizei lengths[] = {
-			GLsizei(source.size())
+			GLsizei(versionEnd),
+			GLsizei(defines.size()),
+			GLsizei(source.size() - versionEnd)
 		};
 
 		glShaderSource( shader, sizeof(sources)/sizeof(sources[0]), sources, lengths );
@@ -16,6 +16,10 @@ class ShaderProgram final
 		{
 			GLenum type;
 			std::string sourcePath;
+
+			// Each entry "NAME" or "NAME VALUE" is inserted as a #define
+			// directive right after the #version line of the source.
+			std::vector<std::string> defines = {};
 		};
 
 	public:
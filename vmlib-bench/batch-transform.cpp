@@ -0,0 +1,74 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <vector>
+
+#include "../vmlib/transform.hpp"
+
+namespace
+{
+	std::vector<Vec3f> random_points_( std::size_t aCount )
+	{
+		std::mt19937 rng( 3811 );
+		std::uniform_real_distribution<float> dist( -5.f, 5.f );
+
+		std::vector<Vec3f> ret( aCount );
+		for( auto& p : ret )
+			p = Vec3f{ dist(rng), dist(rng), dist(rng) };
+		return ret;
+	}
+
+	// The transforms work in place. Give each run its own copy of the input,
+	// so that repeated application does not drift towards inf/denormals.
+	template< typename tFunc > inline
+	void measure_in_place_( Catch::Benchmark::Chronometer aMeter, std::vector<Vec3f> const& aInput, tFunc&& aFunc )
+	{
+		std::vector<std::vector<Vec3f>> data( std::size_t(aMeter.runs()), aInput );
+		aMeter.measure( [&] (int aRun) { aFunc( data[std::size_t(aRun)] ); } );
+	}
+}
+
+// 768 = 128 subdivisions * 6 vertices, i.e., the side of one rocket cylinder
+TEST_CASE( "Batch transforms", "[transform]" )
+{
+	auto const affine = make_translation( { 1.f, 2.f, 3.f } )
+		* make_rotation_z( 0.7f )
+		* make_scaling( 1.5f, 0.2f, 0.2f );
+	auto const projective = make_perspective_projection( 1.f, 1.5f, 0.1f, 100.f )
+		* make_translation( { 0.f, 0.f, -20.f } );
+	auto const normals = normal_matrix( affine );
+
+	auto const small = random_points_( 768 );
+	auto const large = random_points_( 65536 );
+
+	BENCHMARK_ADVANCED( "transform_positions affine x768" )( Catch::Benchmark::Chronometer meter )
+	{
+		measure_in_place_( meter, small, [&] (std::vector<Vec3f>& aData) { transform_positions( aData, affine ); } );
+	};
+	BENCHMARK_ADVANCED( "transform_positions affine (scalar reference) x768" )( Catch::Benchmark::Chronometer meter )
+	{
+		measure_in_place_( meter, small, [&] (std::vector<Vec3f>& aData) { detail::transform_positions_scalar( aData, affine ); } );
+	};
+
+	BENCHMARK_ADVANCED( "transform_positions affine x65536" )( Catch::Benchmark::Chronometer meter )
+	{
+		measure_in_place_( meter, large, [&] (std::vector<Vec3f>& aData) { transform_positions( aData, affine ); } );
+	};
+	BENCHMARK_ADVANCED( "transform_positions projective x65536" )( Catch::Benchmark::Chronometer meter )
+	{
+		measure_in_place_( meter, large, [&] (std::vector<Vec3f>& aData) { transform_positions( aData, projective ); } );
+	};
+	BENCHMARK_ADVANCED( "transform_positions projective (scalar reference) x65536" )( Catch::Benchmark::Chronometer meter )
+	{
+		measure_in_place_( meter, large, [&] (std::vector<Vec3f>& aData) { detail::transform_positions_scalar( aData, projective ); } );
+	};
+
+	BENCHMARK_ADVANCED( "transform_normals x65536" )( Catch::Benchmark::Chronometer meter )
+	{
+		measure_in_place_( meter, large, [&] (std::vector<Vec3f>& aData) { transform_normals( aData, normals ); } );
+	};
+	BENCHMARK_ADVANCED( "transform_normals (scalar reference) x65536" )( Catch::Benchmark::Chronometer meter )
+	{
+		measure_in_place_( meter, large, [&] (std::vector<Vec3f>& aData) { detail::transform_normals_scalar( aData, normals ); } );
+	};
+}
@@ -0,0 +1,96 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <string>
+#include <ostream>
+
+#include <cstdlib>
+
+/* Machine-readable benchmark output
+ *
+ * Select with "--reporter csv" (or "-r csv::out=results.csv" to write to a
+ * file, possibly alongside the default console reporter). One row is written
+ * per benchmark:
+ *
+ *   test,benchmark,samples,iterations,mean_ns,low_ns,high_ns,stddev_ns,
+ *   items,ns_per_item,items_per_sec
+ *
+ * Benchmarks that process several items per run (e.g. batch transforms)
+ * declare this with a trailing " xN" in their name, e.g. 
+ * "transform_positions x4096". Everything else counts as a single item.
+ */
+namespace
+{
+	std::size_t items_from_name_( std::string const& aName )
+	{
+		auto const pos = aName.rfind( " x" );
+		if( std::string::npos == pos )
+			return 1;
+
+		char* end = nullptr;
+		auto const items = std::strtoull( aName.c_str()+pos+2, &end, 10 );
+		if( 0 == items || '\0' != *end )
+			return 1;
+
+		return std::size_t(items);
+	}
+
+	std::string quoted_( std::string const& aStr )
+	{
+		std::string ret = "\"";
+		for( char const c : aStr )
+		{
+			if( '"' == c )
+				ret += '"';
+			ret += c;
+		}
+		ret += '"';
+		return ret;
+	}
+
+	class CsvBenchReporter_ final : public Catch::StreamingReporterBase
+	{
+		public:
+			using StreamingReporterBase::StreamingReporterBase;
+
+			static std::string getDescription()
+			{
+				return "Reports benchmark results as CSV (ns/op and throughput)";
+			}
+
+		public:
+			void testRunStarting( Catch::TestRunInfo const& aInfo ) override
+			{
+				StreamingReporterBase::testRunStarting( aInfo );
+				m_stream << "test,benchmark,samples,iterations,mean_ns,low_ns,high_ns,stddev_ns,items,ns_per_item,items_per_sec\n";
+			}
+
+			void benchmarkEnded( Catch::BenchmarkStats<> const& aStats ) override
+			{
+				auto const items = items_from_name_( aStats.info.name );
+				double const mean = aStats.mean.point.count();
+				double const perItem = mean / double(items);
+
+				m_stream
+					<< quoted_( currentTestCaseInfo->name ) << ','
+					<< quoted_( aStats.info.name ) << ','
+					<< aStats.info.samples << ','
+					<< aStats.info.iterations << ','
+					<< mean << ','
+					<< aStats.mean.lower_bound.count() << ','
+					<< aStats.mean.upper_bound.count() << ','
+					<< aStats.standardDeviation.point.count() << ','
+					<< items << ','
+					<< perItem << ','
+					<< (perItem > 0. ? 1e9 / perItem : 0.) << '\n'
+				;
+				m_stream.flush();
+			}
+
+			void benchmarkFailed( Catch::StringRef aError ) override
+			{
+				m_stream << "# benchmark failed: " << aError << '\n';
+			}
+	};
+}
+
+CATCH_REGISTER_REPORTER( "csv", CsvBenchReporter_ )
@@ -0,0 +1,72 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include "../vmlib/depth_sort.hpp"
+
+namespace
+{
+	struct Points_
+	{
+		std::vector<float> x, y, z;
+	};
+
+	Points_ random_points_( std::size_t aCount )
+	{
+		std::mt19937 rng( 3811 );
+		std::uniform_real_distribution<float> dist( -50.f, 50.f );
+
+		Points_ ret{ std::vector<float>( aCount ), std::vector<float>( aCount ), std::vector<float>( aCount ) };
+		for( std::size_t i = 0; i < aCount; ++i )
+		{
+			ret.x[i] = dist( rng );
+			ret.y[i] = dist( rng );
+			ret.z[i] = dist( rng );
+		}
+		return ret;
+	}
+}
+
+// The std::sort baseline orders the indices by a depth computed on the fly.
+TEST_CASE( "Depth sort", "[depthsort]" )
+{
+	Vec3f const eye{ 0.f, 5.f, 10.f };
+	Vec3f const forward = normalize( Vec3f{ 0.f, -0.3f, -1.f } );
+
+	for( std::size_t const count : { std::size_t(10000), std::size_t(100000), std::size_t(1000000) } )
+	{
+		auto const points = random_points_( count );
+		auto const name = " x" + std::to_string( count );
+
+		DepthSorter sorter;
+		sorter.sort( points.x, points.y, points.z, eye, forward );
+
+		BENCHMARK( "DepthSorter::sort" + name )
+		{
+			return sorter.sort( points.x, points.y, points.z, eye, forward ).front();
+		};
+
+		std::vector<std::uint32_t> keys( count );
+		BENCHMARK( "depth_keys" + name )
+		{
+			depth_keys( points.x, points.y, points.z, eye, forward, keys );
+			return keys.front();
+		};
+
+		std::vector<std::uint32_t> indices( count );
+		BENCHMARK( "std::sort by depth" + name )
+		{
+			std::iota( indices.begin(), indices.end(), std::uint32_t(0) );
+			std::sort( indices.begin(), indices.end(), [&] (std::uint32_t aA, std::uint32_t aB) {
+				auto const depth = [&] (std::uint32_t aI) {
+					return dot( Vec3f{ points.x[aI], points.y[aI], points.z[aI] } - eye, forward );
+				};
+				return depth( aA ) > depth( aB );
+			} );
+			return indices.front();
+		};
+	}
+}
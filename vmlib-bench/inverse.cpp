@@ -0,0 +1,47 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+
+#include "../vmlib/mat33.hpp"
+#include "../vmlib/mat44.hpp"
+
+// Compare the general inverse with the affine/rigid fast paths
+TEST_CASE( "Inverse", "[mat44][invert]" )
+{
+	std::mt19937 rng( 3811 );
+	std::uniform_real_distribution<float> dist( -3.f, 3.f );
+
+	// Inputs are generated at runtime so the compiler cannot fold them.
+	auto const rigid = make_rotation_x( dist(rng) )
+		* make_rotation_y( dist(rng) )
+		* make_translation( { dist(rng), dist(rng), dist(rng) } );
+	auto const affine = make_translation( { dist(rng), dist(rng), dist(rng) } )
+		* make_rotation_z( dist(rng) )
+		* make_scaling( 1.f + dist(rng)*dist(rng), 2.f, 0.5f );
+
+	BENCHMARK( "invert (general)" )
+	{
+		return invert( affine );
+	};
+	BENCHMARK( "invert (scalar reference)" )
+	{
+		return detail::invert_scalar( affine );
+	};
+	BENCHMARK( "invert_affine" )
+	{
+		return invert_affine( affine );
+	};
+	BENCHMARK( "invert_rigid" )
+	{
+		return invert_rigid( rigid );
+	};
+
+	BENCHMARK( "mat44_to_mat33(transpose(invert(M)))" )
+	{
+		return mat44_to_mat33( transpose( invert( affine ) ) );
+	};
+	BENCHMARK( "normal_matrix" )
+	{
+		return normal_matrix( affine );
+	};
+}
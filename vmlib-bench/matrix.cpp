@@ -0,0 +1,91 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <numbers>
+
+#include "../vmlib/mat33.hpp"
+#include "../vmlib/mat44.hpp"
+
+namespace
+{
+	Mat44f random_matrix_( std::mt19937& aRng )
+	{
+		std::uniform_real_distribution<float> dist( -10.f, 10.f );
+
+		Mat44f ret;
+		for( auto& v : ret.v )
+			v = dist( aRng );
+		return ret;
+	}
+}
+
+TEST_CASE( "Matrix products", "[mat44]" )
+{
+	std::mt19937 rng( 3811 );
+
+	// Inputs are generated at runtime so the compiler cannot fold them.
+	auto const left = random_matrix_( rng );
+	auto const right = random_matrix_( rng );
+	Vec4f const vec{ left(0,0), left(1,1), left(2,2), 1.f };
+
+	BENCHMARK( "Mat44f * Mat44f" )
+	{
+		return left * right;
+	};
+	BENCHMARK( "Mat44f * Mat44f (scalar reference)" )
+	{
+		return detail::mul_scalar( left, right );
+	};
+
+	BENCHMARK( "Mat44f * Vec4f" )
+	{
+		return left * vec;
+	};
+	BENCHMARK( "Mat44f * Vec4f (scalar reference)" )
+	{
+		return detail::mul_scalar( left, vec );
+	};
+
+	// The chain used for each object and view in main.cpp
+	BENCHMARK( "projection * world2camera * model2world" )
+	{
+		return left * right * left;
+	};
+}
+
+TEST_CASE( "Matrix builders", "[mat44]" )
+{
+	std::mt19937 rng( 3811 );
+	std::uniform_real_distribution<float> dist( -3.f, 3.f );
+
+	float const angle = dist( rng );
+	float const aspect = 1.5f + 0.1f*dist( rng );
+	Vec3f const offset{ dist(rng), dist(rng), dist(rng) };
+
+	BENCHMARK( "make_rotation_x" )
+	{
+		return make_rotation_x( angle );
+	};
+	BENCHMARK( "make_rotation_y" )
+	{
+		return make_rotation_y( angle );
+	};
+	BENCHMARK( "make_rotation_z" )
+	{
+		return make_rotation_z( angle );
+	};
+	BENCHMARK( "make_translation" )
+	{
+		return make_translation( offset );
+	};
+	BENCHMARK( "make_perspective_projection" )
+	{
+		return make_perspective_projection( 60.f * std::numbers::pi_v<float> / 180.f, aspect, 0.1f, 100.f );
+	};
+
+	// Camera setup as done per view in main.cpp
+	BENCHMARK( "world2camera (Rx * Ry * T)" )
+	{
+		return make_rotation_x( angle ) * make_rotation_y( -angle ) * make_translation( offset );
+	};
+}
@@ -0,0 +1,78 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <string>
+#include <random>
+#include <thread>
+
+#include "../vmlib/particles.hpp"
+
+#include "../support/job_system.hpp"
+
+namespace
+{
+	// Lives are long enough that no particle expires during the benchmark
+	// (the pools are updated in place, many thousand times). This measures
+	// the per-frame cost of integrating and scanning every live particle.
+	ParticlePool random_pool_( std::size_t aCount )
+	{
+		std::mt19937 rng( 3811 );
+		std::uniform_real_distribution<float> pos( -5.f, 5.f );
+		std::uniform_real_distribution<float> life( 1e4f, 2e4f );
+
+		ParticlePool ret( aCount );
+		for( std::size_t i = 0; i < aCount; ++i )
+			ret.emit( { pos(rng), pos(rng), pos(rng) }, { pos(rng), pos(rng), pos(rng) }, life(rng) );
+		return ret;
+	}
+}
+
+// One 60 Hz frame is 16.7 ms; the x1048576 update should take a small
+// fraction of that.
+TEST_CASE( "Particle update", "[particles]" )
+{
+	constexpr float kDeltaTime = 1.f / 60.f;
+
+	auto small = random_pool_( 4096 );
+	auto large = random_pool_( 1048576 );
+
+	BENCHMARK( "ParticlePool::update x4096" )
+	{
+		return small.update( kDeltaTime );
+	};
+	BENCHMARK( "ParticlePool::update (scalar reference) x4096" )
+	{
+		return detail::update_particles_scalar( small, kDeltaTime );
+	};
+
+	BENCHMARK( "ParticlePool::update x1048576" )
+	{
+		return large.update( kDeltaTime );
+	};
+	BENCHMARK( "ParticlePool::update (scalar reference) x1048576" )
+	{
+		return detail::update_particles_scalar( large, kDeltaTime );
+	};
+}
+
+// Scaling with the number of threads. The pool is split into chunks of
+// ParticlePool::kChunkSize that are spread over the threads.
+TEST_CASE( "Parallel particle update", "[particles][threads]" )
+{
+	constexpr float kDeltaTime = 1.f / 60.f;
+
+	auto pool = random_pool_( 4194304 );
+
+	auto const maxThreads = std::max( std::thread::hardware_concurrency(), 1u );
+	for( unsigned threads = 1; threads <= maxThreads; threads *= 2 )
+	{
+		JobSystem jobs( threads-1 );
+		auto const parallel_for = [&] (std::size_t aCount, auto const& aJob) {
+			jobs.parallel_for( aCount, aJob );
+		};
+
+		BENCHMARK( "ParticlePool::update " + std::to_string( threads ) + " threads x4194304" )
+		{
+			return pool.update( kDeltaTime, parallel_for );
+		};
+	}
+}
@@ -0,0 +1,31 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <vector>
+
+#include "../vmlib/vec3.hpp"
+
+TEST_CASE( "Vector functions", "[vec3]" )
+{
+	std::mt19937 rng( 3811 );
+	std::uniform_real_distribution<float> dist( -10.f, 10.f );
+
+	Vec3f const vec{ dist(rng), dist(rng), dist(rng) };
+
+	BENCHMARK( "normalize" )
+	{
+		return normalize( vec );
+	};
+
+	std::vector<Vec3f> vecs( 4096 );
+	for( auto& v : vecs )
+		v = Vec3f{ dist(rng), dist(rng), dist(rng) };
+
+	BENCHMARK( "normalize x4096" )
+	{
+		Vec3f sum{ 0.f, 0.f, 0.f };
+		for( auto const& v : vecs )
+			sum += normalize( v );
+		return sum;
+	};
+}
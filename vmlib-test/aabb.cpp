@@ -0,0 +1,72 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "../vmlib/aabb.hpp"
+
+TEST_CASE( "Axis-aligned bounding boxes", "[aabb]" )
+{
+	static constexpr float kEps_ = 1e-6f;
+
+	using namespace Catch::Matchers;
+
+	SECTION( "Empty" )
+	{
+		REQUIRE( is_empty( kEmptyAABB ) );
+		REQUIRE( is_empty( make_aabb( {} ) ) );
+
+		auto const single = expand( kEmptyAABB, Vec3f{ 1.f, 2.f, 3.f } );
+		REQUIRE( !is_empty( single ) );
+		REQUIRE( single.min.x == 1.f );
+		REQUIRE( single.max.z == 3.f );
+	}
+
+	SECTION( "From points" )
+	{
+		Vec3f const points[] = {
+			{ 1.f, -2.f, 0.5f },
+			{ -3.f, 4.f, 0.f },
+			{ 0.f, 0.f, 7.f }
+		};
+
+		auto const box = make_aabb( points );
+		REQUIRE( box.min.x == -3.f );
+		REQUIRE( box.min.y == -2.f );
+		REQUIRE( box.min.z == 0.f );
+		REQUIRE( box.max.x == 1.f );
+		REQUIRE( box.max.y == 4.f );
+		REQUIRE( box.max.z == 7.f );
+
+		auto const c = center( box );
+		REQUIRE_THAT( c.x, WithinAbs( -1.f, kEps_ ) );
+		REQUIRE_THAT( c.y, WithinAbs( 1.f, kEps_ ) );
+		REQUIRE_THAT( c.z, WithinAbs( 3.5f, kEps_ ) );
+
+		auto const e = extents( box );
+		REQUIRE_THAT( e.x, WithinAbs( 2.f, kEps_ ) );
+		REQUIRE_THAT( e.y, WithinAbs( 3.f, kEps_ ) );
+		REQUIRE_THAT( e.z, WithinAbs( 3.5f, kEps_ ) );
+	}
+
+	SECTION( "Merge" )
+	{
+		AABB const a{ { 0.f, 0.f, 0.f }, { 1.f, 1.f, 1.f } };
+		AABB const b{ { -1.f, 0.5f, 2.f }, { 0.5f, 3.f, 4.f } };
+
+		auto const m = merge( a, b );
+		REQUIRE( m.min.x == -1.f );
+		REQUIRE( m.max.y == 3.f );
+		REQUIRE( m.max.z == 4.f );
+
+		auto const same = merge( a, kEmptyAABB );
+		REQUIRE( same.min.x == a.min.x );
+		REQUIRE( same.max.z == a.max.z );
+	}
+
+	SECTION( "Distance" )
+	{
+		AABB const box{ { 0.f, 0.f, 0.f }, { 2.f, 2.f, 2.f } };
+
+		REQUIRE_THAT( distance( box, { 1.f, 1.f, 1.f } ), WithinAbs( 0.f, kEps_ ) );
+		REQUIRE_THAT( distance( box, { 5.f, 1.f, 1.f } ), WithinAbs( 3.f, kEps_ ) );
+		REQUIRE_THAT( distance( box, { -3.f, -4.f, 1.f } ), WithinAbs( 5.f, kEps_ ) );
+	}
+}
@@ -0,0 +1,82 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+
+#include "../vmlib/mat33.hpp"
+#include "../vmlib/mat44.hpp"
+
+// The special-case inverses must agree with the general invert() whenever
+// their preconditions hold.
+TEST_CASE( "Affine and rigid inverses", "[mat44][invert]" )
+{
+	static constexpr float kEps_ = 1e-4f;
+
+	using namespace Catch::Matchers;
+
+	std::mt19937 rng( 11 );
+	std::uniform_real_distribution<float> angle( -3.f, 3.f );
+	std::uniform_real_distribution<float> scale( 0.2f, 3.f );
+	std::uniform_real_distribution<float> offset( -20.f, 20.f );
+
+	SECTION( "Affine" )
+	{
+		for( int iter = 0; iter < 50; ++iter )
+		{
+			auto const mat = make_translation( { offset(rng), offset(rng), offset(rng) } )
+				* make_rotation_z( angle(rng) )
+				* make_rotation_x( angle(rng) )
+				* make_scaling( scale(rng), scale(rng), scale(rng) );
+
+			auto const general = invert( mat );
+			auto const affine = invert_affine( mat );
+
+			for( std::size_t i = 0; i < 16; ++i )
+				REQUIRE_THAT( affine.v[i], WithinAbs( general.v[i], kEps_ ) );
+		}
+	}
+
+	SECTION( "Rigid" )
+	{
+		for( int iter = 0; iter < 50; ++iter )
+		{
+			// Same structure as the world-to-camera transform in main.cpp
+			auto const mat = make_rotation_x( angle(rng) )
+				* make_rotation_y( angle(rng) )
+				* make_translation( { offset(rng), offset(rng), offset(rng) } );
+
+			auto const general = invert( mat );
+			auto const rigid = invert_rigid( mat );
+
+			for( std::size_t i = 0; i < 16; ++i )
+				REQUIRE_THAT( rigid.v[i], WithinAbs( general.v[i], kEps_ ) );
+		}
+	}
+}
+
+TEST_CASE( "Normal matrix", "[mat33][mat44]" )
+{
+	static constexpr float kEps_ = 1e-5f;
+
+	using namespace Catch::Matchers;
+
+	SECTION( "Non-uniform scale" )
+	{
+		auto const mat = make_translation( { 4.f, 5.f, 6.f } )
+			* make_rotation_y( 0.4f )
+			* make_scaling( 2.f, 0.5f, 3.f );
+
+		auto const reference = mat44_to_mat33( transpose( invert( mat ) ) );
+		auto const normal = normal_matrix( mat );
+
+		for( std::size_t i = 0; i < 9; ++i )
+			REQUIRE_THAT( normal.v[i], WithinAbs( reference.v[i], kEps_ ) );
+	}
+
+	SECTION( "Translation only" )
+	{
+		auto const normal = normal_matrix( make_translation( { 10.f, -3.f, 2.f } ) );
+
+		for( std::size_t i = 0; i < 9; ++i )
+			REQUIRE_THAT( normal.v[i], WithinAbs( kIdentity33f.v[i], kEps_ ) );
+	}
+}
@@ -0,0 +1,103 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <vector>
+
+#include "../vmlib/transform.hpp"
+
+namespace
+{
+	std::vector<Vec3f> random_points_( std::size_t aCount, std::mt19937& aRng )
+	{
+		std::uniform_real_distribution<float> dist( -5.f, 5.f );
+
+		std::vector<Vec3f> ret( aCount );
+		for( auto& p : ret )
+			p = Vec3f{ dist(aRng), dist(aRng), dist(aRng) };
+		return ret;
+	}
+}
+
+// Batch transforms must match transforming each element individually. Counts
+// that are not multiples of eight exercise the scalar tail.
+TEST_CASE( "Batch position transform", "[transform][simd]" )
+{
+	static constexpr float kEps_ = 1e-4f;
+
+	using namespace Catch::Matchers;
+
+	std::mt19937 rng( 3811 );
+
+	auto const count = GENERATE( std::size_t(0), std::size_t(1), std::size_t(7), std::size_t(8), std::size_t(9), std::size_t(389) );
+
+	SECTION( "Affine" )
+	{
+		auto const xform = make_translation( { 1.f, -2.f, 3.f } )
+			* make_rotation_z( 0.7f )
+			* make_scaling( 0.5f, 2.f, 1.5f );
+		REQUIRE( is_affine( xform ) );
+
+		auto points = random_points_( count, rng );
+		auto reference = points;
+
+		transform_positions( points, xform );
+
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			auto const& r = reference[i];
+			Vec4f const t = xform * Vec4f{ r.x, r.y, r.z, 1.f };
+
+			REQUIRE_THAT( points[i].x, WithinAbs( t.x, kEps_ ) );
+			REQUIRE_THAT( points[i].y, WithinAbs( t.y, kEps_ ) );
+			REQUIRE_THAT( points[i].z, WithinAbs( t.z, kEps_ ) );
+		}
+	}
+
+	SECTION( "Projective" )
+	{
+		auto const xform = make_perspective_projection( 1.f, 1.5f, 0.1f, 100.f )
+			* make_translation( { 0.f, 0.f, -20.f } );
+		REQUIRE( !is_affine( xform ) );
+
+		auto points = random_points_( count, rng );
+		auto reference = points;
+
+		transform_positions( points, xform );
+		detail::transform_positions_scalar( reference, xform );
+
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			REQUIRE_THAT( points[i].x, WithinAbs( reference[i].x, kEps_ ) );
+			REQUIRE_THAT( points[i].y, WithinAbs( reference[i].y, kEps_ ) );
+			REQUIRE_THAT( points[i].z, WithinAbs( reference[i].z, kEps_ ) );
+		}
+	}
+}
+
+TEST_CASE( "Batch normal transform", "[transform][simd]" )
+{
+	static constexpr float kEps_ = 1e-4f;
+
+	using namespace Catch::Matchers;
+
+	std::mt19937 rng( 4711 );
+
+	auto const count = GENERATE( std::size_t(3), std::size_t(16), std::size_t(133) );
+
+	auto const xform = make_rotation_x( 0.3f ) * make_rotation_y( -1.2f ) * make_scaling( 1.f, 3.f, 0.5f );
+	auto const N = mat44_to_mat33( transpose( invert( xform ) ) );
+
+	auto normals = random_points_( count, rng );
+	auto reference = normals;
+
+	transform_normals( normals, N );
+
+	for( std::size_t i = 0; i < count; ++i )
+	{
+		auto const t = N * reference[i];
+
+		REQUIRE_THAT( normals[i].x, WithinAbs( t.x, kEps_ ) );
+		REQUIRE_THAT( normals[i].y, WithinAbs( t.y, kEps_ ) );
+		REQUIRE_THAT( normals[i].z, WithinAbs( t.z, kEps_ ) );
+	}
+}
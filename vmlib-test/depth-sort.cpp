@@ -0,0 +1,128 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <bit>
+#include <random>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include "../vmlib/depth_sort.hpp"
+
+TEST_CASE( "Depth keys", "[depthsort]" )
+{
+	// Farther points have smaller keys
+	REQUIRE( depth_key( 2.f ) < depth_key( 1.f ) );
+	REQUIRE( depth_key( 1.f ) < depth_key( 0.f ) );
+	REQUIRE( depth_key( 0.f ) < depth_key( -1.f ) );
+	REQUIRE( depth_key( -1.f ) < depth_key( -2.f ) );
+	REQUIRE( depth_key( 1e-30f ) < depth_key( 0.f ) );
+	REQUIRE( depth_key( 0.f ) < depth_key( -1e-30f ) );
+	REQUIRE( depth_key( -0.f ) == depth_key( 0.f ) );
+}
+
+TEST_CASE( "Radix sort", "[depthsort]" )
+{
+	std::mt19937 rng( 3811 );
+
+	auto const count = GENERATE( std::size_t(0), std::size_t(1), std::size_t(100), std::size_t(5000) );
+
+	SECTION( "Random keys" )
+	{
+		std::uniform_int_distribution<std::uint32_t> dist;
+
+		std::vector<std::uint32_t> keys( count ), values( count ), keysScratch( count ), valuesScratch( count );
+		for( auto& k : keys )
+			k = dist( rng );
+		std::iota( values.begin(), values.end(), std::uint32_t(0) );
+
+		auto const original = keys;
+		radix_sort( keys, values, keysScratch, valuesScratch );
+
+		REQUIRE( std::is_sorted( keys.begin(), keys.end() ) );
+		for( std::size_t i = 0; i < count; ++i )
+			REQUIRE( original[values[i]] == keys[i] );
+	}
+
+	SECTION( "Stable, with skipped passes" )
+	{
+		// Only the second byte varies: three of the four passes are skipped,
+		// and the result is copied back from the scratch arrays.
+		std::uniform_int_distribution<std::uint32_t> dist( 0, 3 );
+
+		std::vector<std::uint32_t> keys( count ), values( count ), keysScratch( count ), valuesScratch( count );
+		for( auto& k : keys )
+			k = 0x12000034u | (dist( rng ) << 8);
+		std::iota( values.begin(), values.end(), std::uint32_t(0) );
+
+		auto const original = keys;
+		radix_sort( keys, values, keysScratch, valuesScratch );
+
+		std::vector<std::uint32_t> expected( count );
+		std::iota( expected.begin(), expected.end(), std::uint32_t(0) );
+		std::stable_sort( expected.begin(), expected.end(), [&] (std::uint32_t aA, std::uint32_t aB) {
+			return original[aA] < original[aB];
+		} );
+
+		REQUIRE( values == expected );
+	}
+}
+
+// Counts that are not multiples of eight exercise the scalar tail.
+TEST_CASE( "Depth sort", "[depthsort][simd]" )
+{
+	std::mt19937 rng( 4711 );
+	std::uniform_real_distribution<float> dist( -10.f, 10.f );
+
+	auto const count = GENERATE( std::size_t(0), std::size_t(7), std::size_t(8), std::size_t(389) );
+
+	std::vector<float> x( count ), y( count ), z( count );
+	for( std::size_t i = 0; i < count; ++i )
+	{
+		x[i] = dist( rng );
+		y[i] = dist( rng );
+		z[i] = dist( rng );
+	}
+
+	Vec3f const eye{ 1.f, 2.f, 3.f };
+	Vec3f const forward = normalize( Vec3f{ 0.3f, -0.2f, -1.f } );
+
+	SECTION( "Keys" )
+	{
+		std::vector<std::uint32_t> keys( count ), reference( count );
+		depth_keys( x, y, z, eye, forward, keys );
+		detail::depth_keys_scalar( x, y, z, eye, forward, reference );
+
+		using namespace Catch::Matchers;
+
+		// Undoes depth_key()
+		auto const depth = [] (std::uint32_t aKey) {
+			return std::bit_cast<float>( (aKey & 0x80000000u) ? aKey : (aKey ^ 0x7fffffffu) );
+		};
+
+		// FMA may round differently
+		for( std::size_t i = 0; i < count; ++i )
+			REQUIRE_THAT( depth( keys[i] ), WithinAbs( depth( reference[i] ), 1e-4f ) );
+	}
+
+	SECTION( "Back to front" )
+	{
+		using namespace Catch::Matchers;
+
+		DepthSorter sorter;
+		auto const order = sorter.sort( x, y, z, eye, forward );
+		REQUIRE( order.size() == count );
+
+		std::vector<bool> seen( count );
+		float previous = std::numeric_limits<float>::max();
+		for( auto const i : order )
+		{
+			REQUIRE( i < count );
+			REQUIRE( !seen[i] );
+			seen[i] = true;
+
+			float const depth = dot( Vec3f{ x[i], y[i], z[i] } - eye, forward );
+			REQUIRE( depth <= previous + 1e-4f );
+			previous = depth;
+		}
+	}
+}
@@ -0,0 +1,105 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <numbers>
+
+#include "../vmlib/frustum.hpp"
+
+namespace
+{
+	AABB box_at_( Vec3f aCenter, float aHalfSize )
+	{
+		Vec3f const h{ aHalfSize, aHalfSize, aHalfSize };
+		return AABB{ aCenter - h, aCenter + h };
+	}
+}
+
+TEST_CASE( "Frustum plane extraction", "[frustum][aabb]" )
+{
+	static constexpr float kEps_ = 1e-5f;
+
+	using namespace Catch::Matchers;
+
+	auto const proj = make_perspective_projection( 60.f * std::numbers::pi_v<float> / 180.f, 1.f, 0.1f, 100.f );
+
+	SECTION( "Near and far planes" )
+	{
+		// Camera looks down -z. Points in front of the near plane and beyond
+		// the far plane are on the outside.
+		auto const frustum = make_frustum( proj );
+
+		auto const eval_ = [] (Vec4f aPlane, Vec3f aP) {
+			return aPlane.x*aP.x + aPlane.y*aP.y + aPlane.z*aP.z + aPlane.w;
+		};
+
+		auto const& nearPlane = frustum.planes[Frustum::eNear];
+		auto const& farPlane = frustum.planes[Frustum::eFar];
+
+		REQUIRE_THAT( eval_( nearPlane, { 0.f, 0.f, -0.1f } ), WithinAbs( 0.f, kEps_ ) );
+		REQUIRE( eval_( nearPlane, { 0.f, 0.f, -1.f } ) > 0.f );
+		REQUIRE( eval_( nearPlane, { 0.f, 0.f, 0.f } ) < 0.f );
+
+		REQUIRE( eval_( farPlane, { 0.f, 0.f, -99.f } ) > 0.f );
+		REQUIRE( eval_( farPlane, { 0.f, 0.f, -101.f } ) < 0.f );
+	}
+
+	SECTION( "Boxes" )
+	{
+		auto const frustum = make_frustum( proj );
+
+		REQUIRE( intersects( frustum, box_at_( { 0.f, 0.f, -10.f }, 1.f ) ) );
+		REQUIRE( !intersects( frustum, box_at_( { 0.f, 0.f, 10.f }, 1.f ) ) );    // behind
+		REQUIRE( !intersects( frustum, box_at_( { 0.f, 0.f, -200.f }, 1.f ) ) );  // beyond far
+		REQUIRE( !intersects( frustum, box_at_( { 20.f, 0.f, -10.f }, 1.f ) ) );  // right
+		REQUIRE( !intersects( frustum, box_at_( { 0.f, -20.f, -10.f }, 1.f ) ) ); // below
+
+		// Partially inside
+		REQUIRE( intersects( frustum, box_at_( { 6.f, 0.f, -10.f }, 1.f ) ) );
+		// Containing the camera
+		REQUIRE( intersects( frustum, box_at_( { 0.f, 0.f, 0.f }, 5.f ) ) );
+	}
+
+	SECTION( "Model space" )
+	{
+		// With a model-to-world transform in the matrix, the planes are in
+		// model space.
+		auto const view = make_translation( { 0.f, 0.f, -10.f } );
+		auto const model = make_translation( { 100.f, 0.f, 0.f } );
+		auto const frustum = make_frustum( proj * view * model );
+
+		REQUIRE( intersects( frustum, box_at_( { -100.f, 0.f, 0.f }, 1.f ) ) );
+		REQUIRE( !intersects( frustum, box_at_( { 0.f, 0.f, 0.f }, 1.f ) ) );
+	}
+}
+
+TEST_CASE( "Frustum vs. bounding spheres", "[frustum][sphere]" )
+{
+	auto const proj = make_perspective_projection( 60.f * std::numbers::pi_v<float> / 180.f, 1.f, 0.1f, 100.f );
+	auto const frustum = make_frustum( proj );
+
+	SECTION( "Inside and outside" )
+	{
+		REQUIRE( intersects( frustum, BoundingSphere{ { 0.f, 0.f, -10.f }, 1.f } ) );
+		REQUIRE( !intersects( frustum, BoundingSphere{ { 0.f, 0.f, 10.f }, 1.f } ) );   // behind
+		REQUIRE( !intersects( frustum, BoundingSphere{ { 0.f, 0.f, -200.f }, 1.f } ) ); // beyond far
+		REQUIRE( !intersects( frustum, BoundingSphere{ { -20.f, 0.f, -10.f }, 1.f } ) ); // left
+		REQUIRE( !intersects( frustum, BoundingSphere{ { 0.f, 20.f, -10.f }, 1.f } ) );  // above
+	}
+
+	SECTION( "Radius is measured in world units" )
+	{
+		// At z = -10, the right plane is at x = 10 tan(30deg) ~ 5.77. The
+		// planes are not normalized, so this checks that the test scales the
+		// radius accordingly.
+		REQUIRE( !intersects( frustum, BoundingSphere{ { 8.f, 0.f, -10.f }, 1.f } ) );
+		REQUIRE( intersects( frustum, BoundingSphere{ { 8.f, 0.f, -10.f }, 2.f } ) );
+
+		// Straddling the near plane
+		REQUIRE( intersects( frustum, BoundingSphere{ { 0.f, 0.f, 0.4f }, 0.6f } ) );
+		REQUIRE( !intersects( frustum, BoundingSphere{ { 0.f, 0.f, 0.4f }, 0.3f } ) );
+	}
+
+	SECTION( "Empty" )
+	{
+		REQUIRE( !intersects( frustum, kEmptySphere ) );
+	}
+}
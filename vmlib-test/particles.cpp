@@ -0,0 +1,140 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+
+#include "../vmlib/particles.hpp"
+
+namespace
+{
+	// Lives in [0, 2] seconds; with a 0.5 s step, about a quarter expire.
+	ParticlePool random_pool_( std::size_t aCount, std::mt19937& aRng )
+	{
+		std::uniform_real_distribution<float> pos( -5.f, 5.f );
+		std::uniform_real_distribution<float> life( 0.01f, 2.f );
+
+		ParticlePool ret( aCount );
+		for( std::size_t i = 0; i < aCount; ++i )
+		{
+			ret.emit( { pos(aRng), pos(aRng), pos(aRng) }, { pos(aRng), pos(aRng), pos(aRng) }, life(aRng) );
+		}
+		return ret;
+	}
+}
+
+TEST_CASE( "Particle pool", "[particles]" )
+{
+	SECTION( "Capacity" )
+	{
+		ParticlePool pool( 2 );
+		REQUIRE( pool.emit( { 0.f, 0.f, 0.f }, { 1.f, 0.f, 0.f }, 1.f ) );
+		REQUIRE( pool.emit( { 0.f, 0.f, 0.f }, { 1.f, 0.f, 0.f }, 1.f ) );
+		REQUIRE( !pool.emit( { 0.f, 0.f, 0.f }, { 1.f, 0.f, 0.f }, 1.f ) );
+		REQUIRE( 2 == pool.size() );
+
+		pool.clear();
+		REQUIRE( 0 == pool.size() );
+		REQUIRE( 2 == pool.capacity() );
+	}
+
+	SECTION( "Swap-remove" )
+	{
+		ParticlePool pool( 3 );
+		pool.emit( { 1.f, 0.f, 0.f }, { 0.f, 0.f, 0.f }, 0.5f );
+		pool.emit( { 2.f, 0.f, 0.f }, { 0.f, 0.f, 0.f }, 2.f );
+		pool.emit( { 3.f, 0.f, 0.f }, { 0.f, 0.f, 0.f }, 2.f );
+
+		auto const bounds = pool.update( 1.f );
+
+		// The last particle takes the place of the expired first one
+		REQUIRE( 2 == pool.size() );
+		REQUIRE( 3.f == pool.x()[0] );
+		REQUIRE( 2.f == pool.x()[1] );
+
+		REQUIRE( 2.f == bounds.min.x );
+		REQUIRE( 3.f == bounds.max.x );
+	}
+}
+
+// The SIMD update must match the scalar reference. Counts that are not
+// multiples of eight exercise the scalar tail.
+TEST_CASE( "Particle update", "[particles][simd]" )
+{
+	static constexpr float kEps_ = 1e-4f;
+
+	using namespace Catch::Matchers;
+
+	std::mt19937 rng( 3811 );
+
+	auto const count = GENERATE( std::size_t(0), std::size_t(1), std::size_t(7), std::size_t(8), std::size_t(9), std::size_t(389) );
+
+	auto pool = random_pool_( count, rng );
+	auto reference = pool;
+
+	auto const bounds = pool.update( 0.5f );
+	auto const referenceBounds = detail::update_particles_scalar( reference, 0.5f );
+
+	REQUIRE( pool.size() == reference.size() );
+	for( std::size_t i = 0; i < pool.size(); ++i )
+	{
+		REQUIRE( pool.life()[i] > 0.f );
+		REQUIRE_THAT( pool.life()[i], WithinAbs( reference.life()[i], kEps_ ) );
+		REQUIRE_THAT( pool.x()[i], WithinAbs( reference.x()[i], kEps_ ) );
+		REQUIRE_THAT( pool.y()[i], WithinAbs( reference.y()[i], kEps_ ) );
+		REQUIRE_THAT( pool.z()[i], WithinAbs( reference.z()[i], kEps_ ) );
+	}
+
+	REQUIRE( is_empty( bounds ) == is_empty( referenceBounds ) );
+	if( !is_empty( bounds ) )
+	{
+		REQUIRE_THAT( bounds.min.x, WithinAbs( referenceBounds.min.x, kEps_ ) );
+		REQUIRE_THAT( bounds.min.y, WithinAbs( referenceBounds.min.y, kEps_ ) );
+		REQUIRE_THAT( bounds.min.z, WithinAbs( referenceBounds.min.z, kEps_ ) );
+		REQUIRE_THAT( bounds.max.x, WithinAbs( referenceBounds.max.x, kEps_ ) );
+		REQUIRE_THAT( bounds.max.y, WithinAbs( referenceBounds.max.y, kEps_ ) );
+		REQUIRE_THAT( bounds.max.z, WithinAbs( referenceBounds.max.z, kEps_ ) );
+	}
+}
+
+// Chunks may be processed in any order (e.g., on several threads); results
+// must not depend on it.
+TEST_CASE( "Particle chunks", "[particles]" )
+{
+	ParticleEmitter const emitter{ 1.f, 0.5f, { 0.f, -2.f, 0.f }, 0.4f };
+
+	// Three chunks, the last one partial
+	std::size_t const count = 2 * ParticlePool::kChunkSize + 389;
+
+	auto const reversed = [] (std::size_t aChunks, auto const& aJob) {
+		for( std::size_t i = aChunks; i > 0; --i )
+			aJob( i-1 );
+	};
+
+	ParticlePool pool( count ), reference( count );
+	pool.emit( { 0.f, 0.f, 0.f }, { 0.f, 0.f, 0.f }, 0.25f );
+	reference.emit( { 0.f, 0.f, 0.f }, { 0.f, 0.f, 0.f }, 0.25f );
+
+	REQUIRE( count-1 == pool.emit( count, { 1.f, 2.f, 3.f }, emitter, 3811, reversed ) );
+	REQUIRE( count-1 == reference.emit( count, { 1.f, 2.f, 3.f }, emitter, 3811 ) );
+
+	auto const bounds = pool.update( 0.5f, reversed );
+	auto const referenceBounds = reference.update( 0.5f );
+
+	REQUIRE( count-1 == pool.size() );
+	REQUIRE( pool.size() == reference.size() );
+	for( std::size_t i = 0; i < pool.size(); ++i )
+	{
+		REQUIRE( pool.x()[i] == reference.x()[i] );
+		REQUIRE( pool.y()[i] == reference.y()[i] );
+		REQUIRE( pool.z()[i] == reference.z()[i] );
+		REQUIRE( pool.life()[i] == reference.life()[i] );
+	}
+
+	REQUIRE( bounds.min.x == referenceBounds.min.x );
+	REQUIRE( bounds.max.y == referenceBounds.max.y );
+	REQUIRE( bounds.max.z == referenceBounds.max.z );
+
+	// Velocities are within the spread
+	REQUIRE( bounds.min.x >= 1.f );
+	REQUIRE( bounds.max.x <= 1.f + 0.5f * 0.4f );
+	REQUIRE( bounds.max.y <= 2.f + 0.5f * (-2.f + 0.4f) );
+}
@@ -0,0 +1,146 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+
+#include "../vmlib/mat44.hpp"
+
+namespace
+{
+	// Deterministic pseudo-random matrices with entries in [-10, 10]
+	Mat44f random_matrix_( std::mt19937& aRng )
+	{
+		std::uniform_real_distribution<float> dist( -10.f, 10.f );
+
+		Mat44f ret;
+		for( auto& v : ret.v )
+			v = dist( aRng );
+		return ret;
+	}
+
+	// A typical model/view style transform (rotate, scale, translate)
+	Mat44f random_transform_( std::mt19937& aRng )
+	{
+		std::uniform_real_distribution<float> angle( -3.f, 3.f );
+		std::uniform_real_distribution<float> scale( 0.1f, 4.f );
+		std::uniform_real_distribution<float> offset( -50.f, 50.f );
+
+		return make_translation( { offset(aRng), offset(aRng), offset(aRng) } )
+			* make_rotation_x( angle(aRng) )
+			* make_rotation_y( angle(aRng) )
+			* make_scaling( scale(aRng), scale(aRng), scale(aRng) )
+		;
+	}
+}
+
+// The SIMD code paths must match the scalar reference implementations up to
+// rounding. Without FMA the multiplications are bit-identical; with FMA (or
+// for the inverse, which uses a different algorithm) we allow a few ulps.
+TEST_CASE( "SIMD matrix-matrix multiplication matches scalar", "[mat44][simd]" )
+{
+	static constexpr float kEps_ = 1e-4f;
+	static constexpr float kRel_ = 1e-5f;
+
+	using namespace Catch::Matchers;
+
+	std::mt19937 rng( 42 );
+
+	for( int iter = 0; iter < 100; ++iter )
+	{
+		auto const left = random_matrix_( rng );
+		auto const right = random_matrix_( rng );
+
+		auto const simd = left * right;
+		auto const scalar = detail::mul_scalar( left, right );
+
+		for( std::size_t i = 0; i < 16; ++i )
+			REQUIRE_THAT( simd.v[i], WithinAbs( scalar.v[i], kEps_ ) || WithinRel( scalar.v[i], kRel_ ) );
+	}
+}
+
+TEST_CASE( "SIMD matrix-vector multiplication matches scalar", "[mat44][vec4][simd]" )
+{
+	static constexpr float kEps_ = 1e-4f;
+	static constexpr float kRel_ = 1e-5f;
+
+	using namespace Catch::Matchers;
+
+	std::mt19937 rng( 1337 );
+	std::uniform_real_distribution<float> dist( -10.f, 10.f );
+
+	for( int iter = 0; iter < 100; ++iter )
+	{
+		auto const mat = random_matrix_( rng );
+		Vec4f const vec{ dist(rng), dist(rng), dist(rng), dist(rng) };
+
+		auto const simd = mat * vec;
+		auto const scalar = detail::mul_scalar( mat, vec );
+
+		for( std::size_t i = 0; i < 4; ++i )
+			REQUIRE_THAT( simd[i], WithinAbs( scalar[i], kEps_ ) || WithinRel( scalar[i], kRel_ ) );
+	}
+}
+
+TEST_CASE( "SIMD inverse matches scalar", "[mat44][invert][simd]" )
+{
+	static constexpr float kEps_ = 1e-5f;
+	static constexpr float kRel_ = 1e-4f;
+
+	using namespace Catch::Matchers;
+
+	std::mt19937 rng( 7 );
+
+	SECTION( "Transforms" )
+	{
+		for( int iter = 0; iter < 100; ++iter )
+		{
+			auto const mat = random_transform_( rng );
+
+			auto const simd = invert( mat );
+			auto const scalar = detail::invert_scalar( mat );
+
+			for( std::size_t i = 0; i < 16; ++i )
+				REQUIRE_THAT( simd.v[i], WithinAbs( scalar.v[i], kEps_ ) || WithinRel( scalar.v[i], kRel_ ) );
+		}
+	}
+
+	SECTION( "Projection" )
+	{
+		auto const proj = make_perspective_projection( 1.0471976f, 16.f/9.f, 0.1f, 100.f );
+
+		auto const simd = invert( proj );
+		auto const scalar = detail::invert_scalar( proj );
+
+		for( std::size_t i = 0; i < 16; ++i )
+			REQUIRE_THAT( simd.v[i], WithinAbs( scalar.v[i], kEps_ ) || WithinRel( scalar.v[i], kRel_ ) );
+	}
+
+	SECTION( "Inverse times matrix is identity" )
+	{
+		for( int iter = 0; iter < 100; ++iter )
+		{
+			auto const mat = random_transform_( rng );
+			auto const ident = invert( mat ) * mat;
+
+			for( std::size_t i = 0; i < 16; ++i )
+				REQUIRE_THAT( ident.v[i], WithinAbs( kIdentity44f.v[i], 1e-4f ) );
+		}
+	}
+}
+
+TEST_CASE( "Matrix multiplication in constant expressions", "[mat44][simd]" )
+{
+	// The operators must remain usable at compile time, where they fall back
+	// to the scalar implementation.
+	constexpr Mat44f twice = kIdentity44f * Mat44f{ {
+		2.f, 0.f, 0.f, 0.f,
+		0.f, 2.f, 0.f, 0.f,
+		0.f, 0.f, 2.f, 0.f,
+		0.f, 0.f, 0.f, 2.f
+	} };
+	static_assert( twice(0,0) == 2.f && twice(3,3) == 2.f && twice(0,1) == 0.f );
+
+	constexpr Vec4f vec = twice * Vec4f{ 1.f, 2.f, 3.f, 4.f };
+	static_assert( vec.x == 2.f && vec.w == 8.f );
+
+	SUCCEED();
+}
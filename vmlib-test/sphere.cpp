@@ -0,0 +1,48 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "../vmlib/sphere.hpp"
+
+TEST_CASE( "Bounding spheres", "[sphere]" )
+{
+	static constexpr float kEps_ = 1e-5f;
+
+	using namespace Catch::Matchers;
+
+	SECTION( "Empty" )
+	{
+		REQUIRE( is_empty( kEmptySphere ) );
+		REQUIRE( is_empty( make_bounding_sphere( kEmptyAABB ) ) );
+		REQUIRE( is_empty( make_bounding_sphere( std::span<Vec3f const>{} ) ) );
+	}
+
+	SECTION( "From box" )
+	{
+		auto const sphere = make_bounding_sphere( AABB{ { -1.f, 0.f, 2.f }, { 1.f, 2.f, 4.f } } );
+
+		REQUIRE_THAT( sphere.center.x, WithinAbs( 0.f, kEps_ ) );
+		REQUIRE_THAT( sphere.center.y, WithinAbs( 1.f, kEps_ ) );
+		REQUIRE_THAT( sphere.center.z, WithinAbs( 3.f, kEps_ ) );
+		REQUIRE_THAT( sphere.radius, WithinAbs( std::sqrt( 3.f ), kEps_ ) );
+	}
+
+	SECTION( "From points" )
+	{
+		// Octahedron: the box has corners at distance sqrt(3), but all points
+		// are at distance 1 from the center.
+		Vec3f const points[] = {
+			{ 1.f, 0.f, 0.f }, { -1.f, 0.f, 0.f },
+			{ 0.f, 1.f, 0.f }, { 0.f, -1.f, 0.f },
+			{ 0.f, 0.f, 1.f }, { 0.f, 0.f, -1.f }
+		};
+
+		auto const sphere = make_bounding_sphere( points );
+
+		REQUIRE_THAT( sphere.center.x, WithinAbs( 0.f, kEps_ ) );
+		REQUIRE_THAT( sphere.center.y, WithinAbs( 0.f, kEps_ ) );
+		REQUIRE_THAT( sphere.center.z, WithinAbs( 0.f, kEps_ ) );
+		REQUIRE_THAT( sphere.radius, WithinAbs( 1.f, kEps_ ) );
+
+		for( auto const& p : points )
+			REQUIRE( length( p - sphere.center ) <= sphere.radius + kEps_ );
+	}
+}
@@ -0,0 +1,81 @@
+#ifndef AABB_HPP_50093122_EB51_49BE_83E9_CFB560170393
+#define AABB_HPP_50093122_EB51_49BE_83E9_CFB560170393
+
+#include <span>
+#include <limits>
+#include <algorithm>
+
+#include "vec3.hpp"
+
+// Axis-aligned bounding box. An empty box has min > max (see kEmptyAABB), so
+// that expanding it by a point yields a box containing just that point.
+struct AABB
+{
+	Vec3f min;
+	Vec3f max;
+};
+
+constexpr AABB kEmptyAABB = {
+	{ std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() },
+	{ -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max() }
+};
+
+constexpr
+bool is_empty( AABB const& aBox ) noexcept
+{
+	return aBox.min.x > aBox.max.x || aBox.min.y > aBox.max.y || aBox.min.z > aBox.max.z;
+}
+
+constexpr
+AABB expand( AABB const& aBox, Vec3f aPoint ) noexcept
+{
+	return AABB{
+		{ std::min( aBox.min.x, aPoint.x ), std::min( aBox.min.y, aPoint.y ), std::min( aBox.min.z, aPoint.z ) },
+		{ std::max( aBox.max.x, aPoint.x ), std::max( aBox.max.y, aPoint.y ), std::max( aBox.max.z, aPoint.z ) }
+	};
+}
+
+constexpr
+AABB merge( AABB const& aLeft, AABB const& aRight ) noexcept
+{
+	return AABB{
+		{ std::min( aLeft.min.x, aRight.min.x ), std::min( aLeft.min.y, aRight.min.y ), std::min( aLeft.min.z, aRight.min.z ) },
+		{ std::max( aLeft.max.x, aRight.max.x ), std::max( aLeft.max.y, aRight.max.y ), std::max( aLeft.max.z, aRight.max.z ) }
+	};
+}
+
+constexpr
+AABB make_aabb( std::span<Vec3f const> aPoints ) noexcept
+{
+	AABB ret = kEmptyAABB;
+	for( auto const& p : aPoints )
+		ret = expand( ret, p );
+	return ret;
+}
+
+constexpr
+Vec3f center( AABB const& aBox ) noexcept
+{
+	return 0.5f * (aBox.min + aBox.max);
+}
+
+// Half of the size of the box along each axis
+constexpr
+Vec3f extents( AABB const& aBox ) noexcept
+{
+	return 0.5f * (aBox.max - aBox.min);
+}
+
+// Distance from the point to the closest point in the box (zero if inside)
+inline
+float distance( AABB const& aBox, Vec3f aPoint ) noexcept
+{
+	Vec3f const d{
+		std::max( { aBox.min.x - aPoint.x, 0.f, aPoint.x - aBox.max.x } ),
+		std::max( { aBox.min.y - aPoint.y, 0.f, aPoint.y - aBox.max.y } ),
+		std::max( { aBox.min.z - aPoint.z, 0.f, aPoint.z - aBox.max.z } )
+	};
+	return length( d );
+}
+
+#endif // AABB_HPP_50093122_EB51_49BE_83E9_CFB560170393
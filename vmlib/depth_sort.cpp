@@ -0,0 +1,137 @@
+#include "depth_sort.hpp"
+
+#include <array>
+#include <numeric>
+#include <algorithm>
+
+#include <cassert>
+
+#include "simd.hpp"
+
+namespace
+{
+#	if defined(VMLIB_SIMD_AVX)
+	// Returns the number of keys computed (a multiple of eight). AVX has no
+	// 256-bit integer operations, so the key is built with float bitwise ops.
+	std::size_t depth_keys_avx_( float const* aX, float const* aY, float const* aZ, std::size_t aCount, Vec3f aEye, Vec3f aForward, std::uint32_t* aKeys ) noexcept
+	{
+		std::size_t const count = aCount & ~std::size_t(7);
+
+		__m256 const fx = _mm256_set1_ps( aForward.x );
+		__m256 const fy = _mm256_set1_ps( aForward.y );
+		__m256 const fz = _mm256_set1_ps( aForward.z );
+
+		// Depth of the eye, subtracted once instead of per component
+		__m256 const eyeDepth = _mm256_set1_ps( dot( aEye, aForward ) );
+
+		__m256 const zero = _mm256_setzero_ps();
+		__m256 const magnitude = _mm256_castsi256_ps( _mm256_set1_epi32( 0x7fffffff ) );
+
+		for( std::size_t i = 0; i < count; i += 8 )
+		{
+			__m256 depth = _mm256_mul_ps( _mm256_loadu_ps( aX+i ), fx );
+			depth = detail::madd_( _mm256_loadu_ps( aY+i ), fy, depth );
+			depth = detail::madd_( _mm256_loadu_ps( aZ+i ), fz, depth );
+			depth = _mm256_sub_ps( depth, eyeDepth );
+
+			// See depth_key(); adding +0 turns -0 into +0
+			depth = _mm256_add_ps( depth, zero );
+			__m256 const negative = _mm256_cmp_ps( depth, zero, _CMP_LT_OQ );
+			__m256 const key = _mm256_xor_ps( depth, _mm256_andnot_ps( negative, magnitude ) );
+
+			_mm256_storeu_si256( reinterpret_cast<__m256i*>(aKeys+i), _mm256_castps_si256( key ) );
+		}
+
+		return count;
+	}
+#	endif // ~ VMLIB_SIMD_AVX
+}
+
+void radix_sort( std::span<std::uint32_t> aKeys, std::span<std::uint32_t> aValues, std::span<std::uint32_t> aKeysScratch, std::span<std::uint32_t> aValuesScratch ) noexcept
+{
+	assert( aValues.size() == aKeys.size() );
+	assert( aKeysScratch.size() == aKeys.size() && aValuesScratch.size() == aKeys.size() );
+
+	// Histograms of all four digits in a single pass over the keys
+	std::array<std::array<std::uint32_t, 256>, 4> counts{};
+	for( auto const key : aKeys )
+	{
+		++counts[0][key & 0xff];
+		++counts[1][(key >> 8) & 0xff];
+		++counts[2][(key >> 16) & 0xff];
+		++counts[3][key >> 24];
+	}
+
+	auto keys = aKeys, values = aValues;
+	auto keysOut = aKeysScratch, valuesOut = aValuesScratch;
+
+	for( unsigned pass = 0; pass < 4; ++pass )
+	{
+		auto& offsets = counts[pass];
+
+		// Nothing to do if every key has the same digit
+		if( std::find( offsets.begin(), offsets.end(), std::uint32_t(aKeys.size()) ) != offsets.end() )
+			continue;
+
+		std::exclusive_scan( offsets.begin(), offsets.end(), offsets.begin(), std::uint32_t(0) );
+
+		unsigned const shift = 8 * pass;
+		for( std::size_t i = 0; i < keys.size(); ++i )
+		{
+			auto const dst = offsets[(keys[i] >> shift) & 0xff]++;
+			keysOut[dst] = keys[i];
+			valuesOut[dst] = values[i];
+		}
+
+		std::swap( keys, keysOut );
+		std::swap( values, valuesOut );
+	}
+
+	// After an odd number of passes, the result is in the scratch arrays
+	if( keys.data() != aKeys.data() )
+	{
+		std::copy( keys.begin(), keys.end(), aKeys.begin() );
+		std::copy( values.begin(), values.end(), aValues.begin() );
+	}
+}
+
+std::span<std::uint32_t const> DepthSorter::sort( std::span<float const> aX, std::span<float const> aY, std::span<float const> aZ, Vec3f aEye, Vec3f aForward )
+{
+	auto const count = aX.size();
+
+	// resize() only allocates if the count grows past anything seen before
+	mKeys.resize( count );
+	mKeysScratch.resize( count );
+	mIndices.resize( count );
+	mIndicesScratch.resize( count );
+
+	depth_keys( aX, aY, aZ, aEye, aForward, mKeys );
+	std::iota( mIndices.begin(), mIndices.end(), std::uint32_t(0) );
+
+	radix_sort( mKeys, mIndices, mKeysScratch, mIndicesScratch );
+	return mIndices;
+}
+
+void depth_keys( std::span<float const> aX, std::span<float const> aY, std::span<float const> aZ, Vec3f aEye, Vec3f aForward, std::span<std::uint32_t> aKeys ) noexcept
+{
+	assert( aY.size() == aX.size() && aZ.size() == aX.size() && aKeys.size() == aX.size() );
+
+#	if defined(VMLIB_SIMD_AVX)
+	auto const done = depth_keys_avx_( aX.data(), aY.data(), aZ.data(), aX.size(), aEye, aForward, aKeys.data() );
+	aX = aX.subspan( done );
+	aY = aY.subspan( done );
+	aZ = aZ.subspan( done );
+	aKeys = aKeys.subspan( done );
+#	endif
+
+	detail::depth_keys_scalar( aX, aY, aZ, aEye, aForward, aKeys );
+}
+
+void detail::depth_keys_scalar( std::span<float const> aX, std::span<float const> aY, std::span<float const> aZ, Vec3f aEye, Vec3f aForward, std::span<std::uint32_t> aKeys ) noexcept
+{
+	float const eyeDepth = dot( aEye, aForward );
+	for( std::size_t i = 0; i < aKeys.size(); ++i )
+	{
+		aKeys[i] = depth_key( aX[i] * aForward.x + aY[i] * aForward.y + aZ[i] * aForward.z - eyeDepth );
+	}
+}
@@ -0,0 +1,65 @@
+#ifndef DEPTH_SORT_HPP_7B3E9D14_C62A_4F80_95E1_0A8D4C7F2B56
+#define DEPTH_SORT_HPP_7B3E9D14_C62A_4F80_95E1_0A8D4C7F2B56
+
+#include <bit>
+#include <span>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "vec3.hpp"
+
+/* Back-to-front ordering for alpha blending
+ *
+ * Points are ordered by their depth along the view direction. The depth is
+ * turned into a 32-bit key that sorts in the desired order as an unsigned
+ * integer (see depth_key()), and the keys are sorted with an LSD radix sort
+ * (8 bits per pass). With AVX, the keys are computed eight at a time.
+ *
+ * The compute shader in assets/cw2/particle_sort.comp uses the same keys.
+ */
+
+// Key for a depth along the view direction. Keys compare in the opposite
+// order of the depths (the farthest point has the smallest key).
+constexpr
+std::uint32_t depth_key( float aDepth ) noexcept
+{
+	// Flip the magnitude of non-negative floats. Negative floats already
+	// compare in reverse as unsigned integers, and have the sign bit set, so
+	// they end up after all non-negative ones. Adding +0 turns -0 into +0;
+	// otherwise -0 would get the largest key, after all negative depths.
+	auto const bits = std::bit_cast<std::uint32_t>( aDepth + 0.f );
+	return (bits >> 31) ? bits : (bits ^ 0x7fffffffu);
+}
+
+// Sorts aKeys in increasing order and moves aValues along (stable). The
+// scratch arrays must have the same size as the keys; their contents are
+// overwritten. Passes in which all keys share the same digit are skipped.
+void radix_sort( std::span<std::uint32_t> aKeys, std::span<std::uint32_t> aValues, std::span<std::uint32_t> aKeysScratch, std::span<std::uint32_t> aValuesScratch ) noexcept;
+
+// Sorts points back to front. The buffers are kept between calls, so that
+// sorting the same number of points every frame doesn't allocate.
+class DepthSorter final
+{
+	public:
+		// Indices of the points (aX[i], aY[i], aZ[i]) from the farthest to
+		// the nearest along aForward, as seen from aEye. The result stays
+		// valid until the next call.
+		std::span<std::uint32_t const> sort( std::span<float const> aX, std::span<float const> aY, std::span<float const> aZ, Vec3f aEye, Vec3f aForward );
+
+	private:
+		std::vector<std::uint32_t> mKeys, mKeysScratch;
+		std::vector<std::uint32_t> mIndices, mIndicesScratch;
+};
+
+// Depth keys of the points; aKeys must have the same size as the points.
+void depth_keys( std::span<float const> aX, std::span<float const> aY, std::span<float const> aZ, Vec3f aEye, Vec3f aForward, std::span<std::uint32_t> aKeys ) noexcept;
+
+// Scalar reference implementation (see mat44.hpp).
+namespace detail
+{
+	void depth_keys_scalar( std::span<float const> aX, std::span<float const> aY, std::span<float const> aZ, Vec3f aEye, Vec3f aForward, std::span<std::uint32_t> aKeys ) noexcept;
+}
+
+#endif // DEPTH_SORT_HPP_7B3E9D14_C62A_4F80_95E1_0A8D4C7F2B56
@@ -0,0 +1,92 @@
+#ifndef FRUSTUM_HPP_A572B19C_E9EE_4616_9BF9_993BF4B593DF
+#define FRUSTUM_HPP_A572B19C_E9EE_4616_9BF9_993BF4B593DF
+
+#include "vec3.hpp"
+#include "vec4.hpp"
+#include "mat44.hpp"
+#include "aabb.hpp"
+#include "sphere.hpp"
+
+/* View frustum as six planes
+ *
+ * Each plane is stored as (a, b, c, d); a point p is on the inner side of the
+ * plane if a*p.x + b*p.y + c*p.z + d >= 0. The planes are not normalized.
+ *
+ * make_frustum() extracts the planes from a projection matrix (Gribb &
+ * Hartmann, "Fast Extraction of Viewing Frustum Planes from the World-View-
+ * Projection Matrix"). The planes are in the space that the matrix maps from,
+ * i.e., pass projection*view for world-space planes, or
+ * projection*view*model to test model-space bounds directly.
+ */
+struct Frustum
+{
+	enum EPlane
+	{
+		eLeft, eRight,
+		eBottom, eTop,
+		eNear, eFar,
+
+		ePlaneCount
+	};
+
+	Vec4f planes[ePlaneCount];
+};
+
+constexpr
+Frustum make_frustum( Mat44f const& aProjView ) noexcept
+{
+	Vec4f const r0{ aProjView(0,0), aProjView(0,1), aProjView(0,2), aProjView(0,3) };
+	Vec4f const r1{ aProjView(1,0), aProjView(1,1), aProjView(1,2), aProjView(1,3) };
+	Vec4f const r2{ aProjView(2,0), aProjView(2,1), aProjView(2,2), aProjView(2,3) };
+	Vec4f const r3{ aProjView(3,0), aProjView(3,1), aProjView(3,2), aProjView(3,3) };
+
+	// OpenGL clip space: -w <= x,y,z <= w
+	return Frustum{ {
+		r3 + r0, r3 - r0,
+		r3 + r1, r3 - r1,
+		r3 + r2, r3 - r2
+	} };
+}
+
+// False if the box is completely outside of the frustum. Conservative: boxes
+// near the frustum's corners may be reported as intersecting.
+constexpr
+bool intersects( Frustum const& aFrustum, AABB const& aBox ) noexcept
+{
+	for( auto const& p : aFrustum.planes )
+	{
+		// Corner of the box furthest along the plane normal
+		Vec3f const v{
+			p.x >= 0.f ? aBox.max.x : aBox.min.x,
+			p.y >= 0.f ? aBox.max.y : aBox.min.y,
+			p.z >= 0.f ? aBox.max.z : aBox.min.z
+		};
+
+		if( p.x*v.x + p.y*v.y + p.z*v.z + p.w < 0.f )
+			return false;
+	}
+
+	return true;
+}
+
+// False if the sphere is completely outside of the frustum. Conservative like
+// the box test above.
+constexpr
+bool intersects( Frustum const& aFrustum, BoundingSphere const& aSphere ) noexcept
+{
+	if( is_empty( aSphere ) )
+		return false;
+
+	for( auto const& p : aFrustum.planes )
+	{
+		// The planes aren't normalized: the signed distance is d / |n|. Compare
+		// squares to avoid the square root.
+		auto const d = p.x*aSphere.center.x + p.y*aSphere.center.y + p.z*aSphere.center.z + p.w;
+		if( d < 0.f && d*d > aSphere.radius*aSphere.radius * (p.x*p.x + p.y*p.y + p.z*p.z) )
+			return false;
+	}
+
+	return true;
+}
+
+#endif // FRUSTUM_HPP_A572B19C_E9EE_4616_9BF9_993BF4B593DF
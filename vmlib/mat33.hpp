@@ -82,4 +82,31 @@ Mat33f mat44_to_mat33( Mat44f const& aM )
 	return ret;
 }
 
+// Matrix for transforming normals with the affine transform aM. This is
+// equivalent to mat44_to_mat33(transpose(invert(aM))), but only computes the
+// 3x3 cofactor matrix of the upper left block (divided by its determinant).
+// The translation and the last row of aM are ignored.
+inline
+Mat33f normal_matrix( Mat44f const& aM ) noexcept
+{
+	Mat33f ret;
+	ret(0,0) = aM(1,1)*aM(2,2) - aM(1,2)*aM(2,1);
+	ret(0,1) = aM(1,2)*aM(2,0) - aM(1,0)*aM(2,2);
+	ret(0,2) = aM(1,0)*aM(2,1) - aM(1,1)*aM(2,0);
+	ret(1,0) = aM(0,2)*aM(2,1) - aM(0,1)*aM(2,2);
+	ret(1,1) = aM(0,0)*aM(2,2) - aM(0,2)*aM(2,0);
+	ret(1,2) = aM(0,1)*aM(2,0) - aM(0,0)*aM(2,1);
+	ret(2,0) = aM(0,1)*aM(1,2) - aM(0,2)*aM(1,1);
+	ret(2,1) = aM(0,2)*aM(1,0) - aM(0,0)*aM(1,2);
+	ret(2,2) = aM(0,0)*aM(1,1) - aM(0,1)*aM(1,0);
+
+	float const d = aM(0,0) * ret(0,0) + aM(0,1) * ret(0,1) + aM(0,2) * ret(0,2);
+	float const invD = 1.f / d;
+
+	for( auto& v : ret.v )
+		v *= invD;
+
+	return ret;
+}
+
 #endif // MAT33_HPP_61F3107B_CBE4_48DE_9F39_EA959B4BF694
@@ -2,6 +2,48 @@
 // SOLUTION_TAGS: gl-(ex-[^1234]|cw-2)
 
 Mat44f invert( Mat44f const& aM ) noexcept
+{
+#	if defined(VMLIB_SIMD_SSE2)
+	return detail::invert_simd( aM );
+#	else
+	return detail::invert_scalar( aM );
+#	endif
+}
+
+Mat44f invert_affine( Mat44f const& aM ) noexcept
+{
+	// For M = ⎛ A  t ⎞  the inverse is  ⎛ A⁻¹  -A⁻¹t ⎞
+	//         ⎝ 0  1 ⎠                  ⎝ 0     1    ⎠
+	//
+	// A⁻¹ is computed from the 3x3 cofactors: A⁻¹ = adj(A) / det(A), where
+	// adj(A) is the transpose of the cofactor matrix.
+	Mat44f ret = kIdentity44f;
+	ret(0,0) = aM(1,1)*aM(2,2) - aM(1,2)*aM(2,1);
+	ret(0,1) = aM(0,2)*aM(2,1) - aM(0,1)*aM(2,2);
+	ret(0,2) = aM(0,1)*aM(1,2) - aM(0,2)*aM(1,1);
+	ret(1,0) = aM(1,2)*aM(2,0) - aM(1,0)*aM(2,2);
+	ret(1,1) = aM(0,0)*aM(2,2) - aM(0,2)*aM(2,0);
+	ret(1,2) = aM(0,2)*aM(1,0) - aM(0,0)*aM(1,2);
+	ret(2,0) = aM(1,0)*aM(2,1) - aM(1,1)*aM(2,0);
+	ret(2,1) = aM(0,1)*aM(2,0) - aM(0,0)*aM(2,1);
+	ret(2,2) = aM(0,0)*aM(1,1) - aM(0,1)*aM(1,0);
+
+	float const d = aM(0,0) * ret(0,0) + aM(0,1) * ret(1,0) + aM(0,2) * ret(2,0);
+	float const invD = 1.f / d;
+
+	for( std::size_t i = 0; i < 3; ++i )
+	{
+		for( std::size_t j = 0; j < 3; ++j )
+			ret(i,j) *= invD;
+	}
+
+	for( std::size_t i = 0; i < 3; ++i )
+		ret(i,3) = -(ret(i,0)*aM(0,3) + ret(i,1)*aM(1,3) + ret(i,2)*aM(2,3));
+
+	return ret;
+}
+
+Mat44f detail::invert_scalar( Mat44f const& aM ) noexcept
 {
 	// We could implement this with any number of methods, including Gaussian
 	// Elimination or similar. However, straight line solutions exist for small
@@ -68,3 +110,111 @@ Mat44f invert( Mat44f const& aM ) noexcept
 	return ret;
 }
 
+#if defined(VMLIB_SIMD_SSE2)
+namespace
+{
+	// Helpers for the block-wise inverse below. A 2x2 matrix is kept in a
+	// single __m128 in row-major order, i.e., (m00, m01, m10, m11).
+	template< int tX, int tY, int tZ, int tW > inline
+	__m128 swizzle_( __m128 aV ) noexcept
+	{
+		return _mm_shuffle_ps( aV, aV, _MM_SHUFFLE( tW, tZ, tY, tX ) );
+	}
+	template< int tX, int tY, int tZ, int tW > inline
+	__m128 shuffle_( __m128 aA, __m128 aB ) noexcept
+	{
+		return _mm_shuffle_ps( aA, aB, _MM_SHUFFLE( tW, tZ, tY, tX ) );
+	}
+
+	// A*B
+	inline
+	__m128 mat2_mul_( __m128 aA, __m128 aB ) noexcept
+	{
+		return _mm_add_ps(
+			_mm_mul_ps( aA, swizzle_<0,3,0,3>(aB) ),
+			_mm_mul_ps( swizzle_<1,0,3,2>(aA), swizzle_<2,1,2,1>(aB) )
+		);
+	}
+	// adj(A)*B
+	inline
+	__m128 mat2_adj_mul_( __m128 aA, __m128 aB ) noexcept
+	{
+		return _mm_sub_ps(
+			_mm_mul_ps( swizzle_<3,3,0,0>(aA), aB ),
+			_mm_mul_ps( swizzle_<1,1,2,2>(aA), swizzle_<2,3,0,1>(aB) )
+		);
+	}
+	// A*adj(B)
+	inline
+	__m128 mat2_mul_adj_( __m128 aA, __m128 aB ) noexcept
+	{
+		return _mm_sub_ps(
+			_mm_mul_ps( aA, swizzle_<3,0,3,0>(aB) ),
+			_mm_mul_ps( swizzle_<1,0,3,2>(aA), swizzle_<2,1,2,1>(aB) )
+		);
+	}
+}
+
+Mat44f detail::invert_simd( Mat44f const& aM ) noexcept
+{
+	// Block-wise inverse. Split the matrix into four 2x2 blocks
+	//
+	//   M = ⎛ A  B ⎞
+	//       ⎝ C  D ⎠
+	//
+	// and use the 2x2 adjugates (written X# below) to form the blocks of the
+	// inverse without any branches. See e.g.
+	// https://lxjk.github.io/2017/09/03/Fast-4x4-Matrix-Inverse-with-SSE-SIMD-Explained.html
+	__m128 const r0 = _mm_loadu_ps( aM.v+0 );
+	__m128 const r1 = _mm_loadu_ps( aM.v+4 );
+	__m128 const r2 = _mm_loadu_ps( aM.v+8 );
+	__m128 const r3 = _mm_loadu_ps( aM.v+12 );
+
+	__m128 const A = _mm_movelh_ps( r0, r1 );
+	__m128 const B = _mm_movehl_ps( r1, r0 );
+	__m128 const C = _mm_movelh_ps( r2, r3 );
+	__m128 const D = _mm_movehl_ps( r3, r2 );
+
+	// Determinants of the blocks as (|A|, |B|, |C|, |D|)
+	__m128 const detSub = _mm_sub_ps(
+		_mm_mul_ps( shuffle_<0,2,0,2>( r0, r2 ), shuffle_<1,3,1,3>( r1, r3 ) ),
+		_mm_mul_ps( shuffle_<1,3,1,3>( r0, r2 ), shuffle_<0,2,0,2>( r1, r3 ) )
+	);
+	__m128 const detA = swizzle_<0,0,0,0>( detSub );
+	__m128 const detB = swizzle_<1,1,1,1>( detSub );
+	__m128 const detC = swizzle_<2,2,2,2>( detSub );
+	__m128 const detD = swizzle_<3,3,3,3>( detSub );
+
+	__m128 const D_C = mat2_adj_mul_( D, C );
+	__m128 const A_B = mat2_adj_mul_( A, B );
+
+	// Adjugates of the blocks of the inverse
+	__m128 X_ = _mm_sub_ps( _mm_mul_ps( detD, A ), mat2_mul_( B, D_C ) );
+	__m128 W_ = _mm_sub_ps( _mm_mul_ps( detA, D ), mat2_mul_( C, A_B ) );
+	__m128 Y_ = _mm_sub_ps( _mm_mul_ps( detB, C ), mat2_mul_adj_( D, A_B ) );
+	__m128 Z_ = _mm_sub_ps( _mm_mul_ps( detC, B ), mat2_mul_adj_( A, D_C ) );
+
+	// |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+	__m128 tr = _mm_mul_ps( A_B, swizzle_<0,2,1,3>( D_C ) );
+	tr = _mm_add_ps( tr, swizzle_<2,3,0,1>( tr ) );
+	tr = _mm_add_ps( tr, swizzle_<1,0,3,2>( tr ) );
+
+	__m128 detM = _mm_add_ps( _mm_mul_ps( detA, detD ), _mm_mul_ps( detB, detC ) );
+	detM = _mm_sub_ps( detM, tr );
+
+	__m128 const rDetM = _mm_div_ps( _mm_setr_ps( 1.f, -1.f, -1.f, 1.f ), detM );
+
+	X_ = _mm_mul_ps( X_, rDetM );
+	Y_ = _mm_mul_ps( Y_, rDetM );
+	Z_ = _mm_mul_ps( Z_, rDetM );
+	W_ = _mm_mul_ps( W_, rDetM );
+
+	// Apply the final adjugate shuffle while storing the rows
+	Mat44f ret;
+	_mm_storeu_ps( ret.v+0, shuffle_<3,1,3,1>( X_, Y_ ) );
+	_mm_storeu_ps( ret.v+4, shuffle_<2,0,2,0>( X_, Y_ ) );
+	_mm_storeu_ps( ret.v+8, shuffle_<3,1,3,1>( Z_, W_ ) );
+	_mm_storeu_ps( ret.v+12, shuffle_<2,0,2,0>( Z_, W_ ) );
+	return ret;
+}
+#endif // ~ VMLIB_SIMD_SSE2
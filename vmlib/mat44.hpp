@@ -5,7 +5,9 @@
 #include <cmath>
 #include <cassert>
 #include <cstdlib>
+#include <type_traits>
 
+#include "simd.hpp"
 #include "vec3.hpp"
 #include "vec4.hpp"
 
@@ -54,40 +56,165 @@ constexpr Mat44f kIdentity44f = { {
 	0.f, 0.f, 0.f, 1.f
 } };
 
+// Scalar reference implementations.
+//
+// The operators below use the SIMD paths from simd.hpp when they are
+// available. The scalar versions are still used for constant evaluation and
+// when building with VMLIB_NO_SIMD. The unit tests compare the two.
+namespace detail
+{
+	constexpr
+	Mat44f mul_scalar( Mat44f const& aLeft, Mat44f const& aRight ) noexcept
+	{
+		Mat44f result{};
+		for (int i = 0; i < 4; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				float sum = 0.f;
+				for (int k = 0; k < 4; ++k) {
+					sum += aLeft(i, k) * aRight(k, j);
+				}
+				result(i, j) = sum;
+			}
+		}
+		return result;
+	}
+
+	constexpr
+	Vec4f mul_scalar( Mat44f const& aLeft, Vec4f const& aRight ) noexcept
+	{
+		Vec4f result;
+		result.x = aLeft(0, 0) * aRight.x + aLeft(0, 1) * aRight.y + aLeft(0, 2) * aRight.z + aLeft(0, 3) * aRight.w;
+		result.y = aLeft(1, 0) * aRight.x + aLeft(1, 1) * aRight.y + aLeft(1, 2) * aRight.z + aLeft(1, 3) * aRight.w;
+		result.z = aLeft(2, 0) * aRight.x + aLeft(2, 1) * aRight.y + aLeft(2, 2) * aRight.z + aLeft(2, 3) * aRight.w;
+		result.w = aLeft(3, 0) * aRight.x + aLeft(3, 1) * aRight.y + aLeft(3, 2) * aRight.z + aLeft(3, 3) * aRight.w;
+		return result;
+	}
+
+	Mat44f invert_scalar( Mat44f const& aM ) noexcept;
+
+#	if defined(VMLIB_SIMD_SSE2)
+	inline
+	Mat44f mul_simd( Mat44f const& aLeft, Mat44f const& aRight ) noexcept
+	{
+		// Row i of the result is sum_k aLeft(i,k) * row k of aRight.
+#		if defined(VMLIB_SIMD_AVX)
+		// Two result rows per 256-bit register: the rows of aRight are
+		// duplicated into both lanes, and the in-lane shuffles broadcast
+		// aLeft(i,k) for row i in the low lane and row i+1 in the high lane.
+		__m256 const b0 = _mm256_broadcast_ps( reinterpret_cast<__m128 const*>(aRight.v+0) );
+		__m256 const b1 = _mm256_broadcast_ps( reinterpret_cast<__m128 const*>(aRight.v+4) );
+		__m256 const b2 = _mm256_broadcast_ps( reinterpret_cast<__m128 const*>(aRight.v+8) );
+		__m256 const b3 = _mm256_broadcast_ps( reinterpret_cast<__m128 const*>(aRight.v+12) );
+
+		Mat44f result;
+		for( std::size_t i = 0; i < 16; i += 8 )
+		{
+			__m256 const a = _mm256_loadu_ps( aLeft.v+i );
+			__m256 r = _mm256_mul_ps( _mm256_shuffle_ps( a, a, 0x00 ), b0 );
+			r = madd_( _mm256_shuffle_ps( a, a, 0x55 ), b1, r );
+			r = madd_( _mm256_shuffle_ps( a, a, 0xaa ), b2, r );
+			r = madd_( _mm256_shuffle_ps( a, a, 0xff ), b3, r );
+			_mm256_storeu_ps( result.v+i, r );
+		}
+		return result;
+#		else // SSE2
+		__m128 const b0 = _mm_loadu_ps( aRight.v+0 );
+		__m128 const b1 = _mm_loadu_ps( aRight.v+4 );
+		__m128 const b2 = _mm_loadu_ps( aRight.v+8 );
+		__m128 const b3 = _mm_loadu_ps( aRight.v+12 );
+
+		Mat44f result;
+		for( std::size_t i = 0; i < 16; i += 4 )
+		{
+			__m128 const a = _mm_loadu_ps( aLeft.v+i );
+			__m128 r = _mm_mul_ps( _mm_shuffle_ps( a, a, 0x00 ), b0 );
+			r = madd_( _mm_shuffle_ps( a, a, 0x55 ), b1, r );
+			r = madd_( _mm_shuffle_ps( a, a, 0xaa ), b2, r );
+			r = madd_( _mm_shuffle_ps( a, a, 0xff ), b3, r );
+			_mm_storeu_ps( result.v+i, r );
+		}
+		return result;
+#		endif
+	}
+
+	inline
+	Vec4f mul_simd( Mat44f const& aLeft, Vec4f const& aRight ) noexcept
+	{
+		// The matrix is row-major, so transpose it to get its columns and
+		// accumulate column j scaled by component j of the vector.
+		__m128 c0 = _mm_loadu_ps( aLeft.v+0 );
+		__m128 c1 = _mm_loadu_ps( aLeft.v+4 );
+		__m128 c2 = _mm_loadu_ps( aLeft.v+8 );
+		__m128 c3 = _mm_loadu_ps( aLeft.v+12 );
+		_MM_TRANSPOSE4_PS( c0, c1, c2, c3 );
+
+		__m128 r = _mm_mul_ps( c0, _mm_set1_ps( aRight.x ) );
+		r = madd_( c1, _mm_set1_ps( aRight.y ), r );
+		r = madd_( c2, _mm_set1_ps( aRight.z ), r );
+		r = madd_( c3, _mm_set1_ps( aRight.w ), r );
+
+		Vec4f result;
+		_mm_storeu_ps( &result.x, r );
+		return result;
+	}
+
+	Mat44f invert_simd( Mat44f const& aM ) noexcept;
+#	endif // ~ VMLIB_SIMD_SSE2
+}
+
 // Common operators for Mat44f.
-// Note that you will need to implement these yourself.
 
 constexpr
 Mat44f operator*( Mat44f const& aLeft, Mat44f const& aRight ) noexcept
 {
-	Mat44f result{};
-	for (int i = 0; i < 4; ++i) {
-		for (int j = 0; j < 4; ++j) {
-			float sum = 0.f;
-			for (int k = 0; k < 4; ++k) {
-				sum += aLeft(i, k) * aRight(k, j);
-			}
-			result(i, j) = sum;
-		}
-	}
-	return result;
+#	if defined(VMLIB_SIMD_SSE2)
+	if( !std::is_constant_evaluated() )
+		return detail::mul_simd( aLeft, aRight );
+#	endif
+	return detail::mul_scalar( aLeft, aRight );
 }
 
 constexpr
 Vec4f operator*( Mat44f const& aLeft, Vec4f const& aRight ) noexcept
 {
-	Vec4f result;
-	result.x = aLeft(0, 0) * aRight.x + aLeft(0, 1) * aRight.y + aLeft(0, 2) * aRight.z + aLeft(0, 3) * aRight.w;
-	result.y = aLeft(1, 0) * aRight.x + aLeft(1, 1) * aRight.y + aLeft(1, 2) * aRight.z + aLeft(1, 3) * aRight.w;
-	result.z = aLeft(2, 0) * aRight.x + aLeft(2, 1) * aRight.y + aLeft(2, 2) * aRight.z + aLeft(2, 3) * aRight.w;
-	result.w = aLeft(3, 0) * aRight.x + aLeft(3, 1) * aRight.y + aLeft(3, 2) * aRight.z + aLeft(3, 3) * aRight.w;
-	return result;
+#	if defined(VMLIB_SIMD_SSE2)
+	if( !std::is_constant_evaluated() )
+		return detail::mul_simd( aLeft, aRight );
+#	endif
+	return detail::mul_scalar( aLeft, aRight );
 }
 
 // Functions:
 
 Mat44f invert( Mat44f const& aM ) noexcept;
 
+// Faster inverses for common special cases. These are only valid if the
+// precondition holds; neither checks it.
+//
+// invert_affine(): the last row of aM is (0,0,0,1), i.e., aM is any
+// combination of rotations, scaling, shearing and translations.
+//
+// invert_rigid(): additionally, the upper 3x3 block is orthonormal, i.e., aM
+// consists of rotations and translations only (like a world-to-camera
+// transform).
+Mat44f invert_affine( Mat44f const& aM ) noexcept;
+
+inline
+Mat44f invert_rigid( Mat44f const& aM ) noexcept
+{
+	// The inverse of the rotation is its transpose, and the translation is
+	// rotated back and negated.
+	Mat44f ret = kIdentity44f;
+	for( std::size_t i = 0; i < 3; ++i )
+	{
+		for( std::size_t j = 0; j < 3; ++j )
+			ret(i,j) = aM(j,i);
+	}
+	for( std::size_t i = 0; i < 3; ++i )
+		ret(i,3) = -(ret(i,0)*aM(0,3) + ret(i,1)*aM(1,3) + ret(i,2)*aM(2,3));
+	return ret;
+}
+
 inline
 Mat44f transpose( Mat44f const& aM ) noexcept
 {
@@ -0,0 +1,289 @@
+#include "particles.hpp"
+
+#include <limits>
+#include <algorithm>
+
+#include <cassert>
+
+#include "simd.hpp"
+
+static_assert( 0 == ParticlePool::kChunkSize % 16, "Chunks must be whole cache lines" );
+
+namespace
+{
+	// PCG32 (XSH RR). Each stream is an independent sequence.
+	class Pcg32_
+	{
+		public:
+			Pcg32_( std::uint64_t aSeed, std::uint64_t aStream ) noexcept
+				: mState( 0 )
+				, mInc( (aStream << 1) | 1 )
+			{
+				next();
+				mState += aSeed;
+				next();
+			}
+
+			std::uint32_t next() noexcept
+			{
+				auto const old = mState;
+				mState = old * 6364136223846793005ull + mInc;
+
+				auto const xorshifted = std::uint32_t(((old >> 18) ^ old) >> 27);
+				auto const rot = std::uint32_t(old >> 59);
+				return (xorshifted >> rot) | (xorshifted << ((0u-rot) & 31));
+			}
+
+			// In [0, 1)
+			float next01() noexcept
+			{
+				return float(next() >> 8) * (1.f / 16777216.f);
+			}
+
+		private:
+			std::uint64_t mState;
+			std::uint64_t mInc;
+	};
+
+#	if defined(VMLIB_SIMD_AVX)
+	inline
+	float reduce_min_( __m256 aV ) noexcept
+	{
+		__m128 r = _mm_min_ps( _mm256_castps256_ps128( aV ), _mm256_extractf128_ps( aV, 1 ) );
+		r = _mm_min_ps( r, _mm_movehl_ps( r, r ) );
+		r = _mm_min_ss( r, _mm_shuffle_ps( r, r, _MM_SHUFFLE( 1, 1, 1, 1 ) ) );
+		return _mm_cvtss_f32( r );
+	}
+
+	inline
+	float reduce_max_( __m256 aV ) noexcept
+	{
+		__m128 r = _mm_max_ps( _mm256_castps256_ps128( aV ), _mm256_extractf128_ps( aV, 1 ) );
+		r = _mm_max_ps( r, _mm_movehl_ps( r, r ) );
+		r = _mm_max_ss( r, _mm_shuffle_ps( r, r, _MM_SHUFFLE( 1, 1, 1, 1 ) ) );
+		return _mm_cvtss_f32( r );
+	}
+
+	// Ages and moves the first count particles, count being a multiple of
+	// eight, and returns the bounds of those that are still alive. Expired
+	// particles are moved too, but they are removed afterwards.
+	AABB integrate_avx_( std::size_t aCount, float* aX, float* aY, float* aZ, float const* aVelX, float const* aVelY, float const* aVelZ, float* aLife, float aDeltaTime ) noexcept
+	{
+		__m256 const dt = _mm256_set1_ps( aDeltaTime );
+		__m256 const zero = _mm256_setzero_ps();
+		__m256 const lowest = _mm256_set1_ps( -std::numeric_limits<float>::max() );
+		__m256 const highest = _mm256_set1_ps( std::numeric_limits<float>::max() );
+
+		__m256 minX = highest, minY = highest, minZ = highest;
+		__m256 maxX = lowest, maxY = lowest, maxZ = lowest;
+
+		for( std::size_t i = 0; i < aCount; i += 8 )
+		{
+			__m256 const life = _mm256_sub_ps( _mm256_loadu_ps( aLife+i ), dt );
+			_mm256_storeu_ps( aLife+i, life );
+
+			__m256 const x = detail::madd_( _mm256_loadu_ps( aVelX+i ), dt, _mm256_loadu_ps( aX+i ) );
+			__m256 const y = detail::madd_( _mm256_loadu_ps( aVelY+i ), dt, _mm256_loadu_ps( aY+i ) );
+			__m256 const z = detail::madd_( _mm256_loadu_ps( aVelZ+i ), dt, _mm256_loadu_ps( aZ+i ) );
+			_mm256_storeu_ps( aX+i, x );
+			_mm256_storeu_ps( aY+i, y );
+			_mm256_storeu_ps( aZ+i, z );
+
+			// Expired lanes don't contribute to the bounds
+			__m256 const alive = _mm256_cmp_ps( life, zero, _CMP_GT_OQ );
+			minX = _mm256_min_ps( minX, _mm256_blendv_ps( highest, x, alive ) );
+			minY = _mm256_min_ps( minY, _mm256_blendv_ps( highest, y, alive ) );
+			minZ = _mm256_min_ps( minZ, _mm256_blendv_ps( highest, z, alive ) );
+			maxX = _mm256_max_ps( maxX, _mm256_blendv_ps( lowest, x, alive ) );
+			maxY = _mm256_max_ps( maxY, _mm256_blendv_ps( lowest, y, alive ) );
+			maxZ = _mm256_max_ps( maxZ, _mm256_blendv_ps( lowest, z, alive ) );
+		}
+
+		return AABB{
+			{ reduce_min_( minX ), reduce_min_( minY ), reduce_min_( minZ ) },
+			{ reduce_max_( maxX ), reduce_max_( maxY ), reduce_max_( maxZ ) }
+		};
+	}
+#	endif // ~ VMLIB_SIMD_AVX
+
+	AABB integrate_scalar_( std::size_t aBegin, std::size_t aEnd, float* aX, float* aY, float* aZ, float const* aVelX, float const* aVelY, float const* aVelZ, float* aLife, float aDeltaTime ) noexcept
+	{
+		AABB ret = kEmptyAABB;
+		for( std::size_t i = aBegin; i < aEnd; ++i )
+		{
+			aLife[i] -= aDeltaTime;
+			aX[i] += aVelX[i] * aDeltaTime;
+			aY[i] += aVelY[i] * aDeltaTime;
+			aZ[i] += aVelZ[i] * aDeltaTime;
+
+			if( aLife[i] > 0.f )
+				ret = expand( ret, Vec3f{ aX[i], aY[i], aZ[i] } );
+		}
+		return ret;
+	}
+}
+
+ParticlePool::ParticlePool( std::size_t aCapacity )
+	: mSize( 0 )
+	, mX( aCapacity ), mY( aCapacity ), mZ( aCapacity )
+	, mVelX( aCapacity ), mVelY( aCapacity ), mVelZ( aCapacity )
+	, mLife( aCapacity )
+{
+	mChunkBounds.reserve( chunk_count( aCapacity ) );
+}
+
+std::size_t ParticlePool::size() const noexcept
+{
+	return mSize;
+}
+std::size_t ParticlePool::capacity() const noexcept
+{
+	return mLife.size();
+}
+
+void ParticlePool::clear() noexcept
+{
+	mSize = 0;
+}
+
+bool ParticlePool::emit( Vec3f aPosition, Vec3f aVelocity, float aLife ) noexcept
+{
+	assert( aLife > 0.f );
+
+	if( mSize == capacity() )
+		return false;
+
+	auto const i = mSize++;
+	mX[i] = aPosition.x;
+	mY[i] = aPosition.y;
+	mZ[i] = aPosition.z;
+	mVelX[i] = aVelocity.x;
+	mVelY[i] = aVelocity.y;
+	mVelZ[i] = aVelocity.z;
+	mLife[i] = aLife;
+	return true;
+}
+
+std::size_t ParticlePool::emit( std::size_t aCount, Vec3f aPosition, ParticleEmitter const& aEmitter, std::uint64_t aSeed ) noexcept
+{
+	return emit( aCount, aPosition, aEmitter, aSeed, [] (std::size_t aChunks, auto const& aJob) {
+		for( std::size_t i = 0; i < aChunks; ++i )
+			aJob( i );
+	} );
+}
+
+AABB ParticlePool::update( float aDeltaTime ) noexcept
+{
+	return update( aDeltaTime, [] (std::size_t aChunks, auto const& aJob) {
+		for( std::size_t i = 0; i < aChunks; ++i )
+			aJob( i );
+	} );
+}
+
+std::span<float const> ParticlePool::x() const noexcept
+{
+	return { mX.data(), mSize };
+}
+std::span<float const> ParticlePool::y() const noexcept
+{
+	return { mY.data(), mSize };
+}
+std::span<float const> ParticlePool::z() const noexcept
+{
+	return { mZ.data(), mSize };
+}
+std::span<float const> ParticlePool::life() const noexcept
+{
+	return { mLife.data(), mSize };
+}
+
+ParticleRange ParticlePool::allocate( std::size_t aCount ) noexcept
+{
+	ParticleRange const ret{ mSize, std::min( aCount, capacity() - mSize ) };
+	mSize += ret.count;
+	return ret;
+}
+
+void ParticlePool::spawn( ParticleRange aRange, std::size_t aChunk, Vec3f aPosition, ParticleEmitter const& aEmitter, std::uint64_t aSeed ) noexcept
+{
+	assert( aRange.first + aRange.count <= mSize );
+	assert( aEmitter.lifetime > 0.f );
+
+	auto const begin = aChunk * kChunkSize;
+	auto const end = std::min( begin + kChunkSize, aRange.count );
+
+	Pcg32_ rng( aSeed, aChunk );
+	for( std::size_t i = aRange.first + begin; i < aRange.first + end; ++i )
+	{
+		mX[i] = aPosition.x;
+		mY[i] = aPosition.y;
+		mZ[i] = aPosition.z;
+		mVelX[i] = aEmitter.baseVelocity.x + aEmitter.spread * rng.next01();
+		mVelY[i] = aEmitter.baseVelocity.y + aEmitter.spread * rng.next01();
+		mVelZ[i] = aEmitter.baseVelocity.z + aEmitter.spread * rng.next01();
+		mLife[i] = aEmitter.lifetime;
+	}
+}
+
+AABB ParticlePool::integrate( std::size_t aChunk, float aDeltaTime ) noexcept
+{
+	auto const begin = aChunk * kChunkSize;
+	auto const end = std::min( begin + kChunkSize, mSize );
+	assert( begin < end );
+
+	AABB bounds = kEmptyAABB;
+	std::size_t done = begin;
+
+#	if defined(VMLIB_SIMD_AVX)
+	auto const count = (end - begin) & ~std::size_t(7);
+	bounds = integrate_avx_( count, mX.data()+begin, mY.data()+begin, mZ.data()+begin, mVelX.data()+begin, mVelY.data()+begin, mVelZ.data()+begin, mLife.data()+begin, aDeltaTime );
+	done += count;
+#	endif
+
+	return merge( bounds, integrate_scalar_( done, end, mX.data(), mY.data(), mZ.data(), mVelX.data(), mVelY.data(), mVelZ.data(), mLife.data(), aDeltaTime ) );
+}
+
+void ParticlePool::remove_dead() noexcept
+{
+	std::size_t i = 0;
+	while( i < mSize )
+	{
+#		if defined(VMLIB_SIMD_AVX)
+		// Most particles survive a frame; skip eight at a time while none of
+		// them has expired.
+		if( i + 8 <= mSize )
+		{
+			__m256 const expired = _mm256_cmp_ps( _mm256_loadu_ps( mLife.data()+i ), _mm256_setzero_ps(), _CMP_LE_OQ );
+			if( 0 == _mm256_movemask_ps( expired ) )
+			{
+				i += 8;
+				continue;
+			}
+		}
+#		endif
+
+		if( mLife[i] > 0.f )
+		{
+			++i;
+			continue;
+		}
+
+		// Replace with the last particle, which is checked next
+		auto const last = --mSize;
+		mX[i] = mX[last];
+		mY[i] = mY[last];
+		mZ[i] = mZ[last];
+		mVelX[i] = mVelX[last];
+		mVelY[i] = mVelY[last];
+		mVelZ[i] = mVelZ[last];
+		mLife[i] = mLife[last];
+	}
+}
+
+AABB detail::update_particles_scalar( ParticlePool& aPool, float aDeltaTime ) noexcept
+{
+	auto const bounds = integrate_scalar_( 0, aPool.mSize, aPool.mX.data(), aPool.mY.data(), aPool.mZ.data(), aPool.mVelX.data(), aPool.mVelY.data(), aPool.mVelZ.data(), aPool.mLife.data(), aDeltaTime );
+
+	aPool.remove_dead();
+	return bounds;
+}
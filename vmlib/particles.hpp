@@ -0,0 +1,197 @@
+#ifndef PARTICLES_HPP_1F7A3C52_9E0B_4D6A_B8C4_72D5E9A1F036
+#define PARTICLES_HPP_1F7A3C52_9E0B_4D6A_B8C4_72D5E9A1F036
+
+#include <new>
+#include <span>
+#include <vector>
+#include <utility>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "vec3.hpp"
+#include "aabb.hpp"
+
+/* Particle storage and simulation
+ *
+ * ParticlePool stores particles as a structure of arrays (one array each for
+ * x, y, z, the three velocity components and the remaining life). The live
+ * particles are always the first size() entries; a particle that dies is
+ * replaced by the last live one (swap-remove). Updating and drawing thus only
+ * touch the live particles, never the whole capacity.
+ *
+ * The particles are processed in chunks of kChunkSize. The arrays are aligned
+ * to cache lines, and chunks are a whole number of cache lines, so that
+ * different chunks can be processed on different threads without sharing a
+ * cache line (see the overloads that take a parallel-for below). Within a
+ * chunk, eight particles are integrated per iteration with AVX; remaining
+ * particles go through the scalar code.
+ *
+ * Spawned particles get their random velocity from a PCG32 generator with
+ * one stream per chunk (O'Neill, "PCG: A Family of Simple Fast
+ * Space-Efficient Statistically Good Algorithms for Random Number
+ * Generation", 2014). The result depends only on the seed, not on the order
+ * in which the chunks are processed or the number of threads.
+ */
+struct ParticleEmitter
+{
+	float lifetime; // seconds
+	float halfSize;
+
+	// Particles start with baseVelocity plus a random offset in
+	// [0, spread] along each axis.
+	Vec3f baseVelocity;
+	float spread;
+};
+
+// Particles [first, first+count) of a pool
+struct ParticleRange
+{
+	std::size_t first;
+	std::size_t count;
+};
+
+class ParticlePool;
+
+// Scalar reference implementation (see mat44.hpp).
+namespace detail
+{
+	AABB update_particles_scalar( ParticlePool&, float aDeltaTime ) noexcept;
+
+	template< typename tType >
+	struct CacheAlignedAllocator
+	{
+		using value_type = tType;
+
+		static constexpr std::align_val_t kAlignment{ 64 };
+
+		CacheAlignedAllocator() = default;
+		template< typename tOther >
+		CacheAlignedAllocator( CacheAlignedAllocator<tOther> const& ) noexcept {}
+
+		tType* allocate( std::size_t aCount )
+		{
+			return static_cast<tType*>(::operator new( aCount * sizeof(tType), kAlignment ));
+		}
+		void deallocate( tType* aPtr, std::size_t ) noexcept
+		{
+			::operator delete( aPtr, kAlignment );
+		}
+
+		template< typename tOther >
+		bool operator== (CacheAlignedAllocator<tOther> const&) const noexcept { return true; }
+	};
+}
+
+class ParticlePool final
+{
+	public:
+		// 16384 floats are 1024 cache lines of 64 bytes
+		static constexpr std::size_t kChunkSize = 16384;
+
+		// Number of chunks needed for aCount particles
+		static constexpr
+		std::size_t chunk_count( std::size_t aCount ) noexcept
+		{
+			return (aCount + kChunkSize-1) / kChunkSize;
+		}
+
+	public:
+		explicit ParticlePool( std::size_t aCapacity = 0 );
+
+	public:
+		std::size_t size() const noexcept;
+		std::size_t capacity() const noexcept;
+
+		// Kills all particles
+		void clear() noexcept;
+
+		// Adds a particle that lives for aLife (> 0) seconds. Returns false if
+		// the pool is full.
+		bool emit( Vec3f aPosition, Vec3f aVelocity, float aLife ) noexcept;
+
+		// Adds up to aCount particles at aPosition (fewer if the pool is full),
+		// with velocities drawn from aEmitter. Returns the number added.
+		std::size_t emit( std::size_t aCount, Vec3f aPosition, ParticleEmitter const& aEmitter, std::uint64_t aSeed ) noexcept;
+
+		template< typename tParallelFor >
+		std::size_t emit( std::size_t aCount, Vec3f aPosition, ParticleEmitter const& aEmitter, std::uint64_t aSeed, tParallelFor&& aParallelFor );
+
+		// Advances the particles by aDeltaTime and removes those that have
+		// expired. Returns the bounds of the positions of the survivors.
+		AABB update( float aDeltaTime ) noexcept;
+
+		template< typename tParallelFor >
+		AABB update( float aDeltaTime, tParallelFor&& aParallelFor );
+
+		// Live particles, in no particular order
+		std::span<float const> x() const noexcept;
+		std::span<float const> y() const noexcept;
+		std::span<float const> z() const noexcept;
+		std::span<float const> life() const noexcept; // seconds left
+
+	public:
+		// Building blocks of emit() and update(). Different chunks can be
+		// processed concurrently.
+
+		// Makes room for up to aCount particles (fewer if the pool is full).
+		// The new particles must be initialized with spawn() before the next
+		// update.
+		ParticleRange allocate( std::size_t aCount ) noexcept;
+
+		// Initializes chunk aChunk of the range
+		void spawn( ParticleRange, std::size_t aChunk, Vec3f aPosition, ParticleEmitter const&, std::uint64_t aSeed ) noexcept;
+
+		// Ages and moves the particles in chunk aChunk of the live particles.
+		// Returns the bounds of those that are still alive. Expired particles
+		// stay in place until remove_dead().
+		AABB integrate( std::size_t aChunk, float aDeltaTime ) noexcept;
+
+		void remove_dead() noexcept;
+
+	private:
+		friend AABB detail::update_particles_scalar( ParticlePool&, float ) noexcept;
+
+		using Array_ = std::vector<float, detail::CacheAlignedAllocator<float>>;
+
+		std::size_t mSize;
+
+		Array_ mX, mY, mZ;
+		Array_ mVelX, mVelY, mVelZ;
+		Array_ mLife;
+
+		// Per-chunk results of update()
+		std::vector<AABB> mChunkBounds;
+};
+
+/* aParallelFor( count, job ) must call job( i ) for every i in [0, count), in
+ * any order and possibly concurrently, and return when all calls have
+ * finished.
+ */
+template< typename tParallelFor > inline
+std::size_t ParticlePool::emit( std::size_t aCount, Vec3f aPosition, ParticleEmitter const& aEmitter, std::uint64_t aSeed, tParallelFor&& aParallelFor )
+{
+	auto const range = allocate( aCount );
+	std::forward<tParallelFor>(aParallelFor)( chunk_count( range.count ), [&] (std::size_t aChunk) {
+		spawn( range, aChunk, aPosition, aEmitter, aSeed );
+	} );
+	return range.count;
+}
+
+template< typename tParallelFor > inline
+AABB ParticlePool::update( float aDeltaTime, tParallelFor&& aParallelFor )
+{
+	mChunkBounds.resize( chunk_count( mSize ) );
+	std::forward<tParallelFor>(aParallelFor)( mChunkBounds.size(), [&] (std::size_t aChunk) {
+		mChunkBounds[aChunk] = integrate( aChunk, aDeltaTime );
+	} );
+
+	AABB ret = kEmptyAABB;
+	for( auto const& bounds : mChunkBounds )
+		ret = merge( ret, bounds );
+
+	remove_dead();
+	return ret;
+}
+
+#endif // PARTICLES_HPP_1F7A3C52_9E0B_4D6A_B8C4_72D5E9A1F036
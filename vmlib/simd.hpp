@@ -0,0 +1,63 @@
+#ifndef SIMD_HPP_4C0E8B6D_2A35_4F5E_9D7B_0B8E1C6A92F4
+#define SIMD_HPP_4C0E8B6D_2A35_4F5E_9D7B_0B8E1C6A92F4
+
+/* Compile-time SIMD selection for vmlib
+ *
+ * The build uses -march=native (see premake5.lua), so the compiler tells us
+ * which instruction sets are available through the usual predefined macros.
+ * We pick the widest code path from those; there is no runtime dispatch.
+ *
+ * Define VMLIB_NO_SIMD to force the scalar reference implementations (e.g.,
+ * when chasing a numerical difference between the two).
+ *
+ * Macros defined here:
+ *   VMLIB_SIMD_SSE2 - 128-bit paths (always on for x86-64)
+ *   VMLIB_SIMD_AVX  - 256-bit paths
+ *   VMLIB_SIMD_FMA  - fused multiply-add is available
+ */
+
+#if !defined(VMLIB_NO_SIMD)
+#	if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#		define VMLIB_SIMD_SSE2 1
+#	endif
+#	if defined(VMLIB_SIMD_SSE2) && defined(__AVX__)
+#		define VMLIB_SIMD_AVX 1
+#	endif
+#	if defined(VMLIB_SIMD_AVX) && (defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#		define VMLIB_SIMD_FMA 1
+#	endif
+#endif // ~ VMLIB_NO_SIMD
+
+#if defined(VMLIB_SIMD_SSE2)
+#	include <immintrin.h>
+#endif
+
+#if defined(VMLIB_SIMD_SSE2)
+namespace detail
+{
+	// a*b + c. With FMA this is a single (more precise) instruction.
+	inline
+	__m128 madd_( __m128 aA, __m128 aB, __m128 aC ) noexcept
+	{
+#		if defined(VMLIB_SIMD_FMA)
+		return _mm_fmadd_ps( aA, aB, aC );
+#		else
+		return _mm_add_ps( _mm_mul_ps( aA, aB ), aC );
+#		endif
+	}
+
+#	if defined(VMLIB_SIMD_AVX)
+	inline
+	__m256 madd_( __m256 aA, __m256 aB, __m256 aC ) noexcept
+	{
+#		if defined(VMLIB_SIMD_FMA)
+		return _mm256_fmadd_ps( aA, aB, aC );
+#		else
+		return _mm256_add_ps( _mm256_mul_ps( aA, aB ), aC );
+#		endif
+	}
+#	endif // ~ VMLIB_SIMD_AVX
+}
+#endif // ~ VMLIB_SIMD_SSE2
+
+#endif // SIMD_HPP_4C0E8B6D_2A35_4F5E_9D7B_0B8E1C6A92F4
@@ -0,0 +1,57 @@
+#ifndef SPHERE_HPP_E25978D4_A3E6_4A25_9D6F_F2A1288F7DCA
+#define SPHERE_HPP_E25978D4_A3E6_4A25_9D6F_F2A1288F7DCA
+
+#include <span>
+#include <cmath>
+#include <algorithm>
+
+#include "vec3.hpp"
+#include "aabb.hpp"
+
+// Bounding sphere. A negative radius denotes an empty sphere.
+struct BoundingSphere
+{
+	Vec3f center;
+	float radius;
+};
+
+constexpr BoundingSphere kEmptySphere = { { 0.f, 0.f, 0.f }, -1.f };
+
+constexpr
+bool is_empty( BoundingSphere const& aSphere ) noexcept
+{
+	return aSphere.radius < 0.f;
+}
+
+// Sphere through the corners of the box
+inline
+BoundingSphere make_bounding_sphere( AABB const& aBox ) noexcept
+{
+	if( is_empty( aBox ) )
+		return kEmptySphere;
+
+	return BoundingSphere{ center( aBox ), length( extents( aBox ) ) };
+}
+
+// Sphere centered on the points' bounding box, with the smallest radius that
+// encloses all points. This is usually tighter than the sphere around the box.
+inline
+BoundingSphere make_bounding_sphere( std::span<Vec3f const> aPoints ) noexcept
+{
+	auto const box = make_aabb( aPoints );
+	if( is_empty( box ) )
+		return kEmptySphere;
+
+	auto const c = center( box );
+
+	float radius2 = 0.f;
+	for( auto const& p : aPoints )
+	{
+		auto const d = p - c;
+		radius2 = std::max( radius2, dot( d, d ) );
+	}
+
+	return BoundingSphere{ c, std::sqrt( radius2 ) };
+}
+
+#endif // SPHERE_HPP_E25978D4_A3E6_4A25_9D6F_F2A1288F7DCA
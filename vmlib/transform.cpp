@@ -0,0 +1,173 @@
+#include "transform.hpp"
+
+#include "simd.hpp"
+
+static_assert( sizeof(Vec3f) == 3*sizeof(float), "Vec3f arrays must be tightly packed floats" );
+
+namespace
+{
+#	if defined(VMLIB_SIMD_AVX)
+	// Load eight consecutive Vec3fs (24 floats) and deinterleave them into
+	// x, y and z registers. The lane order of the result is permuted, but
+	// identically so for x, y and z; store_xyz8_() undoes the permutation.
+	// See "3D Vector Normalization Using 256-Bit Intel AVX" (Intel, 2011).
+	inline
+	void load_xyz8_( float const* aSrc, __m256& aX, __m256& aY, __m256& aZ ) noexcept
+	{
+		__m256 const m03 = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( aSrc+0 ) ), _mm_loadu_ps( aSrc+12 ), 1 );
+		__m256 const m14 = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( aSrc+4 ) ), _mm_loadu_ps( aSrc+16 ), 1 );
+		__m256 const m25 = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( aSrc+8 ) ), _mm_loadu_ps( aSrc+20 ), 1 );
+
+		__m256 const xy = _mm256_shuffle_ps( m14, m25, _MM_SHUFFLE( 2, 1, 3, 2 ) );
+		__m256 const yz = _mm256_shuffle_ps( m03, m14, _MM_SHUFFLE( 1, 0, 2, 1 ) );
+
+		aX = _mm256_shuffle_ps( m03, xy, _MM_SHUFFLE( 2, 0, 3, 0 ) );
+		aY = _mm256_shuffle_ps( yz, xy, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+		aZ = _mm256_shuffle_ps( yz, m25, _MM_SHUFFLE( 3, 0, 3, 1 ) );
+	}
+
+	inline
+	void store_xyz8_( float* aDst, __m256 aX, __m256 aY, __m256 aZ ) noexcept
+	{
+		__m256 const rxy = _mm256_shuffle_ps( aX, aY, _MM_SHUFFLE( 2, 0, 2, 0 ) );
+		__m256 const ryz = _mm256_shuffle_ps( aY, aZ, _MM_SHUFFLE( 3, 1, 3, 1 ) );
+		__m256 const rzx = _mm256_shuffle_ps( aZ, aX, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+
+		__m256 const r03 = _mm256_shuffle_ps( rxy, rzx, _MM_SHUFFLE( 2, 0, 2, 0 ) );
+		__m256 const r14 = _mm256_shuffle_ps( ryz, rxy, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+		__m256 const r25 = _mm256_shuffle_ps( rzx, ryz, _MM_SHUFFLE( 3, 1, 3, 1 ) );
+
+		_mm_storeu_ps( aDst+0, _mm256_castps256_ps128( r03 ) );
+		_mm_storeu_ps( aDst+4, _mm256_castps256_ps128( r14 ) );
+		_mm_storeu_ps( aDst+8, _mm256_castps256_ps128( r25 ) );
+		_mm_storeu_ps( aDst+12, _mm256_extractf128_ps( r03, 1 ) );
+		_mm_storeu_ps( aDst+16, _mm256_extractf128_ps( r14, 1 ) );
+		_mm_storeu_ps( aDst+20, _mm256_extractf128_ps( r25, 1 ) );
+	}
+
+	// Row aRow of a 3x3 or 4x4 product: m0*x + m1*y + m2*z
+	inline
+	__m256 dot3_( float const* aRow, __m256 aX, __m256 aY, __m256 aZ ) noexcept
+	{
+		__m256 r = _mm256_mul_ps( _mm256_set1_ps( aRow[0] ), aX );
+		r = detail::madd_( _mm256_set1_ps( aRow[1] ), aY, r );
+		r = detail::madd_( _mm256_set1_ps( aRow[2] ), aZ, r );
+		return r;
+	}
+
+	// Returns the number of elements processed (a multiple of eight).
+	std::size_t transform_positions_avx_( std::span<Vec3f> aPositions, Mat44f const& aM ) noexcept
+	{
+		std::size_t const count = aPositions.size() & ~std::size_t(7);
+		float* data = &aPositions.data()->x;
+
+		__m256 const tx = _mm256_set1_ps( aM(0,3) );
+		__m256 const ty = _mm256_set1_ps( aM(1,3) );
+		__m256 const tz = _mm256_set1_ps( aM(2,3) );
+
+		if( is_affine( aM ) )
+		{
+			for( std::size_t i = 0; i < count; i += 8, data += 24 )
+			{
+				__m256 x, y, z;
+				load_xyz8_( data, x, y, z );
+
+				__m256 const rx = _mm256_add_ps( dot3_( aM.v+0, x, y, z ), tx );
+				__m256 const ry = _mm256_add_ps( dot3_( aM.v+4, x, y, z ), ty );
+				__m256 const rz = _mm256_add_ps( dot3_( aM.v+8, x, y, z ), tz );
+
+				store_xyz8_( data, rx, ry, rz );
+			}
+		}
+		else
+		{
+			__m256 const tw = _mm256_set1_ps( aM(3,3) );
+			for( std::size_t i = 0; i < count; i += 8, data += 24 )
+			{
+				__m256 x, y, z;
+				load_xyz8_( data, x, y, z );
+
+				__m256 const rx = _mm256_add_ps( dot3_( aM.v+0, x, y, z ), tx );
+				__m256 const ry = _mm256_add_ps( dot3_( aM.v+4, x, y, z ), ty );
+				__m256 const rz = _mm256_add_ps( dot3_( aM.v+8, x, y, z ), tz );
+				__m256 const rw = _mm256_add_ps( dot3_( aM.v+12, x, y, z ), tw );
+
+				store_xyz8_( data,
+					_mm256_div_ps( rx, rw ),
+					_mm256_div_ps( ry, rw ),
+					_mm256_div_ps( rz, rw )
+				);
+			}
+		}
+
+		return count;
+	}
+
+	std::size_t transform_normals_avx_( std::span<Vec3f> aNormals, Mat33f const& aN ) noexcept
+	{
+		std::size_t const count = aNormals.size() & ~std::size_t(7);
+		float* data = &aNormals.data()->x;
+
+		for( std::size_t i = 0; i < count; i += 8, data += 24 )
+		{
+			__m256 x, y, z;
+			load_xyz8_( data, x, y, z );
+
+			__m256 const rx = dot3_( aN.v+0, x, y, z );
+			__m256 const ry = dot3_( aN.v+3, x, y, z );
+			__m256 const rz = dot3_( aN.v+6, x, y, z );
+
+			store_xyz8_( data, rx, ry, rz );
+		}
+
+		return count;
+	}
+#	endif // ~ VMLIB_SIMD_AVX
+}
+
+void transform_positions( std::span<Vec3f> aPositions, Mat44f const& aTransform ) noexcept
+{
+#	if defined(VMLIB_SIMD_AVX)
+	auto const done = transform_positions_avx_( aPositions, aTransform );
+	aPositions = aPositions.subspan( done );
+#	endif
+
+	detail::transform_positions_scalar( aPositions, aTransform );
+}
+
+void transform_normals( std::span<Vec3f> aNormals, Mat33f const& aTransform ) noexcept
+{
+#	if defined(VMLIB_SIMD_AVX)
+	auto const done = transform_normals_avx_( aNormals, aTransform );
+	aNormals = aNormals.subspan( done );
+#	endif
+
+	detail::transform_normals_scalar( aNormals, aTransform );
+}
+
+void detail::transform_positions_scalar( std::span<Vec3f> aPositions, Mat44f const& aTransform ) noexcept
+{
+	if( is_affine( aTransform ) )
+	{
+		for( auto& p : aPositions )
+		{
+			Vec4f const t = detail::mul_scalar( aTransform, Vec4f{ p.x, p.y, p.z, 1.f } );
+			p = Vec3f{ t.x, t.y, t.z };
+		}
+	}
+	else
+	{
+		for( auto& p : aPositions )
+		{
+			Vec4f t = detail::mul_scalar( aTransform, Vec4f{ p.x, p.y, p.z, 1.f } );
+			t /= t.w;
+			p = Vec3f{ t.x, t.y, t.z };
+		}
+	}
+}
+
+void detail::transform_normals_scalar( std::span<Vec3f> aNormals, Mat33f const& aTransform ) noexcept
+{
+	for( auto& n : aNormals )
+		n = aTransform * n;
+}
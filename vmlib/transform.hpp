@@ -0,0 +1,41 @@
+#ifndef TRANSFORM_HPP_9A51D3C2_67E4_4B0F_8E2C_5D7F14B3A6E8
+#define TRANSFORM_HPP_9A51D3C2_67E4_4B0F_8E2C_5D7F14B3A6E8
+
+#include <span>
+
+#include "vec3.hpp"
+#include "mat33.hpp"
+#include "mat44.hpp"
+
+/* Batch transforms for arrays of positions and normals
+ *
+ * These transform the elements of the array in place. With AVX, eight
+ * elements are processed per iteration (the Vec3f array is deinterleaved into
+ * x/y/z registers on the fly); remaining elements go through the scalar code.
+ *
+ * transform_positions() treats each element as a point (w = 1) and performs
+ * the perspective divide. If the matrix is affine (last row is 0,0,0,1), the
+ * divide is skipped.
+ *
+ * transform_normals() multiplies each element by the given 3x3 matrix, i.e.,
+ * pass normal_matrix(M) to transform normals along with positions transformed
+ * by M. Results are not renormalized.
+ */
+void transform_positions( std::span<Vec3f> aPositions, Mat44f const& aTransform ) noexcept;
+void transform_normals( std::span<Vec3f> aNormals, Mat33f const& aTransform ) noexcept;
+
+// True if the last row of the matrix is exactly (0, 0, 0, 1).
+constexpr
+bool is_affine( Mat44f const& aM ) noexcept
+{
+	return 0.f == aM(3,0) && 0.f == aM(3,1) && 0.f == aM(3,2) && 1.f == aM(3,3);
+}
+
+// Scalar reference implementations (see mat44.hpp).
+namespace detail
+{
+	void transform_positions_scalar( std::span<Vec3f>, Mat44f const& ) noexcept;
+	void transform_normals_scalar( std::span<Vec3f>, Mat33f const& ) noexcept;
+}
+
+#endif // TRANSFORM_HPP_9A51D3C2_67E4_4B0F_8E2C_5D7F14B3A6E8